@@ -2,6 +2,10 @@
 
 known_tests=(
   nfc_test_utils
+  nfc_test_nci
+  nfc_test_nfa_ee
+  nfc_test_nfa_hci
+  nfc_test_rw_mfc
 )
 
 known_remote_tests=(
@@ -31,6 +31,7 @@
 #include <cutils/properties.h>
 #include <hwbinder/ProcessState.h>
 
+#include "debug_hce_stats.h"
 #include "debug_nfcsnoop.h"
 #include "nfa_api.h"
 #include "nfa_rw_api.h"
@@ -75,6 +76,7 @@ std::string NFC_AIDL_HAL_SERVICE_NAME = "android.hardware.nfc.INfc/default";
 extern void GKI_shutdown();
 extern void verify_stack_non_volatile_store();
 extern void delete_stack_non_volatile_store(bool forceDelete);
+extern void stop_stack_non_volatile_store();
 
 NfcAdaptation* NfcAdaptation::mpInstance = nullptr;
 ThreadMutex NfcAdaptation::sLock;
@@ -582,6 +584,8 @@ void NfcAdaptation::Finalize() {
   AutoThreadMutex a(sLock);
 
   LOG(VERBOSE) << StringPrintf("%s: enter", func);
+  /* The NV writer sends its results through GKI */
+  stop_stack_non_volatile_store();
   GKI_shutdown();
 
   NfcConfig::clear();
@@ -633,7 +637,10 @@ void NfcAdaptation::DeviceShutdown() {
 ** Returns:     None.
 **
 *******************************************************************************/
-void NfcAdaptation::Dump(int fd) { debug_nfcsnoop_dump(fd); }
+void NfcAdaptation::Dump(int fd) {
+  debug_nfcsnoop_dump(fd);
+  debug_hce_stats_dump(fd);
+}
 
 /*******************************************************************************
 **
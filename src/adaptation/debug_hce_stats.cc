@@ -0,0 +1,287 @@
+/**
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/debug_hce_stats.h"
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+
+#include "nfc_api.h"
+
+using android::base::StringPrintf;
+
+/* Segments of the service time of one APDU */
+enum {
+  HCE_STATS_SEG_STACK_IN,  /* RF data NTF to delivery to application */
+  HCE_STATS_SEG_APP,       /* delivery to R-APDU from application    */
+  HCE_STATS_SEG_STACK_OUT, /* R-APDU from application to NFCC        */
+  HCE_STATS_SEG_TOTAL,     /* RF data NTF to NFCC                    */
+  HCE_STATS_NUM_SEGS
+};
+
+static const char* const hce_stats_seg_names[HCE_STATS_NUM_SEGS] = {
+    "stack-in", "app", "stack-out", "total"};
+
+/* Upper bound (in us) of each histogram bucket, last bucket is unbounded */
+static const uint32_t hce_stats_bucket_us[HCE_STATS_NUM_BUCKETS - 1] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000};
+
+typedef struct {
+  uint8_t aid_len;
+  uint8_t aid[NFC_MAX_AID_LEN];
+  uint32_t count;
+  uint32_t max_us[HCE_STATS_NUM_SEGS];
+  uint32_t hist[HCE_STATS_NUM_SEGS][HCE_STATS_NUM_BUCKETS];
+} tHCE_STATS_AID;
+
+/* Entry 0 counts APDUs without SELECT and AIDs not fitting into the table */
+static tHCE_STATS_AID hce_stats_aid[HCE_STATS_MAX_AID + 1];
+static uint8_t hce_stats_num_aid = 1;
+static uint8_t hce_stats_cur_aid;
+static bool hce_stats_active;
+
+/* Timestamps (us) of the APDU in progress, 0 if not reached */
+static uint64_t hce_stats_rx_us;
+static uint64_t hce_stats_delivered_us;
+static uint64_t hce_stats_app_rsp_us;
+
+static std::mutex hce_stats_mutex;
+
+static uint64_t hce_stats_now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void hce_stats_add(tHCE_STATS_AID* p_aid, int seg, uint64_t delta_us) {
+  uint32_t us = (delta_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta_us;
+  int bucket = 0;
+
+  while ((bucket < HCE_STATS_NUM_BUCKETS - 1) &&
+         (us > hce_stats_bucket_us[bucket]))
+    bucket++;
+
+  p_aid->hist[seg][bucket]++;
+  if (us > p_aid->max_us[seg]) p_aid->max_us[seg] = us;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_activated
+**
+** Description      Start tracking APDUs: listen mode ISO-DEP got activated
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_activated(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+
+  hce_stats_active = true;
+  hce_stats_cur_aid = 0;
+  hce_stats_rx_us = 0;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_deactivated
+**
+** Description      Stop tracking APDUs, discard APDU in progress
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_deactivated(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+
+  hce_stats_active = false;
+  hce_stats_rx_us = 0;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_select_aid
+**
+** Description      Account following APDUs (including this SELECT) to AID
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_select_aid(const uint8_t* p_aid, uint8_t aid_len) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+  uint8_t xx;
+
+  if (!hce_stats_active) return;
+
+  if (aid_len > NFC_MAX_AID_LEN) aid_len = NFC_MAX_AID_LEN;
+
+  for (xx = 1; xx < hce_stats_num_aid; xx++) {
+    if ((hce_stats_aid[xx].aid_len == aid_len) &&
+        (!memcmp(hce_stats_aid[xx].aid, p_aid, aid_len)))
+      break;
+  }
+
+  if (xx == hce_stats_num_aid) {
+    if (hce_stats_num_aid > HCE_STATS_MAX_AID) {
+      xx = 0;
+    } else {
+      hce_stats_aid[xx].aid_len = aid_len;
+      memcpy(hce_stats_aid[xx].aid, p_aid, aid_len);
+      hce_stats_num_aid++;
+    }
+  }
+
+  hce_stats_cur_aid = xx;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_rx
+**
+** Description      Record reception of a C-APDU from the RF interface
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_rx(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+
+  /* keep time of the first fragment */
+  if ((!hce_stats_active) || (hce_stats_rx_us)) return;
+
+  hce_stats_rx_us = hce_stats_now_us();
+  hce_stats_delivered_us = 0;
+  hce_stats_app_rsp_us = 0;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_delivered
+**
+** Description      Record delivery of the C-APDU to the application
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_delivered(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+
+  if ((hce_stats_rx_us) && (!hce_stats_delivered_us))
+    hce_stats_delivered_us = hce_stats_now_us();
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_app_rsp
+**
+** Description      Record submission of the R-APDU by the application
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_app_rsp(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+
+  if ((hce_stats_delivered_us) && (!hce_stats_app_rsp_us))
+    hce_stats_app_rsp_us = hce_stats_now_us();
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_tx
+**
+** Description      Record transmission of the R-APDU to NFCC and update
+**                  histograms of the current AID
+**
+**                  R-APDUs built by the stack itself (e.g. NDEF emulation)
+**                  are accounted as stack-in only.
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_tx(void) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+  tHCE_STATS_AID* p_aid;
+  uint64_t now_us, delivered_us, app_rsp_us;
+
+  if (!hce_stats_rx_us) return;
+
+  now_us = hce_stats_now_us();
+  delivered_us = (hce_stats_delivered_us) ? hce_stats_delivered_us : now_us;
+  app_rsp_us = (hce_stats_app_rsp_us) ? hce_stats_app_rsp_us : now_us;
+  if (app_rsp_us < delivered_us) app_rsp_us = delivered_us;
+
+  p_aid = &hce_stats_aid[hce_stats_cur_aid];
+  p_aid->count++;
+  hce_stats_add(p_aid, HCE_STATS_SEG_STACK_IN, delivered_us - hce_stats_rx_us);
+  hce_stats_add(p_aid, HCE_STATS_SEG_APP, app_rsp_us - delivered_us);
+  hce_stats_add(p_aid, HCE_STATS_SEG_STACK_OUT, now_us - app_rsp_us);
+  hce_stats_add(p_aid, HCE_STATS_SEG_TOTAL, now_us - hce_stats_rx_us);
+
+  hce_stats_rx_us = 0;
+}
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_dump
+**
+** Description      Write service time histograms per AID to fd
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_dump(int fd) {
+  std::lock_guard<std::mutex> lock(hce_stats_mutex);
+  std::string line;
+
+  dprintf(fd, "--- BEGIN:HCE_APDU_SERVICE_TIME ---\n");
+
+  line = StringPrintf("%-10s", "bucket(us)");
+  for (int bucket = 0; bucket < HCE_STATS_NUM_BUCKETS - 1; bucket++) {
+    std::string bound = StringPrintf("<=%u", hce_stats_bucket_us[bucket]);
+    line += StringPrintf(" %8s", bound.c_str());
+  }
+  line += StringPrintf(" %8s %8s", "more", "max");
+  dprintf(fd, "%s\n", line.c_str());
+
+  for (uint8_t xx = 0; xx < hce_stats_num_aid; xx++) {
+    tHCE_STATS_AID* p_aid = &hce_stats_aid[xx];
+
+    if (!p_aid->count) continue;
+
+    line.clear();
+    for (uint8_t yy = 0; yy < p_aid->aid_len; yy++)
+      line += StringPrintf("%02X", p_aid->aid[yy]);
+    dprintf(fd, "AID %s: %u APDUs\n", (xx) ? line.c_str() : "(other)",
+            p_aid->count);
+
+    for (int seg = 0; seg < HCE_STATS_NUM_SEGS; seg++) {
+      line = StringPrintf("%-10s", hce_stats_seg_names[seg]);
+      for (int bucket = 0; bucket < HCE_STATS_NUM_BUCKETS; bucket++)
+        line += StringPrintf(" %8u", p_aid->hist[seg][bucket]);
+      line += StringPrintf(" %8u", p_aid->max_us[seg]);
+      dprintf(fd, "%s\n", line.c_str());
+    }
+  }
+
+  dprintf(fd, "--- END:HCE_APDU_SERVICE_TIME ---\n");
+}
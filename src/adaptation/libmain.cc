@@ -18,7 +18,14 @@
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "CrcChecksum.h"
@@ -34,6 +41,97 @@ std::string getFilenameForBlock(const unsigned block) {
   std::string bin = "nfaStorage.bin";
   return StringPrintf("%s/%s%u", nfc_storage_path.c_str(), bin.c_str(), block);
 }
+
+// A block waiting for the writer, and the number of nfa_nv_co_write() calls
+// it stands for; a later write of a block replaces the pending data, so a
+// burst of writes ends up in the file only once
+struct PendingBlock {
+  std::vector<uint8_t> data;
+  unsigned writes = 0;
+};
+
+struct NvStore {
+  std::mutex mutex;
+  std::condition_variable cond;
+  // Content of each block as last written or read, reads are served from here
+  std::map<unsigned, std::vector<uint8_t>> cache;
+  std::map<unsigned, PendingBlock> pending;
+  bool busy = false;
+  bool stop = false;
+  std::thread writer;
+};
+
+// Never destroyed, so nothing the writer thread uses goes away at exit
+NvStore& nvStore() {
+  static NvStore* store = new NvStore();
+  return *store;
+}
+
+// Write a block to a temporary file and rename it over the block file, so
+// that a reader or a crash never sees a partially written block.
+bool writeBlockFile(const unsigned block, const std::vector<uint8_t>& data) {
+  std::string filename = getFilenameForBlock(block);
+  std::string tmpname = filename + ".tmp";
+
+  int fileStream =
+      open(tmpname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if (fileStream < 0) {
+    LOG(ERROR) << StringPrintf("%s: fail to open, error = %d", __func__, errno);
+    return false;
+  }
+
+  uint16_t checksum = crcChecksumCompute(data.data(), data.size());
+  ssize_t actualWrittenCrc = write(fileStream, &checksum, sizeof(checksum));
+  ssize_t actualWrittenData = write(fileStream, data.data(), data.size());
+  bool synced = (fsync(fileStream) == 0);
+  close(fileStream);
+
+  LOG(VERBOSE) << StringPrintf("%s: %zd bytes written; file=%s", __func__,
+                               actualWrittenData, filename.c_str());
+  if ((actualWrittenData != (ssize_t)data.size()) ||
+      (actualWrittenCrc != sizeof(checksum)) || (!synced) ||
+      (rename(tmpname.c_str(), filename.c_str()) != 0)) {
+    LOG(ERROR) << StringPrintf("%s: fail to write, error = %d", __func__,
+                               errno);
+    remove(tmpname.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Background writer, takes pending blocks one at a time off the NFC task.
+// Each write is acknowledged once its data is in the file, or has failed.
+// On stop, the writer exits when no block is pending any more.
+void nvWriterThread() {
+  NvStore& nv = nvStore();
+  std::unique_lock<std::mutex> lock(nv.mutex);
+
+  while (true) {
+    nv.cond.wait(lock, [&nv] { return nv.stop || !nv.pending.empty(); });
+    if (nv.pending.empty()) break;
+
+    unsigned block = nv.pending.begin()->first;
+    PendingBlock pending = std::move(nv.pending.begin()->second);
+    nv.pending.erase(nv.pending.begin());
+    nv.busy = true;
+
+    lock.unlock();
+    tNFA_NV_CO_STATUS status =
+        writeBlockFile(block, pending.data) ? NFA_NV_CO_OK : NFA_NV_CO_FAIL;
+    for (unsigned xx = 0; xx < pending.writes; xx++) nfa_nv_ci_write(status);
+    lock.lock();
+
+    nv.busy = false;
+    nv.cond.notify_all();
+  }
+}
+
+// Wait until all pending blocks are in their files
+void flushPendingBlocks(std::unique_lock<std::mutex>& lock) {
+  NvStore& nv = nvStore();
+
+  nv.cond.wait(lock, [&nv] { return nv.pending.empty() && !nv.busy; });
+}
 }  // namespace
 
 /*******************************************************************************
@@ -66,7 +164,8 @@ extern void nfa_mem_co_free(void* pBuffer) { free(pBuffer); }
 ** Function         nfa_nv_co_read
 **
 ** Description      This function is called by NFA to read in data from the
-**                  previously opened file.
+**                  previously opened file. The file is only read the first
+**                  time, later reads are served from memory.
 **
 ** Parameters       pBuffer   - buffer to read the data into.
 **                  nbytes  - number of bytes to read into the buffer.
@@ -82,6 +181,19 @@ extern void nfa_mem_co_free(void* pBuffer) { free(pBuffer); }
 **
 *******************************************************************************/
 extern void nfa_nv_co_read(uint8_t* pBuffer, uint16_t nbytes, uint8_t block) {
+  NvStore& nv = nvStore();
+  std::unique_lock<std::mutex> lock(nv.mutex);
+  auto cached = nv.cache.find(block);
+
+  if (cached != nv.cache.end()) {
+    size_t len = std::min(cached->second.size(), (size_t)nbytes);
+    memcpy(pBuffer, cached->second.data(), len);
+    lock.unlock();
+    LOG(VERBOSE) << StringPrintf("%s: data size=%zu; cached", __func__, len);
+    nfa_nv_ci_read(len, NFA_NV_CO_OK, block);
+    return;
+  }
+
   std::string filename = getFilenameForBlock(block);
 
   LOG(VERBOSE) << StringPrintf("%s: buffer len=%u; file=%s", __func__, nbytes,
@@ -94,16 +206,21 @@ extern void nfa_nv_co_read(uint8_t* pBuffer, uint16_t nbytes, uint8_t block) {
       LOG(ERROR) << StringPrintf("%s: failed to read checksum, errno = 0x%02x",
                                  __func__, errno);
     }
-    size_t actualReadData = read(fileStream, pBuffer, nbytes);
+    ssize_t actualReadData = read(fileStream, pBuffer, nbytes);
     close(fileStream);
     if (actualReadData > 0) {
-      LOG(VERBOSE) << StringPrintf("%s: data size=%zu", __func__, actualReadData);
+      nv.cache[block].assign(pBuffer, pBuffer + actualReadData);
+      lock.unlock();
+      LOG(VERBOSE) << StringPrintf("%s: data size=%zd", __func__,
+                                   actualReadData);
       nfa_nv_ci_read(actualReadData, NFA_NV_CO_OK, block);
     } else {
+      lock.unlock();
       LOG(ERROR) << StringPrintf("%s: fail to read", __func__);
       nfa_nv_ci_read(0, NFA_NV_CO_FAIL, block);
     }
   } else {
+    lock.unlock();
     LOG(VERBOSE) << StringPrintf("%s: fail to open", __func__);
     nfa_nv_ci_read(0, NFA_NV_CO_FAIL, block);
   }
@@ -114,47 +231,88 @@ extern void nfa_nv_co_read(uint8_t* pBuffer, uint16_t nbytes, uint8_t block) {
 ** Function         nfa_nv_co_write
 **
 ** Description      This function is called by io to send file data to the
-**                  phone.
+**                  phone. The data is queued for a background writer, which
+**                  replaces the file atomically. A block written again before
+**                  the writer got to it is written only once.
 **
 ** Parameters       pBuffer   - buffer to read the data from.
 **                  nbytes  - number of bytes to write out to the file.
 **
 ** Returns          void
 **
-**                  Note: Upon completion of the request, nfa_nv_ci_write() is
-**                        called with the file descriptor and the status.  The
-**                        call-in function should only be called when ALL
-**                        requested bytes have been written, or an error has
-**                        been detected,
+**                  Note: nfa_nv_ci_write() is called by the writer once the
+**                        data is in the file, or could not be written.
 **
 *******************************************************************************/
 extern void nfa_nv_co_write(const uint8_t* pBuffer, uint16_t nbytes,
                             uint8_t block) {
-  std::string filename = getFilenameForBlock(block);
+  NvStore& nv = nvStore();
 
-  LOG(VERBOSE) << StringPrintf("%s: bytes=%u; file=%s", __func__, nbytes,
-                             filename.c_str());
+  LOG(VERBOSE) << StringPrintf("%s: bytes=%u; block=%u", __func__, nbytes,
+                               block);
+  {
+    std::lock_guard<std::mutex> lock(nv.mutex);
+    PendingBlock& pending = nv.pending[block];
 
-  int fileStream =
-      open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-  if (fileStream >= 0) {
-    uint16_t checksum = crcChecksumCompute(pBuffer, nbytes);
-    size_t actualWrittenCrc = write(fileStream, &checksum, sizeof(checksum));
-    size_t actualWrittenData = write(fileStream, pBuffer, nbytes);
-    LOG(VERBOSE) << StringPrintf("%s: %zu bytes written", __func__,
-                               actualWrittenData);
-    if ((actualWrittenData == nbytes) &&
-        (actualWrittenCrc == sizeof(checksum))) {
-      nfa_nv_ci_write(NFA_NV_CO_OK);
-    } else {
-      LOG(ERROR) << StringPrintf("%s: fail to write", __func__);
-      nfa_nv_ci_write(NFA_NV_CO_FAIL);
+    nv.cache[block].assign(pBuffer, pBuffer + nbytes);
+    pending.data = nv.cache[block];
+    pending.writes++;
+
+    /* while stopping, the writer still takes what is pending */
+    if (!nv.writer.joinable() && !nv.stop) {
+      nv.writer = std::thread(nvWriterThread);
     }
-    close(fileStream);
-  } else {
-    LOG(ERROR) << StringPrintf("%s: fail to open, error = %d", __func__, errno);
-    nfa_nv_ci_write(NFA_NV_CO_FAIL);
   }
+  nv.cond.notify_all();
+}
+
+/*******************************************************************************
+**
+** Function         nfa_nv_co_flush
+**
+** Description      This function is called by NFA when it is disabled. It
+**                  returns once the data of every nfa_nv_co_write() is in
+**                  its file.
+**
+** Returns          void
+**
+*******************************************************************************/
+extern void nfa_nv_co_flush(void) {
+  LOG(VERBOSE) << StringPrintf("%s", __func__);
+
+  std::unique_lock<std::mutex> lock(nvStore().mutex);
+  flushPendingBlocks(lock);
+}
+
+/*******************************************************************************
+**
+** Function         stop_stack_non_volatile_store
+**
+** Description      Write all pending blocks, then stop the writer thread.
+**                  It is started again by the next write.
+**
+** Parameters       none
+**
+** Returns          none
+**
+*******************************************************************************/
+void stop_stack_non_volatile_store() {
+  NvStore& nv = nvStore();
+  std::thread writer;
+
+  LOG(VERBOSE) << StringPrintf("%s", __func__);
+  {
+    std::lock_guard<std::mutex> lock(nv.mutex);
+    nv.stop = true;
+    writer = std::move(nv.writer);
+  }
+  nv.cond.notify_all();
+  if (writer.joinable()) writer.join();
+
+  std::lock_guard<std::mutex> lock(nv.mutex);
+  nv.stop = false;
+  /* a block written while stopping, after the writer left */
+  if (!nv.pending.empty()) nv.writer = std::thread(nvWriterThread);
 }
 
 /*******************************************************************************
@@ -176,6 +334,10 @@ void delete_stack_non_volatile_store(bool forceDelete) {
 
   LOG(VERBOSE) << StringPrintf("%s", __func__);
 
+  std::unique_lock<std::mutex> lock(nvStore().mutex);
+  flushPendingBlocks(lock);
+  nvStore().cache.clear();
+
   if (remove(getFilenameForBlock(DH_NV_BLOCK).c_str())) {
     LOG(ERROR) << StringPrintf(
         "%s: fail to delete DH_NV_BLOCK file, errno = 0x%02X", __func__, errno);
@@ -220,6 +382,11 @@ void verify_stack_non_volatile_store() {
                                                HC_F3_NV_BLOCK, HC_F4_NV_BLOCK,
                                                HC_F5_NV_BLOCK};
 
+  {
+    std::unique_lock<std::mutex> lock(nvStore().mutex);
+    flushPendingBlocks(lock);
+  }
+
   size_t verified = 0;
   for (auto block : verify_blocks) {
     if (!crcChecksumVerifyIntegrity(getFilenameForBlock(block).c_str())) break;
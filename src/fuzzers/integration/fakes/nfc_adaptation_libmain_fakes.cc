@@ -29,6 +29,8 @@ void nfa_nv_co_write(const uint8_t* pBuffer, uint16_t nbytes,
   nfa_nv_ci_write(NFA_NV_CO_OK);
 }
 
+void nfa_nv_co_flush(void) {}
+
 extern void* nfa_mem_co_alloc(uint32_t num_bytes) {
   // Avoid large allocations that harm fuzzer performance
   if (num_bytes > 100000) {
@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DEBUG_HCE_STATS_
+#define _DEBUG_HCE_STATS_
+
+#include <stdint.h>
+
+/* Max number of distinct AIDs tracked, further AIDs are counted as "other" */
+#define HCE_STATS_MAX_AID 16
+/* Number of buckets in each service time histogram */
+#define HCE_STATS_NUM_BUCKETS 10
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_activated
+**
+** Description      Start tracking APDUs: listen mode ISO-DEP got activated
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_activated(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_deactivated
+**
+** Description      Stop tracking APDUs, discard APDU in progress
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_deactivated(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_select_aid
+**
+** Description      Account following APDUs (including this SELECT) to AID
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_select_aid(const uint8_t* p_aid, uint8_t aid_len);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_rx
+**
+** Description      Record reception of a C-APDU from the RF interface
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_rx(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_delivered
+**
+** Description      Record delivery of the C-APDU to the application
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_delivered(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_app_rsp
+**
+** Description      Record submission of the R-APDU by the application
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_app_rsp(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_tx
+**
+** Description      Record transmission of the R-APDU to NFCC and update
+**                  histograms of the current AID
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_tx(void);
+
+/*******************************************************************************
+**
+** Function         debug_hce_stats_dump
+**
+** Description      Write service time histograms per AID to fd
+**
+** Returns          None
+**
+*******************************************************************************/
+void debug_hce_stats_dump(int fd);
+
+#endif /* _DEBUG_HCE_STATS_ */
@@ -34,6 +34,10 @@
 #define NAME_NFA_DM_DISC_DURATION_POLL "NFA_DM_DISC_DURATION_POLL"
 #define NAME_POLL_FREQUENCY "POLL_FREQUENCY"
 #define NAME_NFA_AID_BLOCK_ROUTE "NFA_AID_BLOCK_ROUTE"
+#define NAME_NFA_AID_ROUTE_COMPACT "NFA_AID_ROUTE_COMPACT"
+#define NAME_NFA_EE_MAX_AID_ENTRIES "NFA_EE_MAX_AID_ENTRIES"
+#define NAME_NFA_EE_MAX_APDU_IN_FLIGHT "NFA_EE_MAX_APDU_IN_FLIGHT"
+#define NAME_NFA_HCI_MAX_MSG_LEN "NFA_HCI_MAX_MSG_LEN"
 #define NAME_AID_FOR_EMPTY_SELECT "AID_FOR_EMPTY_SELECT"
 #define NAME_AID_MATCHING_MODE "AID_MATCHING_MODE"
 #define NAME_OFFHOST_AID_ROUTE_PWR_STATE "OFFHOST_AID_ROUTE_PWR_STATE"
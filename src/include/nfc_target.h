@@ -285,13 +285,14 @@
 #define CE_T3T_MRTI_U 0xFF
 #endif
 
-/* Default maxblocks for CE_T3T UPDATE/CHECK operations */
+/* Default maxblocks for CE_T3T UPDATE/CHECK operations. 0 means the largest
+ * number of blocks that fits into one NFC-F frame */
 #ifndef CE_T3T_DEFAULT_UPDATE_MAXBLOCKS
-#define CE_T3T_DEFAULT_UPDATE_MAXBLOCKS 3
+#define CE_T3T_DEFAULT_UPDATE_MAXBLOCKS 0
 #endif
 
 #ifndef CE_T3T_DEFAULT_CHECK_MAXBLOCKS
-#define CE_T3T_DEFAULT_CHECK_MAXBLOCKS 3
+#define CE_T3T_DEFAULT_CHECK_MAXBLOCKS 0
 #endif
 
 /* CE Type 4 Tag, Frame Waiting time Integer */
@@ -304,6 +305,12 @@
 #define RW_T4T_TOUT_RESP 1000
 #endif
 
+/* RW Type 4 Tag timeout added per KB of the largest C-APDU/R-APDU, in ms,
+ * when Extended Field Coding is used (about 106 kbps with ISO-DEP framing) */
+#ifndef RW_T4T_TOUT_RESP_PER_KB
+#define RW_T4T_TOUT_RESP_PER_KB 100
+#endif
+
 /* CE Type 4 Tag timeout for update file, in ms */
 #ifndef CE_T4T_TOUT_UPDATE
 #define CE_T4T_TOUT_UPDATE 1000
@@ -374,6 +381,12 @@
 #define NFA_HCI_MAX_PIPE_CB 0x0A
 #endif
 
+/* Max size of a reassembled HCP message, upper bound of NFA_HCI_MAX_MSG_LEN
+ * in libnfc-nci.conf */
+#ifndef NFA_HCI_MAX_MSG_LEN
+#define NFA_HCI_MAX_MSG_LEN 0x8000
+#endif
+
 /* Timeout for waiting for the response to HCP Command packet */
 #ifndef NFA_HCI_RESPONSE_TIMEOUT
 #define NFA_HCI_RESPONSE_TIMEOUT 1000
@@ -470,9 +483,30 @@
 #define NFA_EE_MAX_EE_SUPPORTED 6
 #endif
 
-/* Maximum number of AID entries per target_handle  */
+/* Maximum number of AID entries per target_handle, upper bound of
+ * NFA_EE_MAX_AID_ENTRIES in libnfc-nci.conf */
 #ifndef NFA_EE_MAX_AID_ENTRIES
-#define NFA_EE_MAX_AID_ENTRIES (32)
+#define NFA_EE_MAX_AID_ENTRIES (2048)
+#endif
+
+/* Number of AID entries allocated with the first AID of a target_handle */
+#ifndef NFA_EE_AID_INIT_ENTRIES
+#define NFA_EE_AID_INIT_ENTRIES (16)
+#endif
+
+/* Initial and maximum number of slots in the AID index (power of 2) */
+#ifndef NFA_EE_AID_IDX_INIT_SIZE
+#define NFA_EE_AID_IDX_INIT_SIZE 32
+#endif
+#ifndef NFA_EE_AID_IDX_MAX_SIZE
+#define NFA_EE_AID_IDX_MAX_SIZE 8192
+#endif
+
+/* Default number of C-APDUs in flight on the APDU connection of an NFCEE.
+ * 1 keeps ISO 7816 command/response, NFA_EE_MAX_APDU_IN_FLIGHT in the
+ * config file raises it for NFCEEs which accept pipelined C-APDUs */
+#ifndef NFA_EE_MAX_APDU_IN_FLIGHT
+#define NFA_EE_MAX_APDU_IN_FLIGHT (1)
 #endif
 
 /* Maximum number of callback functions can be registered through
@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "ce_api.h"
+#include "include/debug_hce_stats.h"
 #include "ndef_utils.h"
 #include "nfa_ce_int.h"
 #include "nfa_mem_co.h"
@@ -249,7 +250,14 @@ void nfa_ce_handle_t4t_aid_evt(tCE_EVENT event, tCE_DATA* p_ce_data) {
       conn_evt.ce_data.p_data = (uint8_t*)(p_ce_data->raw_frame.p_data + 1) +
                                 p_ce_data->raw_frame.p_data->offset;
       conn_evt.ce_data.len = p_ce_data->raw_frame.p_data->len;
-      (*p_cb->p_active_conn_cback)(NFA_CE_DATA_EVT, &conn_evt);
+      debug_hce_stats_delivered();
+      if (p_cb->listen_info[p_cb->idx_cur_active].p_apdu_cback) {
+        (*p_cb->listen_info[p_cb->idx_cur_active].p_apdu_cback)(
+            conn_evt.ce_data.handle, conn_evt.ce_data.status,
+            conn_evt.ce_data.p_data, conn_evt.ce_data.len);
+      } else {
+        (*p_cb->p_active_conn_cback)(NFA_CE_DATA_EVT, &conn_evt);
+      }
     } else {
       LOG(ERROR) << StringPrintf(
           "nfa_ce_handle_t4t_aid_evt: unable to find listen_info for aid hdl "
@@ -1307,6 +1315,7 @@ bool nfa_ce_api_reg_listen(tNFA_CE_MSG* p_ce_msg) {
         NFA_CE_LISTEN_INFO_IN_USE | NFA_CE_LISTEN_INFO_START_NTF_PND;
     p_cb->listen_info[listen_info_idx].rf_disc_handle = NFA_HANDLE_INVALID;
     p_cb->listen_info[listen_info_idx].protocol_mask = 0;
+    p_cb->listen_info[listen_info_idx].p_apdu_cback = nullptr;
 
     /* Store type-specific parameters */
     switch (p_ce_msg->reg_listen.listen_type) {
@@ -1513,3 +1522,32 @@ bool nfa_ce_api_cfg_isodep_tech(tNFA_CE_MSG* p_ce_msg) {
     nfa_ce_cb.isodep_disc_mask |= NFA_DM_DISC_MASK_LB_ISO_DEP;
   return true;
 }
+
+/*******************************************************************************
+**
+** Function         nfa_ce_api_set_apdu_cback
+**
+** Description      Set direct C-APDU callback for a registered T4T AID
+**
+** Returns          TRUE (message buffer to be freed by caller)
+**
+*******************************************************************************/
+bool nfa_ce_api_set_apdu_cback(tNFA_CE_MSG* p_ce_msg) {
+  tNFA_CE_CB* p_cb = &nfa_ce_cb;
+  uint8_t listen_info_idx =
+      p_ce_msg->set_apdu_cback.handle & NFA_HANDLE_MASK;
+
+  if ((listen_info_idx >= NFA_CE_LISTEN_INFO_IDX_INVALID) ||
+      !(p_cb->listen_info[listen_info_idx].flags & NFA_CE_LISTEN_INFO_IN_USE) ||
+      !(p_cb->listen_info[listen_info_idx].flags &
+        NFA_CE_LISTEN_INFO_T4T_AID)) {
+    LOG(ERROR) << StringPrintf("Invalid handle 0x%04x",
+                               p_ce_msg->set_apdu_cback.handle);
+    return true;
+  }
+
+  p_cb->listen_info[listen_info_idx].p_apdu_cback =
+      p_ce_msg->set_apdu_cback.p_apdu_cback;
+
+  return true;
+}
@@ -25,6 +25,7 @@
 #include <android-base/stringprintf.h>
 #include <string.h>
 
+#include "include/debug_hce_stats.h"
 #include "nfa_api.h"
 #include "nfa_ce_int.h"
 
@@ -424,3 +425,104 @@ tNFA_STATUS NFA_CeSetIsoDepListenTech(tNFA_TECHNOLOGY_MASK tech_mask) {
 
   return (NFA_STATUS_FAILED);
 }
+
+/*******************************************************************************
+**
+** Function         NFA_CeSetApduCback
+**
+** Description      Opt in to direct delivery of C-APDUs for an ISODEP AID
+**                  registered using NFA_CeRegisterAidOnDH.
+**
+**                  C-APDUs are passed to p_apdu_cback in NFC task context
+**                  instead of NFA_CE_DATA_EVT. Activation and deactivation
+**                  are still reported to the tNFA_CONN_CBACK of the AID.
+**                  Set p_apdu_cback to NULL to return to NFA_CE_DATA_EVT.
+**
+**                  The R-APDU is sent using NFA_CeSendApduRsp.
+**
+** Returns:
+**                  NFA_STATUS_OK, if command accepted
+**                  NFA_STATUS_BAD_HANDLE if invalid handle
+**                  NFA_STATUS_FAILED: otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_CeSetApduCback(tNFA_HANDLE handle,
+                               tNFA_CE_APDU_CBACK* p_apdu_cback) {
+  tNFA_CE_MSG* p_msg;
+
+  LOG(VERBOSE) << StringPrintf("handle:0x%X", handle);
+
+  if ((handle & NFA_HANDLE_GROUP_MASK) != NFA_HANDLE_GROUP_CE) {
+    LOG(ERROR) << StringPrintf("Invalid handle");
+    return (NFA_STATUS_BAD_HANDLE);
+  }
+
+  p_msg = (tNFA_CE_MSG*)GKI_getbuf((uint16_t)sizeof(tNFA_CE_MSG));
+  if (p_msg != nullptr) {
+    p_msg->hdr.event = NFA_CE_API_SET_APDU_CBACK_EVT;
+    p_msg->set_apdu_cback.handle = handle;
+    p_msg->set_apdu_cback.p_apdu_cback = p_apdu_cback;
+
+    nfa_sys_sendmsg(p_msg);
+
+    return (NFA_STATUS_OK);
+  }
+
+  return (NFA_STATUS_FAILED);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_CeSendApduRsp
+**
+** Description      Send R-APDU for the C-APDU received by the AID callback.
+**
+**                  If called from tNFA_CE_APDU_CBACK, the R-APDU is queued to
+**                  the RF connection right away. Otherwise, this is the same
+**                  as NFA_SendRawFrame.
+**
+**                  p_rsp is copied into a GKI buffer in both cases and may be
+**                  reused as soon as this function returns.
+**
+** Returns:
+**                  NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_INVALID_PARAM if invalid parameter
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFA_STATUS NFA_CeSendApduRsp(uint8_t* p_rsp, uint16_t rsp_len) {
+  NFC_HDR* p_msg;
+  uint16_t size;
+
+  /* Not in NFC task context: post to NFA as any raw frame */
+  if (GKI_get_taskid() != NFC_TASK) {
+    return NFA_SendRawFrame(p_rsp, rsp_len, 0);
+  }
+
+  LOG(VERBOSE) << StringPrintf("rsp_len:%d", rsp_len);
+
+  if ((p_rsp == nullptr) || (rsp_len == 0)) return (NFA_STATUS_INVALID_PARAM);
+
+  debug_hce_stats_app_rsp();
+
+  size = NFC_HDR_SIZE + NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE + rsp_len;
+  /* Check for integer overflow */
+  if (size < rsp_len) return (NFA_STATUS_INVALID_PARAM);
+
+  p_msg = (NFC_HDR*)GKI_getbuf(size);
+  if (p_msg == nullptr) return (NFA_STATUS_FAILED);
+
+  p_msg->event = NFA_DM_API_RAW_FRAME_EVT;
+  p_msg->layer_specific = 0;
+  p_msg->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
+  p_msg->len = rsp_len;
+  memcpy((uint8_t*)(p_msg + 1) + p_msg->offset, p_rsp, rsp_len);
+
+  /* Bypass NFA mailbox, R-APDU goes straight to the RF connection */
+  if (nfa_dm_act_send_raw_frame((tNFA_DM_MSG*)p_msg)) {
+    GKI_freebuf(p_msg);
+    return (NFA_STATUS_FAILED);
+  }
+
+  return (NFA_STATUS_OK);
+}
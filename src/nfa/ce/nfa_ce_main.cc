@@ -52,6 +52,7 @@ const tNFA_CE_ACTION nfa_ce_action_tbl[] = {
     nfa_ce_api_cfg_isodep_tech, /* NFA_CE_API_CFG_ISODEP_TECH_EVT*/
     nfa_ce_activate_ntf,        /* NFA_CE_ACTIVATE_NTF_EVT      */
     nfa_ce_deactivate_ntf,      /* NFA_CE_DEACTIVATE_NTF_EVT    */
+    nfa_ce_api_set_apdu_cback,  /* NFA_CE_API_SET_APDU_CBACK_EVT */
 };
 #define NFA_CE_ACTION_TBL_SIZE \
   (sizeof(nfa_ce_action_tbl) / sizeof(tNFA_CE_ACTION))
@@ -209,6 +210,8 @@ static std::string nfa_ce_evt_2_str(uint16_t event) {
       return "NFA_CE_ACTIVATE_NTF_EVT";
     case NFA_CE_DEACTIVATE_NTF_EVT:
       return "NFA_CE_DEACTIVATE_NTF_EVT";
+    case NFA_CE_API_SET_APDU_CBACK_EVT:
+      return "NFA_CE_API_SET_APDU_CBACK_EVT";
     default:
       return "Unknown";
   }
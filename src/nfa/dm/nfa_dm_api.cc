@@ -26,6 +26,7 @@
 #include <log/log.h>
 #include <string.h>
 
+#include "include/debug_hce_stats.h"
 #include "ndef_utils.h"
 #include "nfa_api.h"
 #include "nfa_ce_int.h"
@@ -815,6 +816,8 @@ tNFA_STATUS NFA_SendRawFrame(uint8_t* p_raw_data, uint16_t data_len,
 
   LOG(VERBOSE) << StringPrintf("data_len:%d", data_len);
 
+  debug_hce_stats_app_rsp();
+
   size = NFC_HDR_SIZE + NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE + data_len;
   /* Check for integer overflow */
   if (size < data_len) {
@@ -26,12 +26,15 @@
 #include <statslog_nfc.h>
 #include <string.h>
 
+#include <vector>
+
 #include "include/debug_lmrt.h"
 #include "metrics.h"
 #include "nfa_api.h"
 #include "nfa_dm_int.h"
 #include "nfa_ee_int.h"
 #include "nfa_hci_int.h"
+#include "nfc_config.h"
 #include "nfc_int.h"
 
 using android::base::StringPrintf;
@@ -109,6 +112,18 @@ static void nfa_ee_report_discover_req_evt(void);
 static void nfa_ee_build_discover_req_evt(tNFA_EE_DISCOVER_REQ* p_evt_data);
 void nfa_ee_check_set_routing(uint16_t new_size, int* p_max_len, uint8_t* p,
                               int* p_cur_offset);
+
+/* RF_SET_LISTEN_MODE_ROUTING commands of the LMRT being built and of the
+ * LMRT last sent to NFCC, each command as more, num_tlv, tlv_size, tlvs */
+static std::vector<uint8_t> nfa_ee_lmrt_pend;
+static std::vector<uint8_t> nfa_ee_lmrt_sent;
+static void nfa_ee_queue_routing(bool more, uint8_t num_tlv, uint8_t tlv_size,
+                                 uint8_t* p_tlvs);
+static void nfa_ee_commit_routing(void);
+static uint16_t nfa_ee_compile_aid_route(void);
+static void nfa_ee_uncover_aid(uint8_t aid_len);
+static bool nfa_ee_aid_idx_grow(void);
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_trace_aid
@@ -302,6 +317,14 @@ static uint16_t nfa_ee_total_lmrt_size(void) {
       lmrt_size += p_cb->size_sys_code;
     }
   }
+  /* the AID entries left out of the LMRT, as of the last compile. If an
+   * add or remove may have cost coverage since, compile again, but only if
+   * the LMRT and the largest entry to add don't fit without the saving */
+  if (nfa_ee_cb.aid_saved_stale &&
+      (lmrt_size + 4 + NFA_MAX_AID_LEN > NFC_GetLmrtSize()))
+    nfa_ee_compile_aid_route();
+  if (!nfa_ee_cb.aid_saved_stale && (nfa_ee_cb.aid_saved <= lmrt_size))
+    lmrt_size -= nfa_ee_cb.aid_saved;
   LOG(VERBOSE) << StringPrintf("nfa_ee_total_lmrt_size size:%d", lmrt_size);
   return lmrt_size;
 }
@@ -479,7 +502,8 @@ static void nfa_ee_add_aid_route_to_ecb(tNFA_EE_ECB* p_cb, uint8_t* pp,
       uint8_t route_qual = 0;
       uint8_t* p_start = pp;
       /* add one AID entry */
-      if (p_cb->aid_rt_info[xx] & NFA_EE_AE_ROUTE) {
+      if ((p_cb->aid_rt_info[xx] & NFA_EE_AE_ROUTE) &&
+          !(p_cb->aid_rt_info[xx] & NFA_EE_AE_COVERED)) {
         num_tlv++;
         uint8_t* pa = &p_cb->aid_cfg[start_offset];
 
@@ -712,45 +736,502 @@ int nfa_all_ee_find_total_sys_code_len() {
 
 /*******************************************************************************
 **
-** Function         nfa_ee_find_aid_offset
+** Function         nfa_ee_aid_idx_hash
 **
-** Description      Given the AID, find the associated tNFA_EE_ECB and the
-**                  offset in aid_cfg[]. *p_entry is the index.
+** Description      Hash (FNV-1a) of the AID into the AID index
+**
+** Returns          slot index
+**
+*******************************************************************************/
+static uint16_t nfa_ee_aid_idx_hash(uint8_t aid_len, const uint8_t* p_aid) {
+  uint32_t hash = 2166136261u;
+
+  for (int xx = 0; xx < aid_len; xx++) {
+    hash ^= p_aid[xx];
+    hash *= 16777619u;
+  }
+  return (uint16_t)(hash & (nfa_ee_cb.aid_idx_size - 1));
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_idx_find
+**
+** Description      Find the slot of the given AID in the AID index
+**
+** Returns          the slot or nullptr, if AID is not in the index
+**
+*******************************************************************************/
+static tNFA_EE_AID_IDX* nfa_ee_aid_idx_find(uint8_t aid_len,
+                                            const uint8_t* p_aid) {
+  tNFA_EE_AID_IDX* p_idx;
+  uint8_t* pa;
+  uint16_t xx;
+
+  if (!nfa_ee_cb.aid_idx) return nullptr;
+
+  xx = nfa_ee_aid_idx_hash(aid_len, p_aid);
+  while (nfa_ee_cb.aid_idx[xx].ecb_idx != NFA_EE_AID_IDX_FREE) {
+    p_idx = &nfa_ee_cb.aid_idx[xx];
+    pa = &nfa_ee_cb.ecb[p_idx->ecb_idx].aid_cfg[p_idx->offset];
+    /* skip the tag */
+    if ((pa[1] == aid_len) && (memcmp(&pa[2], p_aid, aid_len) == 0))
+      return p_idx;
+    xx = (xx + 1) & (nfa_ee_cb.aid_idx_size - 1);
+  }
+  return nullptr;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_idx_add
+**
+** Description      Add the AID entry of the given ECB to the AID index. The
+**                  AID TLV must already be stored at offset in aid_cfg[].
+**
+** Returns          TRUE, if added
+**
+*******************************************************************************/
+static bool nfa_ee_aid_idx_add(tNFA_EE_ECB* p_cb, int entry, int offset) {
+  uint8_t* pa = &p_cb->aid_cfg[offset];
+  uint16_t xx, count;
+
+  /* keep the load factor at most 1/2 */
+  if (((nfa_ee_cb.aid_idx_count + 1) * 2 > nfa_ee_cb.aid_idx_size) &&
+      (nfa_ee_cb.aid_idx_size < NFA_EE_AID_IDX_MAX_SIZE))
+    nfa_ee_aid_idx_grow();
+
+  if (!nfa_ee_cb.aid_idx) return false;
+
+  /* keep one slot free to terminate the probing */
+  xx = nfa_ee_aid_idx_hash(pa[1], &pa[2]);
+  for (count = 1; nfa_ee_cb.aid_idx[xx].ecb_idx != NFA_EE_AID_IDX_FREE;
+       count++) {
+    if (count == nfa_ee_cb.aid_idx_size - 1) {
+      LOG(ERROR) << StringPrintf("AID index full, size:%d",
+                                 nfa_ee_cb.aid_idx_size);
+      return false;
+    }
+    xx = (xx + 1) & (nfa_ee_cb.aid_idx_size - 1);
+  }
+
+  nfa_ee_cb.aid_idx[xx].ecb_idx = (uint8_t)(p_cb - nfa_ee_cb.ecb);
+  nfa_ee_cb.aid_idx[xx].entry = (uint16_t)entry;
+  nfa_ee_cb.aid_idx[xx].offset = (uint16_t)offset;
+  nfa_ee_cb.aid_idx_count++;
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_idx_remove
+**
+** Description      Remove the slot from the AID index. Following slots of the
+**                  same probe sequence are moved back, so that lookups do not
+**                  need tombstones.
 **
 ** Returns          void
 **
 *******************************************************************************/
-tNFA_EE_ECB* nfa_ee_find_aid_offset(uint8_t aid_len, uint8_t* p_aid,
-                                    int* p_offset, int* p_entry) {
-  int xx, yy, aid_len_offset, offset;
-  tNFA_EE_ECB *p_ret = nullptr, *p_ecb;
+static void nfa_ee_aid_idx_remove(tNFA_EE_AID_IDX* p_idx) {
+  uint16_t mask = nfa_ee_cb.aid_idx_size - 1;
+  uint16_t hole = (uint16_t)(p_idx - nfa_ee_cb.aid_idx);
+  uint16_t xx = hole, home;
+  uint8_t* pa;
 
-  p_ecb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
-  aid_len_offset = 1; /* skip the tag */
-  for (yy = 0; yy <= nfa_ee_cb.cur_ee; yy++) {
-    if (p_ecb->aid_entries) {
-      offset = 0;
-      for (xx = 0; xx < p_ecb->aid_entries; xx++) {
-        if ((p_ecb->aid_cfg[offset + aid_len_offset] == aid_len) &&
-            (memcmp(&p_ecb->aid_cfg[offset + aid_len_offset + 1], p_aid,
-                    aid_len) == 0)) {
-          p_ret = p_ecb;
-          if (p_offset) *p_offset = offset;
-          if (p_entry) *p_entry = xx;
-          break;
+  while (true) {
+    xx = (xx + 1) & mask;
+    p_idx = &nfa_ee_cb.aid_idx[xx];
+    if (p_idx->ecb_idx == NFA_EE_AID_IDX_FREE) break;
+
+    pa = &nfa_ee_cb.ecb[p_idx->ecb_idx].aid_cfg[p_idx->offset];
+    home = nfa_ee_aid_idx_hash(pa[1], &pa[2]);
+    /* move the slot into the hole, unless its home is cyclically in
+     * (hole, xx] */
+    if (((xx - home) & mask) >= ((xx - hole) & mask)) {
+      nfa_ee_cb.aid_idx[hole] = *p_idx;
+      hole = xx;
+    }
+  }
+  nfa_ee_cb.aid_idx[hole].ecb_idx = NFA_EE_AID_IDX_FREE;
+  nfa_ee_cb.aid_idx_count--;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_idx_rebuild
+**
+** Description      Rebuild the AID index from the AID entries of DH and the
+**                  discovered NFCEEs, e.g. after ECBs got moved
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_aid_idx_rebuild(void) {
+  tNFA_EE_ECB* p_cb;
+  int xx, yy, offset;
+
+  if (!nfa_ee_cb.aid_idx) return;
+
+  for (xx = 0; xx < nfa_ee_cb.aid_idx_size; xx++)
+    nfa_ee_cb.aid_idx[xx].ecb_idx = NFA_EE_AID_IDX_FREE;
+  nfa_ee_cb.aid_idx_count = 0;
+
+  for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++) {
+    if ((xx != NFA_EE_CB_4_DH) && (xx >= nfa_ee_cb.cur_ee)) continue;
+    p_cb = &nfa_ee_cb.ecb[xx];
+    offset = 0;
+    for (yy = 0; yy < p_cb->aid_entries; yy++) {
+      if (!(p_cb->aid_rt_info[yy] & NFA_EE_AE_REMOVED))
+        nfa_ee_aid_idx_add(p_cb, yy, offset);
+      offset += p_cb->aid_len[yy];
+    }
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_idx_grow
+**
+** Description      Double the number of slots in the AID index
+**
+** Returns          TRUE, if grown
+**
+*******************************************************************************/
+static bool nfa_ee_aid_idx_grow(void) {
+  uint16_t size = (nfa_ee_cb.aid_idx_size) ? (nfa_ee_cb.aid_idx_size << 1)
+                                           : NFA_EE_AID_IDX_INIT_SIZE;
+  tNFA_EE_AID_IDX* p_idx =
+      (tNFA_EE_AID_IDX*)GKI_getbuf(size * sizeof(tNFA_EE_AID_IDX));
+
+  if (p_idx == nullptr) {
+    LOG(ERROR) << StringPrintf("GKI_getbuf allocation for AID index failed !");
+    return false;
+  }
+
+  if (nfa_ee_cb.aid_idx) GKI_freebuf(nfa_ee_cb.aid_idx);
+  nfa_ee_cb.aid_idx = p_idx;
+  nfa_ee_cb.aid_idx_size = size;
+  nfa_ee_aid_idx_rebuild();
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_grow_aid
+**
+** Description      Make sure the AID arrays of the given ECB have room for one
+**                  more entry and cfg_len bytes in aid_cfg[]. The arrays are
+**                  reallocated with double size, up to the configured max.
+**
+** Returns          TRUE, if there is room
+**
+*******************************************************************************/
+static bool nfa_ee_grow_aid(tNFA_EE_ECB* p_cb, int cfg_len) {
+  int entries = p_cb->aid_alloc_entries;
+  int alloc_cfg_len = p_cb->aid_alloc_cfg_len;
+  uint8_t* p;
+
+  if ((p_cb->aid_entries < entries) && (cfg_len <= alloc_cfg_len)) return true;
+
+  if (p_cb->aid_entries >= entries)
+    entries = (entries) ? (entries * 2) : NFA_EE_AID_INIT_ENTRIES;
+  if (entries > nfa_ee_cb.aid_max_entries)
+    entries = nfa_ee_cb.aid_max_entries;
+  if (alloc_cfg_len == 0)
+    alloc_cfg_len = NFA_EE_AID_INIT_ENTRIES * (2 + NFA_MIN_AID_LEN);
+  while (alloc_cfg_len < cfg_len) alloc_cfg_len *= 2;
+  if (alloc_cfg_len > nfa_ee_cb.aid_max_cfg_len)
+    alloc_cfg_len = nfa_ee_cb.aid_max_cfg_len;
+  if ((p_cb->aid_entries >= entries) || (cfg_len > alloc_cfg_len)) return false;
+
+  /* aid_len, aid_pwr_cfg, aid_rt_info, aid_info, aid_cfg */
+  p = (uint8_t*)GKI_getbuf(4 * entries + alloc_cfg_len);
+  if (p == nullptr) {
+    LOG(ERROR) << StringPrintf("GKI_getbuf allocation for ECB failed !");
+    return false;
+  }
+  memset(p, 0, 4 * entries + alloc_cfg_len);
+
+  if (p_cb->aid_len) {
+    memcpy(p, p_cb->aid_len, p_cb->aid_entries);
+    memcpy(p + entries, p_cb->aid_pwr_cfg, p_cb->aid_entries);
+    memcpy(p + 2 * entries, p_cb->aid_rt_info, p_cb->aid_entries);
+    memcpy(p + 3 * entries, p_cb->aid_info, p_cb->aid_entries);
+    memcpy(p + 4 * entries, p_cb->aid_cfg, p_cb->aid_alloc_cfg_len);
+    GKI_freebuf(p_cb->aid_len);
+  }
+  p_cb->aid_len = p;
+  p_cb->aid_pwr_cfg = p + entries;
+  p_cb->aid_rt_info = p + 2 * entries;
+  p_cb->aid_info = p + 3 * entries;
+  p_cb->aid_cfg = p + 4 * entries;
+  p_cb->aid_alloc_entries = (uint16_t)entries;
+  p_cb->aid_alloc_cfg_len = (uint16_t)alloc_cfg_len;
+
+  LOG(VERBOSE) << StringPrintf("%s nfcee_id:0x%x entries:%d cfg_len:%d",
+                               __func__, p_cb->nfcee_id, entries,
+                               alloc_cfg_len);
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_free_aid
+**
+** Description      Free the AID arrays of the given ECB. The caller removes
+**                  its AID entries from the AID index or rebuilds the index.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_free_aid(tNFA_EE_ECB* p_cb) {
+  if (p_cb->aid_len) GKI_freebuf(p_cb->aid_len);
+  p_cb->aid_len = p_cb->aid_pwr_cfg = p_cb->aid_rt_info = nullptr;
+  p_cb->aid_info = p_cb->aid_cfg = nullptr;
+  p_cb->aid_alloc_entries = p_cb->aid_alloc_cfg_len = 0;
+  p_cb->aid_entries = p_cb->aid_rm_entries = 0;
+  p_cb->size_aid = 0;
+  /* covered entries are found again by the next compile */
+  nfa_ee_cb.aid_saved = 0;
+  nfa_ee_cb.aid_saved_stale = false;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_remove_all_aid
+**
+** Description      Remove all AID entries of the given ECB
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_remove_all_aid(tNFA_EE_ECB* p_cb) {
+  tNFA_EE_AID_IDX* p_idx;
+  uint8_t* pa;
+  int xx, offset = 0;
+
+  for (xx = 0; xx < p_cb->aid_entries; xx++) {
+    if (!(p_cb->aid_rt_info[xx] & NFA_EE_AE_REMOVED)) {
+      pa = &p_cb->aid_cfg[offset];
+      p_idx = nfa_ee_aid_idx_find(pa[1], &pa[2]);
+      if (p_idx) nfa_ee_aid_idx_remove(p_idx);
+      if (p_cb->aid_rt_info[xx] & NFA_EE_AE_COVERED)
+        nfa_ee_uncover_aid(pa[1]);
+    }
+    offset += p_cb->aid_len[xx];
+  }
+  p_cb->aid_entries = 0;
+  p_cb->aid_rm_entries = 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_compact_aid
+**
+** Description      Reclaim the room of the removed AID entries of the given
+**                  ECB and update the AID index to the new positions
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_compact_aid(tNFA_EE_ECB* p_cb) {
+  tNFA_EE_AID_IDX* p_idx;
+  uint8_t* pa;
+  int xx, yy = 0, offset = 0, new_offset = 0;
+  uint8_t len;
+
+  if (!p_cb->aid_rm_entries) return;
+
+  for (xx = 0; xx < p_cb->aid_entries; xx++) {
+    len = p_cb->aid_len[xx];
+    if (!(p_cb->aid_rt_info[xx] & NFA_EE_AE_REMOVED)) {
+      if (yy != xx) {
+        /* look up before moving: the slot refers to the current offset */
+        pa = &p_cb->aid_cfg[offset];
+        p_idx = nfa_ee_aid_idx_find(pa[1], &pa[2]);
+        memmove(&p_cb->aid_cfg[new_offset], pa, len);
+        p_cb->aid_len[yy] = len;
+        p_cb->aid_pwr_cfg[yy] = p_cb->aid_pwr_cfg[xx];
+        p_cb->aid_rt_info[yy] = p_cb->aid_rt_info[xx];
+        p_cb->aid_info[yy] = p_cb->aid_info[xx];
+        if (p_idx) {
+          p_idx->entry = (uint16_t)yy;
+          p_idx->offset = (uint16_t)new_offset;
         }
-        offset += p_ecb->aid_len[xx];
       }
+      yy++;
+      new_offset += len;
+    }
+    offset += len;
+  }
 
-      if (p_ret) {
-        /* found the entry already */
-        break;
+  LOG(VERBOSE) << StringPrintf("%s nfcee_id:0x%x entries:%d->%d", __func__,
+                               p_cb->nfcee_id, p_cb->aid_entries, yy);
+  p_cb->aid_entries = (uint16_t)yy;
+  p_cb->aid_rm_entries = 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_compile_aid_route
+**
+** Description      Mark the AID entries, which need no LMRT entry, as
+**                  NFA_EE_AE_COVERED: a long select (prefix) entry to the same
+**                  NFCEE with the same power state matches them already, and
+**                  no AID routed differently overlaps them. The empty AID is
+**                  not taken as overlapping, NFCC uses it only if no other
+**                  entry matches.
+**
+** Returns          the size saved in the LMRT
+**
+*******************************************************************************/
+static uint16_t nfa_ee_compile_aid_route(void) {
+  uint32_t start_tick = GKI_get_os_tick_count();
+  tNFA_EE_ECB *p_cb, *p_anc_cb;
+  tNFA_EE_AID_IDX* p_idx;
+  uint8_t *pa, len;
+  int pass, xx, yy, offset, ll, anc;
+  int covered = 0;
+  uint16_t saved = 0;
+
+  for (pass = 0; pass < 3; pass++) {
+    for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++) {
+      if ((xx != NFA_EE_CB_4_DH) && (xx >= nfa_ee_cb.cur_ee)) continue;
+      p_cb = &nfa_ee_cb.ecb[xx];
+      offset = 0;
+      for (yy = 0; yy < p_cb->aid_entries; offset += p_cb->aid_len[yy++]) {
+        if (pass == 0) {
+          p_cb->aid_rt_info[yy] &= ~(NFA_EE_AE_COVERED | NFA_EE_AE_OVERLAP);
+          continue;
+        }
+        if (!(p_cb->aid_rt_info[yy] & NFA_EE_AE_ROUTE)) continue;
+        pa = &p_cb->aid_cfg[offset + 2];
+        len = p_cb->aid_cfg[offset + 1];
+
+        /* pass 2 looks for a covering entry, so skip entries which can't
+         * be covered */
+        if ((pass == 2) && ((p_cb->aid_rt_info[yy] & NFA_EE_AE_OVERLAP) ||
+                            (p_cb->aid_info[yy] & NCI_ROUTE_QUAL_SHORT_SELECT) ||
+                            (p_cb->ee_status != NFC_NFCEE_STATUS_ACTIVE)))
+          continue;
+
+        /* look up all prefixes of the AID */
+        for (ll = 0; ll < len; ll++) {
+          p_idx = nfa_ee_aid_idx_find(ll, pa);
+          if (p_idx == nullptr) continue;
+          p_anc_cb = &nfa_ee_cb.ecb[p_idx->ecb_idx];
+          anc = p_idx->entry;
+          if (!(p_anc_cb->aid_rt_info[anc] & NFA_EE_AE_ROUTE)) continue;
+
+          if (pass == 1) {
+            if ((p_anc_cb != p_cb) ||
+                (p_anc_cb->aid_pwr_cfg[anc] != p_cb->aid_pwr_cfg[yy])) {
+              p_anc_cb->aid_rt_info[anc] |= NFA_EE_AE_OVERLAP;
+              if (ll) p_cb->aid_rt_info[yy] |= NFA_EE_AE_OVERLAP;
+            }
+          } else if ((p_anc_cb == p_cb) &&
+                     (p_cb->aid_pwr_cfg[anc] == p_cb->aid_pwr_cfg[yy]) &&
+                     (p_cb->aid_info[anc] & NCI_ROUTE_QUAL_LONG_SELECT)) {
+            p_cb->aid_rt_info[yy] |= NFA_EE_AE_COVERED;
+            /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
+            saved += 4 + len;
+            covered++;
+            break;
+          }
+        }
       }
     }
-    p_ecb = &nfa_ee_cb.ecb[yy];
   }
 
-  return p_ret;
+  LOG(VERBOSE) << StringPrintf(
+      "%s covered:%d saved:%d in %u ms", __func__, covered, saved,
+      GKI_TICKS_TO_MS(GKI_get_os_tick_count() - start_tick));
+  nfa_ee_cb.aid_saved = saved;
+  nfa_ee_cb.aid_saved_stale = false;
+  return saved;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_covered
+**
+** Description      Check if a new AID entry would be covered by an AID entry
+**                  in the database, see nfa_ee_compile_aid_route(). Longer
+**                  AIDs routed differently are not looked for: the covering
+**                  entry would be their prefix too, so one marked overlapping
+**                  by the last compile does not cover the new AID.
+**
+** Returns          true, if covered
+**
+*******************************************************************************/
+static bool nfa_ee_aid_covered(tNFA_EE_ECB* p_cb, uint8_t aid_len,
+                               uint8_t* p_aid, tNFA_EE_PWR_STATE power_state,
+                               uint8_t aidInfo) {
+  tNFA_EE_ECB* p_anc_cb;
+  tNFA_EE_AID_IDX* p_idx;
+  int ll, anc;
+  bool covered = false;
+
+  if ((!nfa_ee_cb.aid_compact) || (aidInfo & NCI_ROUTE_QUAL_SHORT_SELECT))
+    return false;
+
+  for (ll = 0; ll < aid_len; ll++) {
+    p_idx = nfa_ee_aid_idx_find(ll, p_aid);
+    if (p_idx == nullptr) continue;
+    p_anc_cb = &nfa_ee_cb.ecb[p_idx->ecb_idx];
+    anc = p_idx->entry;
+    if (!(p_anc_cb->aid_rt_info[anc] & NFA_EE_AE_ROUTE)) continue;
+    if ((p_anc_cb != p_cb) || (p_anc_cb->aid_pwr_cfg[anc] != power_state)) {
+      /* the empty AID does not overlap */
+      if (ll) return false;
+    } else if ((p_anc_cb->aid_info[anc] & NCI_ROUTE_QUAL_LONG_SELECT) &&
+               !(p_anc_cb->aid_rt_info[anc] & NFA_EE_AE_OVERLAP)) {
+      covered = true;
+    }
+  }
+  return covered;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_uncover_aid
+**
+** Description      Take a removed covered AID entry out of the saved LMRT size
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_uncover_aid(uint8_t aid_len) {
+  /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
+  uint16_t size = 4 + aid_len;
+
+  nfa_ee_cb.aid_saved =
+      (nfa_ee_cb.aid_saved > size) ? nfa_ee_cb.aid_saved - size : 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_find_aid_offset
+**
+** Description      Given the AID, find the associated tNFA_EE_ECB and the
+**                  offset in aid_cfg[]. *p_entry is the index.
+**
+** Returns          void
+**
+*******************************************************************************/
+tNFA_EE_ECB* nfa_ee_find_aid_offset(uint8_t aid_len, uint8_t* p_aid,
+                                    int* p_offset, int* p_entry) {
+  tNFA_EE_AID_IDX* p_idx = nfa_ee_aid_idx_find(aid_len, p_aid);
+
+  /* only DH and the discovered NFCEEs are searched */
+  if ((p_idx == nullptr) || ((p_idx->ecb_idx != NFA_EE_CB_4_DH) &&
+                             (p_idx->ecb_idx >= nfa_ee_cb.cur_ee)))
+    return nullptr;
+
+  if (p_offset) *p_offset = p_idx->offset;
+  if (p_entry) *p_entry = p_idx->entry;
+  return &nfa_ee_cb.ecb[p_idx->ecb_idx];
 }
 
 /*******************************************************************************
@@ -902,29 +1383,21 @@ void nfa_ee_api_register(tNFA_EE_MSG* p_data) {
   int max_aid_cfg_length = nfa_ee_find_max_aid_cfg_len();
   int max_aid_entries = max_aid_cfg_length / NFA_MIN_AID_LEN + 1;
 
+  /* the AID arrays are allocated on demand, only set the limits */
+  if (NfcConfig::hasKey(NAME_NFA_EE_MAX_AID_ENTRIES)) {
+    max_aid_entries = NfcConfig::getUnsigned(NAME_NFA_EE_MAX_AID_ENTRIES);
+    max_aid_cfg_length = max_aid_entries * (2 + NFC_MAX_AID_LEN);
+  }
+  if (max_aid_entries > NFA_EE_MAX_AID_ENTRIES)
+    max_aid_entries = NFA_EE_MAX_AID_ENTRIES;
+  if (max_aid_cfg_length > NFA_EE_MAX_AID_ENTRIES * (2 + NFC_MAX_AID_LEN))
+    max_aid_cfg_length = NFA_EE_MAX_AID_ENTRIES * (2 + NFC_MAX_AID_LEN);
+  nfa_ee_cb.aid_max_entries = (uint16_t)max_aid_entries;
+  nfa_ee_cb.aid_max_cfg_len = (uint16_t)max_aid_cfg_length;
+
   LOG(VERBOSE) << StringPrintf("max_aid_cfg_length: %d and max_aid_entries: %d",
                              max_aid_cfg_length, max_aid_entries);
 
-  for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++) {
-    nfa_ee_cb.ecb[xx].aid_len = (uint8_t*)GKI_getbuf(max_aid_entries);
-    nfa_ee_cb.ecb[xx].aid_pwr_cfg = (uint8_t*)GKI_getbuf(max_aid_entries);
-    nfa_ee_cb.ecb[xx].aid_rt_info = (uint8_t*)GKI_getbuf(max_aid_entries);
-    nfa_ee_cb.ecb[xx].aid_info = (uint8_t*)GKI_getbuf(max_aid_entries);
-    nfa_ee_cb.ecb[xx].aid_cfg = (uint8_t*)GKI_getbuf(max_aid_cfg_length);
-    if ((NULL != nfa_ee_cb.ecb[xx].aid_len) &&
-        (NULL != nfa_ee_cb.ecb[xx].aid_pwr_cfg) &&
-        (NULL != nfa_ee_cb.ecb[xx].aid_info) &&
-        (NULL != nfa_ee_cb.ecb[xx].aid_cfg)) {
-      memset(nfa_ee_cb.ecb[xx].aid_len, 0, max_aid_entries);
-      memset(nfa_ee_cb.ecb[xx].aid_pwr_cfg, 0, max_aid_entries);
-      memset(nfa_ee_cb.ecb[xx].aid_rt_info, 0, max_aid_entries);
-      memset(nfa_ee_cb.ecb[xx].aid_info, 0, max_aid_entries);
-      memset(nfa_ee_cb.ecb[xx].aid_cfg, 0, max_aid_cfg_length);
-    } else {
-      LOG(ERROR) << StringPrintf("GKI_getbuf allocation for ECB failed !");
-    }
-  }
-
   /* This callback is verified (not NULL) in NFA_EeRegister() */
   (*p_cback)(NFA_EE_REGISTER_EVT, &evt_data);
 
@@ -949,19 +1422,136 @@ void nfa_ee_api_deregister(tNFA_EE_MSG* p_data) {
 
   LOG(VERBOSE) << StringPrintf("nfa_ee_api_deregister");
 
-  for (int xx = 0; xx < NFA_EE_NUM_ECBS; xx++) {
-    GKI_freebuf(nfa_ee_cb.ecb[xx].aid_len);
-    GKI_freebuf(nfa_ee_cb.ecb[xx].aid_pwr_cfg);
-    GKI_freebuf(nfa_ee_cb.ecb[xx].aid_rt_info);
-    GKI_freebuf(nfa_ee_cb.ecb[xx].aid_info);
-    GKI_freebuf(nfa_ee_cb.ecb[xx].aid_cfg);
-  }
-
   p_cback = nfa_ee_cb.p_ee_cback[index];
   nfa_ee_cb.p_ee_cback[index] = nullptr;
+
+  /* free the AID storage with the last callback */
+  int xx;
+  for (xx = 0; xx < NFA_EE_MAX_CBACKS; xx++) {
+    if (nfa_ee_cb.p_ee_cback[xx]) break;
+  }
+  if (xx == NFA_EE_MAX_CBACKS) {
+    for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++)
+      nfa_ee_free_aid(&nfa_ee_cb.ecb[xx]);
+    if (nfa_ee_cb.aid_idx) {
+      GKI_freebuf(nfa_ee_cb.aid_idx);
+      nfa_ee_cb.aid_idx = nullptr;
+    }
+    nfa_ee_cb.aid_idx_size = nfa_ee_cb.aid_idx_count = 0;
+  }
+
   if (p_cback) (*p_cback)(NFA_EE_DEREGISTER_EVT, &evt_data);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_mode_set
+**
+** Description      Activate or de-activate the NFCEE of the given ECB. NCI 2.0
+**                  allows one mode set in progress, so the mode set is queued
+**                  if another one waits for its NTF and is sent as soon as that
+**                  one completes. NCI 1.0 mode sets are sent right away and
+**                  are queued by the NCI command window.
+**
+** Returns          NFC_STATUS_OK, if sent or queued
+**
+*******************************************************************************/
+tNFC_STATUS nfa_ee_mode_set(tNFA_EE_ECB* p_cb, tNFC_NFCEE_MODE mode) {
+  tNFC_STATUS status;
+  uint32_t now_tick = GKI_get_os_tick_count();
+
+  if (p_cb->mode_set_st != NFA_EE_MODE_SET_ST_IDLE) {
+    LOG(ERROR) << StringPrintf("nfcee_id:0x%x mode set already pending",
+                               p_cb->nfcee_id);
+    return NFC_STATUS_BUSY;
+  }
+
+  status = NFC_NfceeModeSet(p_cb->nfcee_id, mode);
+  if (status == NFC_STATUS_OK) {
+    p_cb->mode_set_st = NFA_EE_MODE_SET_ST_SENT;
+  } else if ((status == NFC_STATUS_REFUSED) && (nfa_ee_cb.num_mode_set)) {
+    p_cb->mode_set_st = NFA_EE_MODE_SET_ST_QUEUED;
+    status = NFC_STATUS_OK;
+  } else {
+    return status;
+  }
+
+  if (nfa_ee_cb.num_mode_set++ == 0) nfa_ee_cb.mode_set_tick = now_tick;
+  p_cb->mode_set_mode = mode;
+  p_cb->mode_set_tick = now_tick;
+  LOG(VERBOSE) << StringPrintf("nfcee_id:0x%x mode:%d st:%d num_mode_set:%d",
+                               p_cb->nfcee_id, mode, p_cb->mode_set_st,
+                               nfa_ee_cb.num_mode_set);
+  return status;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_mode_set_done
+**
+** Description      Account the completion of the mode set sent for the given
+**                  ECB and log how long the NFCEE and all pending mode sets
+**                  took to get ready
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_mode_set_done(tNFA_EE_ECB* p_cb, tNFC_STATUS status) {
+  uint32_t now_tick = GKI_get_os_tick_count();
+
+  if (p_cb->mode_set_st != NFA_EE_MODE_SET_ST_SENT) return;
+
+  p_cb->mode_set_st = NFA_EE_MODE_SET_ST_IDLE;
+  nfa_ee_cb.num_mode_set--;
+  LOG(INFO) << StringPrintf("nfcee_id:0x%x mode:%d status:0x%x in %u ms",
+                            p_cb->nfcee_id, p_cb->mode_set_mode, status,
+                            GKI_TICKS_TO_MS(now_tick - p_cb->mode_set_tick));
+  if (nfa_ee_cb.num_mode_set == 0) {
+    LOG(INFO) << StringPrintf(
+        "all NFCEE mode sets done in %u ms",
+        GKI_TICKS_TO_MS(now_tick - nfa_ee_cb.mode_set_tick));
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_mode_set_next
+**
+** Description      Send the next queued mode set, if any
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_mode_set_next(void) {
+  tNFA_EE_ECB* p_cb = nfa_ee_cb.ecb;
+  tNFC_NFCEE_MODE_SET_REVT rsp;
+  tNFA_EE_MSG nfa_ee_msg;
+  tNFC_STATUS status;
+  int xx;
+
+  for (xx = 0; xx < nfa_ee_cb.cur_ee; xx++, p_cb++) {
+    if (p_cb->mode_set_st != NFA_EE_MODE_SET_ST_QUEUED) continue;
+
+    status = NFC_NfceeModeSet(p_cb->nfcee_id, p_cb->mode_set_mode);
+    if (status == NFC_STATUS_OK) {
+      p_cb->mode_set_st = NFA_EE_MODE_SET_ST_SENT;
+      return;
+    }
+    /* NFC layer still waits for the NTF of an earlier mode set, this one is
+    ** sent again when that NTF arrives */
+    if (status == NFC_STATUS_REFUSED) return;
+
+    /* process the same as the failure status from NFCC */
+    p_cb->mode_set_st = NFA_EE_MODE_SET_ST_SENT;
+    rsp.status = status;
+    rsp.nfcee_id = p_cb->nfcee_id;
+    rsp.mode = p_cb->mode_set_mode;
+    nfa_ee_msg.mode_set_rsp.p_data = &rsp;
+    nfa_ee_nci_mode_set_rsp(&nfa_ee_msg);
+    return;
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_api_mode_set
@@ -976,7 +1566,7 @@ void nfa_ee_api_mode_set(tNFA_EE_MSG* p_data) {
   tNFA_EE_MODE_SET mode_set;
   LOG(VERBOSE) << StringPrintf("handle:0x%02x mode:%d", p_cb->nfcee_id,
                              p_data->mode_set.mode);
-  mode_set.status = NFC_NfceeModeSet(p_cb->nfcee_id, p_data->mode_set.mode);
+  mode_set.status = nfa_ee_mode_set(p_cb, p_data->mode_set.mode);
   if (mode_set.status != NFC_STATUS_OK) {
     /* the api is rejected at NFC layer, report the failure status right away */
     mode_set.ee_handle = (tNFA_HANDLE)p_cb->nfcee_id | NFA_HANDLE_GROUP_EE;
@@ -1231,93 +1821,153 @@ void nfa_ee_api_clear_proto_cfg(tNFA_EE_MSG* p_data) {
 
 /*******************************************************************************
 **
-** Function         nfa_ee_api_add_aid
+** Function         nfa_ee_add_aid
 **
-** Description      process add an AID routing configuration from user
-**                  start a 1 second timer. When the timer expires,
-**                  the configuration collected in control block is sent to NFCC
+** Description      Add an AID routing entry to the given ECB. The caller
+**                  marks the AID routing changed and reports the status.
 **
-** Returns          void
+** Returns          NFA_STATUS_OK, if added
 **
 *******************************************************************************/
-void nfa_ee_api_add_aid(tNFA_EE_MSG* p_data) {
-  tNFA_EE_API_ADD_AID* p_add = &p_data->add_aid;
-  tNFA_EE_ECB* p_cb = p_data->cfg_hdr.p_cb;
+static tNFA_STATUS nfa_ee_add_aid(tNFA_EE_ECB* p_cb, uint8_t aid_len,
+                                  uint8_t* p_aid, tNFA_EE_PWR_STATE power_state,
+                                  uint8_t aidInfo) {
   tNFA_EE_ECB* p_chk_cb;
   uint8_t *p, *p_start;
   int len, len_needed;
-  tNFA_EE_CBACK_DATA evt_data = {0};
+  tNFA_STATUS status = NFA_STATUS_OK;
   int offset = 0, entry = 0;
   uint16_t new_size;
+  bool covered;
+  int max_aid_cfg_length = nfa_ee_cb.aid_max_cfg_len;
+  int max_aid_entries = nfa_ee_cb.aid_max_entries;
 
-  nfa_ee_trace_aid("nfa_ee_api_add_aid", p_cb->nfcee_id, p_add->aid_len,
-                   p_add->p_aid);
-  int max_aid_cfg_length = nfa_ee_find_max_aid_cfg_len();
-  int max_aid_entries = max_aid_cfg_length / NFA_MIN_AID_LEN + 1;
-
-  p_chk_cb =
-      nfa_ee_find_aid_offset(p_add->aid_len, p_add->p_aid, &offset, &entry);
+  p_chk_cb = nfa_ee_find_aid_offset(aid_len, p_aid, &offset, &entry);
   if (p_chk_cb) {
     LOG(VERBOSE) << StringPrintf(
-        "nfa_ee_api_add_aid The AID entry is already in the database");
+        "nfa_ee_add_aid The AID entry is already in the database");
     if (p_chk_cb == p_cb) {
+      tNFA_EE_PWR_STATE old_power_state = p_cb->aid_pwr_cfg[entry];
+
+      /* a new power state or qualifier may change the coverage of this and
+       * of longer AIDs, the size check compiles it again if needed */
+      if (p_cb->aid_rt_info[entry] & NFA_EE_AE_COVERED) {
+        p_cb->aid_rt_info[entry] &= ~NFA_EE_AE_COVERED;
+        nfa_ee_uncover_aid(aid_len);
+      }
+      if (nfa_ee_cb.aid_compact) nfa_ee_cb.aid_saved_stale = true;
       p_cb->aid_rt_info[entry] |= NFA_EE_AE_ROUTE;
-      p_cb->aid_info[entry] = p_add->aidInfo;
+      p_cb->aid_info[entry] = aidInfo;
+      p_cb->aid_pwr_cfg[entry] = power_state;
       new_size = nfa_ee_total_lmrt_size();
       if (new_size > NFC_GetLmrtSize()) {
         LOG(ERROR) << StringPrintf("Exceed LMRT size:%d (add ROUTE)", new_size);
-        evt_data.status = NFA_STATUS_BUFFER_FULL;
+        status = NFA_STATUS_BUFFER_FULL;
         p_cb->aid_rt_info[entry] &= ~NFA_EE_AE_ROUTE;
-      } else {
-        p_cb->aid_pwr_cfg[entry] = p_add->power_state;
+        p_cb->aid_pwr_cfg[entry] = old_power_state;
       }
     } else {
       LOG(ERROR) << StringPrintf(
           "The AID entry is already in the database for different NFCEE "
           "ID:0x%02x",
           p_chk_cb->nfcee_id);
-      evt_data.status = NFA_STATUS_SEMANTIC_ERROR;
+      status = NFA_STATUS_SEMANTIC_ERROR;
     }
   } else {
     /* Find the total length so far */
     len = nfa_ee_find_total_aid_len(p_cb, 0);
 
     /* make sure the control block has enough room to hold this entry */
-    len_needed = p_add->aid_len + 2; /* tag/len */
+    len_needed = aid_len + 2; /* tag/len */
+
+    if (((len_needed + len) > p_cb->aid_alloc_cfg_len) ||
+        (p_cb->aid_entries >= p_cb->aid_alloc_entries)) {
+      /* reclaim the room of removed entries before growing */
+      nfa_ee_compact_aid(p_cb);
+      len = nfa_ee_find_total_aid_len(p_cb, 0);
+    }
 
     if ((len_needed + len) > max_aid_cfg_length) {
       LOG(ERROR) << StringPrintf(
           "Exceed capacity: (len_needed:%d + len:%d) > "
           "NFA_EE_MAX_AID_CFG_LEN:%d",
           len_needed, len, max_aid_cfg_length);
-      evt_data.status = NFA_STATUS_BUFFER_FULL;
-    } else if (p_cb->aid_entries < max_aid_entries) {
-      /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
-      new_size = nfa_ee_total_lmrt_size() + 4 + p_add->aid_len;
-      if (new_size > NFC_GetLmrtSize()) {
-        LOG(ERROR) << StringPrintf("Exceed LMRT size:%d", new_size);
-        evt_data.status = NFA_STATUS_BUFFER_FULL;
-      } else {
-        /* add AID */
-        p_cb->aid_pwr_cfg[p_cb->aid_entries] = p_add->power_state;
-        p_cb->aid_info[p_cb->aid_entries] = p_add->aidInfo;
-        p_cb->aid_rt_info[p_cb->aid_entries] = NFA_EE_AE_ROUTE;
-        p = p_cb->aid_cfg + len;
-        p_start = p;
-        *p++ = NFA_EE_AID_CFG_TAG_NAME;
-        *p++ = p_add->aid_len;
-        memcpy(p, p_add->p_aid, p_add->aid_len);
-        p += p_add->aid_len;
-
-        p_cb->aid_len[p_cb->aid_entries++] = (uint8_t)(p - p_start);
-      }
-    } else {
+      status = NFA_STATUS_BUFFER_FULL;
+    } else if (p_cb->aid_entries >= max_aid_entries) {
       LOG(ERROR) << StringPrintf("Exceed NFA_EE_MAX_AID_ENTRIES:%d",
                                  max_aid_entries);
-      evt_data.status = NFA_STATUS_BUFFER_FULL;
+      status = NFA_STATUS_BUFFER_FULL;
+    } else if (!nfa_ee_grow_aid(p_cb, len_needed + len)) {
+      status = NFA_STATUS_NO_BUFFERS;
+    } else {
+      covered = nfa_ee_aid_covered(p_cb, aid_len, p_aid, power_state, aidInfo);
+      /* add AID */
+      p_cb->aid_pwr_cfg[p_cb->aid_entries] = power_state;
+      p_cb->aid_info[p_cb->aid_entries] = aidInfo;
+      p_cb->aid_rt_info[p_cb->aid_entries] = NFA_EE_AE_ROUTE;
+      if (covered) p_cb->aid_rt_info[p_cb->aid_entries] |= NFA_EE_AE_COVERED;
+      p = p_cb->aid_cfg + len;
+      p_start = p;
+      *p++ = NFA_EE_AID_CFG_TAG_NAME;
+      *p++ = aid_len;
+      memcpy(p, p_aid, aid_len);
+      p += aid_len;
+
+      if (nfa_ee_aid_idx_add(p_cb, p_cb->aid_entries, len)) {
+        p_cb->aid_len[p_cb->aid_entries++] = (uint8_t)(p - p_start);
+        /* keep size_aid up to date for the next AID of a bulk */
+        /* 4 = 1 (tag) + 1 (len) + 1(nfcee_id) + 1(power cfg) */
+        p_cb->size_aid += 4 + aid_len;
+        if (covered) {
+          nfa_ee_cb.aid_saved += 4 + aid_len;
+        } else if (nfa_ee_cb.aid_compact) {
+          /* an AID routed differently may overlap AIDs taken as covered,
+           * the size check compiles the AID route with it if needed */
+          nfa_ee_cb.aid_saved_stale = true;
+        }
+
+        new_size = nfa_ee_total_lmrt_size();
+        if (new_size > NFC_GetLmrtSize()) {
+          LOG(ERROR) << StringPrintf("Exceed LMRT size:%d", new_size);
+          status = NFA_STATUS_BUFFER_FULL;
+          /* take the AID out again, it is the last entry */
+          nfa_ee_aid_idx_remove(nfa_ee_aid_idx_find(aid_len, p_aid));
+          if (p_cb->aid_rt_info[--p_cb->aid_entries] & NFA_EE_AE_COVERED)
+            nfa_ee_uncover_aid(aid_len);
+          p_cb->size_aid -= 4 + aid_len;
+          /* the coverage last compiled with it is not valid any more */
+          if (nfa_ee_cb.aid_compact) nfa_ee_cb.aid_saved_stale = true;
+        }
+      } else {
+        status = NFA_STATUS_BUFFER_FULL;
+      }
     }
   }
 
+  return status;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_api_add_aid
+**
+** Description      process add an AID routing configuration from user
+**                  start a 1 second timer. When the timer expires,
+**                  the configuration collected in control block is sent to NFCC
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_api_add_aid(tNFA_EE_MSG* p_data) {
+  tNFA_EE_API_ADD_AID* p_add = &p_data->add_aid;
+  tNFA_EE_ECB* p_cb = p_data->cfg_hdr.p_cb;
+  tNFA_EE_CBACK_DATA evt_data = {0};
+
+  nfa_ee_trace_aid("nfa_ee_api_add_aid", p_cb->nfcee_id, p_add->aid_len,
+                   p_add->p_aid);
+  evt_data.status = nfa_ee_add_aid(p_cb, p_add->aid_len, p_add->p_aid,
+                                   p_add->power_state, p_add->aidInfo);
+
   if (evt_data.status == NFA_STATUS_OK) {
     /* mark AID changed */
     p_cb->ecb_flags |= NFA_EE_ECB_FLAGS_AID;
@@ -1336,26 +1986,18 @@ void nfa_ee_api_add_aid(tNFA_EE_MSG* p_data) {
 
 /*******************************************************************************
 **
-** Function         nfa_ee_api_remove_aid
+** Function         nfa_ee_remove_aid
 **
-** Description      process remove an AID routing configuration from user
-**                  start a 1 second timer. When the timer expires,
-**                  the configuration collected in control block is sent to NFCC
+** Description      Remove an AID routing entry. The caller reports the status.
 **
-** Returns          void
+** Returns          the ECB the AID was routed to, nullptr if not found
 **
 *******************************************************************************/
-void nfa_ee_api_remove_aid(tNFA_EE_MSG* p_data) {
+static tNFA_EE_ECB* nfa_ee_remove_aid(uint8_t aid_len, uint8_t* p_aid) {
   tNFA_EE_ECB* p_cb;
-  tNFA_EE_CBACK_DATA evt_data = {0};
-  int offset = 0, entry = 0, len;
-  int rest_len;
-  tNFA_EE_CBACK* p_cback = nullptr;
+  int offset = 0, entry = 0;
 
-  nfa_ee_trace_aid("nfa_ee_api_remove_aid", 0, p_data->rm_aid.aid_len,
-                   p_data->rm_aid.p_aid);
-  p_cb = nfa_ee_find_aid_offset(p_data->rm_aid.aid_len, p_data->rm_aid.p_aid,
-                                &offset, &entry);
+  p_cb = nfa_ee_find_aid_offset(aid_len, p_aid, &offset, &entry);
   if (p_cb && p_cb->aid_entries) {
     LOG(VERBOSE) << StringPrintf("aid_rt_info[%d]: 0x%02x", entry,
                                p_cb->aid_rt_info[entry]);
@@ -1366,39 +2008,170 @@ void nfa_ee_api_remove_aid(tNFA_EE_MSG* p_data) {
     if (p_cb->aid_rt_info[entry] & NFA_EE_AE_VS)
       p_cb->ecb_flags |= NFA_EE_ECB_FLAGS_VS;
 
-    /* remove the aid */
+    /* remove the aid from the index, aid_cfg[] is compacted when the LMRT is
+     * built */
+    nfa_ee_aid_idx_remove(nfa_ee_aid_idx_find(aid_len, p_aid));
+    if (p_cb->aid_rt_info[entry] & NFA_EE_AE_COVERED)
+      nfa_ee_uncover_aid(aid_len);
+    /* the AIDs this one covered may not be covered by another one */
+    if ((p_cb->aid_info[entry] & NCI_ROUTE_QUAL_LONG_SELECT) &&
+        nfa_ee_cb.aid_compact)
+      nfa_ee_cb.aid_saved_stale = true;
     if ((entry + 1) < p_cb->aid_entries) {
-      /* not the last entry, move the aid entries in control block */
-      /* Find the total len from the next entry to the last one */
-      rest_len = nfa_ee_find_total_aid_len(p_cb, entry + 1);
-
-      len = p_cb->aid_len[entry];
-      LOG(VERBOSE) << StringPrintf("nfa_ee_api_remove_aid len:%d, rest_len:%d",
-                                 len, rest_len);
-      GKI_shiftup(&p_cb->aid_cfg[offset], &p_cb->aid_cfg[offset + len],
-                  rest_len);
-      rest_len = p_cb->aid_entries - entry;
-      GKI_shiftup(&p_cb->aid_len[entry], &p_cb->aid_len[entry + 1], rest_len);
-      GKI_shiftup(&p_cb->aid_pwr_cfg[entry], &p_cb->aid_pwr_cfg[entry + 1],
-                  rest_len);
-      GKI_shiftup(&p_cb->aid_rt_info[entry], &p_cb->aid_rt_info[entry + 1],
-                  rest_len);
+      p_cb->aid_rt_info[entry] = NFA_EE_AE_REMOVED;
+      p_cb->aid_rm_entries++;
+    } else {
+      /* the last entry, just reduce the aid_entries by 1 */
+      p_cb->aid_entries--;
     }
-    /* else the last entry, just reduce the aid_entries by 1 */
-    p_cb->aid_entries--;
     nfa_ee_cb.ee_cfged |= nfa_ee_ecb_to_mask(p_cb);
+    return p_cb;
+  }
+
+  LOG(WARNING) << StringPrintf(
+      "nfa_ee_remove_aid The AID entry is not in the database");
+  return nullptr;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_api_remove_aid
+**
+** Description      process remove an AID routing configuration from user
+**                  start a 1 second timer. When the timer expires,
+**                  the configuration collected in control block is sent to NFCC
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_api_remove_aid(tNFA_EE_MSG* p_data) {
+  tNFA_EE_ECB* p_cb;
+  tNFA_EE_CBACK_DATA evt_data = {0};
+  tNFA_EE_CBACK* p_cback = nullptr;
+
+  nfa_ee_trace_aid("nfa_ee_api_remove_aid", 0, p_data->rm_aid.aid_len,
+                   p_data->rm_aid.p_aid);
+  p_cb = nfa_ee_remove_aid(p_data->rm_aid.aid_len, p_data->rm_aid.p_aid);
+  if (p_cb) {
     nfa_ee_update_route_aid_size(p_cb);
     nfa_ee_start_timer();
     /* report NFA_EE_REMOVE_AID_EVT to the callback associated the NFCEE */
     p_cback = p_cb->p_ee_cback;
   } else {
-    LOG(WARNING) << StringPrintf(
-        "nfa_ee_api_remove_aid The AID entry is not in the database");
     evt_data.status = NFA_STATUS_INVALID_PARAM;
   }
   nfa_ee_report_event(p_cback, NFA_EE_REMOVE_AID_EVT, &evt_data);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_aid_bulk_done
+**
+** Description      Update the AID routing size of the ECBs in ee_mask, start
+**                  the timer once and report the status of a bulk operation
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_aid_bulk_done(uint8_t ee_mask, tNFA_EE_EVT event,
+                                 tNFA_EE_CBACK_DATA* p_evt_data) {
+  int xx;
+
+  for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++) {
+    if (ee_mask & nfa_ee_ecb_to_mask(&nfa_ee_cb.ecb[xx]))
+      nfa_ee_update_route_aid_size(&nfa_ee_cb.ecb[xx]);
+  }
+  if (ee_mask) nfa_ee_start_timer();
+
+  LOG(VERBOSE) << StringPrintf("status:%d num_done:%d ee_cfged:0x%02x",
+                             p_evt_data->aid_bulk.status,
+                             p_evt_data->aid_bulk.num_done, nfa_ee_cb.ee_cfged);
+  nfa_ee_report_event(nullptr, event, p_evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_api_add_aid_bulk
+**
+** Description      process adding a set of AID routing configurations from
+**                  user in one pass. The routing is committed once, when the
+**                  timer expires.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_api_add_aid_bulk(tNFA_EE_MSG* p_data) {
+  tNFA_EE_API_AID_BULK* p_bulk = &p_data->aid_bulk;
+  tNFA_EE_AID_ROUTE* p_route;
+  tNFA_EE_ECB* p_cb;
+  tNFA_EE_CBACK_DATA evt_data = {0};
+  tNFA_STATUS status;
+  uint8_t ee_mask = 0;
+
+  for (uint16_t xx = 0; xx < p_bulk->num_aid; xx++) {
+    p_route = &p_bulk->p_aid_route[xx];
+    p_cb = nfa_ee_find_ecb((uint8_t)(p_route->ee_handle & 0xFF));
+    if (p_cb == nullptr) {
+      status = NFA_STATUS_INVALID_PARAM;
+    } else {
+      nfa_ee_trace_aid("nfa_ee_api_add_aid_bulk", p_cb->nfcee_id,
+                       p_route->aid_len, p_route->p_aid);
+      status = nfa_ee_add_aid(p_cb, p_route->aid_len, p_route->p_aid,
+                              p_route->power_state, p_route->aidInfo);
+    }
+
+    if (status == NFA_STATUS_OK) {
+      /* mark AID changed */
+      p_cb->ecb_flags |= NFA_EE_ECB_FLAGS_AID;
+      ee_mask |= nfa_ee_ecb_to_mask(p_cb);
+      evt_data.aid_bulk.num_done++;
+    } else {
+      if (evt_data.aid_bulk.status == NFA_STATUS_OK)
+        evt_data.aid_bulk.status = status;
+      if (status == NFA_STATUS_BUFFER_FULL)
+        nfc::stats::stats_write(nfc::stats::NFC_ERROR_OCCURRED,
+                                (int32_t)AID_OVERFLOW, 0, 0);
+    }
+  }
+
+  nfa_ee_cb.ee_cfged |= ee_mask;
+  nfa_ee_aid_bulk_done(ee_mask, NFA_EE_ADD_AID_BULK_EVT, &evt_data);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_api_remove_aid_bulk
+**
+** Description      process removing a set of AID routing configurations from
+**                  user in one pass. The routing is committed once, when the
+**                  timer expires.
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_api_remove_aid_bulk(tNFA_EE_MSG* p_data) {
+  tNFA_EE_API_AID_BULK* p_bulk = &p_data->aid_bulk;
+  tNFA_EE_AID_ROUTE* p_route;
+  tNFA_EE_ECB* p_cb;
+  tNFA_EE_CBACK_DATA evt_data = {0};
+  uint8_t ee_mask = 0;
+
+  for (uint16_t xx = 0; xx < p_bulk->num_aid; xx++) {
+    p_route = &p_bulk->p_aid_route[xx];
+    nfa_ee_trace_aid("nfa_ee_api_remove_aid_bulk", 0, p_route->aid_len,
+                     p_route->p_aid);
+    p_cb = nfa_ee_remove_aid(p_route->aid_len, p_route->p_aid);
+    if (p_cb) {
+      ee_mask |= nfa_ee_ecb_to_mask(p_cb);
+      evt_data.aid_bulk.num_done++;
+    } else if (evt_data.aid_bulk.status == NFA_STATUS_OK) {
+      evt_data.aid_bulk.status = NFA_STATUS_INVALID_PARAM;
+    }
+  }
+
+  nfa_ee_aid_bulk_done(ee_mask, NFA_EE_REMOVE_AID_BULK_EVT, &evt_data);
+}
+
 /*******************************************************************************
  **
  ** Function         nfa_ee_api_add_sys_code
@@ -1660,6 +2433,93 @@ void nfa_ee_api_connect(tNFA_EE_MSG* p_data) {
   }
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_apdu_reset
+**
+** Description      Discard the C-APDUs not sent yet and restart the sequence
+**                  numbers of the APDU connection of the given NFCEE
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_apdu_reset(tNFA_EE_ECB* p_cb) {
+  void* p_buf;
+
+  while ((p_buf = GKI_dequeue(&p_cb->apdu_q)) != nullptr) GKI_freebuf(p_buf);
+  p_cb->apdu_in_flight = 0;
+  p_cb->apdu_tx_seq = p_cb->apdu_rx_seq = 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_apdu_tx
+**
+** Description      Send the queued C-APDUs of the given NFCEE, up to
+**                  nfa_ee_cb.apdu_max_in_flight without R-APDU. If a C-APDU
+**                  cannot be sent, it and the rest of the queue are dropped.
+**                  The C-APDUs in flight are then answered first, before the
+**                  next C-APDU is sent.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_apdu_tx(tNFA_EE_ECB* p_cb) {
+  NFC_HDR* p_pkt;
+  tNFA_EE_CBACK_DATA evt_data;
+
+  while (p_cb->apdu_in_flight < nfa_ee_cb.apdu_max_in_flight) {
+    if (p_cb->apdu_in_flight == 0) {
+      /* skip the seq of the C-APDUs dropped */
+      p_cb->apdu_rx_seq = p_cb->apdu_tx_seq;
+    } else if ((uint16_t)(p_cb->apdu_rx_seq + p_cb->apdu_in_flight) !=
+               p_cb->apdu_tx_seq) {
+      /* C-APDUs dropped after those in flight */
+      break;
+    }
+    p_pkt = (NFC_HDR*)GKI_dequeue(&p_cb->apdu_q);
+    if (p_pkt == nullptr) break;
+
+    if (NFC_SendData(p_cb->conn_id, p_pkt) == NFC_STATUS_OK) {
+      p_cb->apdu_in_flight++;
+      p_cb->apdu_tx_seq++;
+      continue;
+    }
+
+    LOG(ERROR) << StringPrintf("nfcee_id:0x%x failed to send C-APDU %d",
+                               p_cb->nfcee_id, p_cb->apdu_tx_seq);
+    evt_data.apdu_err.status = NFA_STATUS_FAILED;
+    evt_data.apdu_err.seq = p_cb->apdu_tx_seq++;
+    evt_data.apdu_err.num_apdu = 1;
+    while ((p_pkt = (NFC_HDR*)GKI_dequeue(&p_cb->apdu_q)) != nullptr) {
+      GKI_freebuf(p_pkt);
+      p_cb->apdu_tx_seq++;
+      evt_data.apdu_err.num_apdu++;
+    }
+    nfa_ee_report_event(p_cb->p_ee_cback, NFA_EE_NO_CB_ERR_EVT, &evt_data);
+    break;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_send_pkt
+**
+** Description      Send the NCI data packet to the given NFCEE. On the APDU
+**                  interface the packet goes through the C-APDU queue.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_send_pkt(tNFA_EE_ECB* p_cb, NFC_HDR* p_pkt) {
+  if (p_cb->use_interface == NFC_NFCEE_INTERFACE_APDU) {
+    GKI_enqueue(&p_cb->apdu_q, p_pkt);
+    nfa_ee_apdu_tx(p_cb);
+  } else {
+    NFC_SendData(p_cb->conn_id, p_pkt);
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_api_send_data
@@ -1684,7 +2544,7 @@ void nfa_ee_api_send_data(tNFA_EE_MSG* p_data) {
       p_pkt->len = p_data->send_data.data_len;
       p = (uint8_t*)(p_pkt + 1) + p_pkt->offset;
       memcpy(p, p_data->send_data.p_data, p_pkt->len);
-      NFC_SendData(p_cb->conn_id, p_pkt);
+      nfa_ee_send_pkt(p_cb, p_pkt);
     } else {
       tNFA_EE_CBACK_DATA nfa_ee_cback_data;
       nfa_ee_cback_data.status = status;
@@ -1699,6 +2559,37 @@ void nfa_ee_api_send_data(tNFA_EE_MSG* p_data) {
   }
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_api_send_apdus
+**
+** Description      Queue the C-APDUs to the given NFCEE and send them as far
+**                  as they fit in flight
+**
+** Returns          void
+**
+*******************************************************************************/
+void nfa_ee_api_send_apdus(tNFA_EE_MSG* p_data) {
+  tNFA_EE_ECB* p_cb = p_data->send_apdus.p_cb;
+  NFC_HDR* p_pkt;
+
+  if ((p_cb->conn_st == NFA_EE_CONN_ST_CONN) &&
+      (p_cb->use_interface == NFC_NFCEE_INTERFACE_APDU)) {
+    while ((p_pkt = (NFC_HDR*)GKI_dequeue(&p_data->send_apdus.apdu_q)) !=
+           nullptr)
+      GKI_enqueue(&p_cb->apdu_q, p_pkt);
+    nfa_ee_apdu_tx(p_cb);
+  } else {
+    while ((p_pkt = (NFC_HDR*)GKI_dequeue(&p_data->send_apdus.apdu_q)) !=
+           nullptr)
+      GKI_freebuf(p_pkt);
+    tNFA_EE_CBACK_DATA nfa_ee_cback_data;
+    nfa_ee_cback_data.status = NFA_STATUS_FAILED;
+    nfa_ee_report_event(p_cb->p_ee_cback, NFA_EE_NO_CB_ERR_EVT,
+                        &nfa_ee_cback_data);
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_api_disconnect
@@ -1714,6 +2605,8 @@ void nfa_ee_api_disconnect(tNFA_EE_MSG* p_data) {
 
   if (p_cb->conn_st == NFA_EE_CONN_ST_CONN) {
     p_cb->conn_st = NFA_EE_CONN_ST_DISC;
+    /* no C-APDU is sent after this */
+    nfa_ee_apdu_reset(p_cb);
     NFC_ConnClose(p_cb->conn_id);
   }
   evt_data.handle = (tNFA_HANDLE)p_cb->nfcee_id | NFA_HANDLE_GROUP_EE;
@@ -1843,7 +2736,11 @@ static void nfa_ee_remove_pending(void) {
       }
 
       if (p_cb_n <= p_cb_end) {
+        nfa_ee_free_aid(p_cb);
         memcpy(p_cb, p_cb_n, sizeof(tNFA_EE_ECB));
+        /* the AID arrays moved to p_cb */
+        p_cb_n->aid_len = nullptr;
+        nfa_ee_free_aid(p_cb_n);
         p_cb_n->nfcee_id = NFA_EE_INVALID;
       }
       p_cb++;
@@ -1851,6 +2748,8 @@ static void nfa_ee_remove_pending(void) {
     }
   }
   nfa_ee_cb.cur_ee -= (uint8_t)num_removed;
+  /* the AID index refers to ECBs by position */
+  if (num_removed) nfa_ee_aid_idx_rebuild();
 }
 
 /*******************************************************************************
@@ -2234,6 +3133,7 @@ void nfa_ee_nci_mode_set_rsp(tNFA_EE_MSG* p_data) {
                                p_rsp->nfcee_id);
     return;
   }
+  nfa_ee_mode_set_done(p_cb, p_rsp->status);
 
   /* Do not update routing table in EE_RECOVERY state */
   if (nfa_hci_cb.hci_state != NFA_HCI_STATE_EE_RECOVERY) {
@@ -2260,7 +3160,7 @@ void nfa_ee_nci_mode_set_rsp(tNFA_EE_MSG* p_data) {
       p_cb->tech_switch_on = p_cb->tech_switch_off = p_cb->tech_battery_off = 0;
       p_cb->proto_switch_on = p_cb->proto_switch_off = p_cb->proto_battery_off =
           0;
-      p_cb->aid_entries = 0;
+      nfa_ee_remove_all_aid(p_cb);
       p_cb->ee_status = NFC_NFCEE_STATUS_INACTIVE;
     }
   } else if (p_rsp->mode == NFA_EE_MD_ACTIVATE) {
@@ -2296,6 +3196,8 @@ void nfa_ee_nci_mode_set_rsp(tNFA_EE_MSG* p_data) {
       nfa_ee_report_discover_req_evt();
     }
   }
+  /* the NFCC is ready for the next NFCEE */
+  nfa_ee_mode_set_next();
   if (nfa_ee_cb.p_enable_cback)
     (*nfa_ee_cb.p_enable_cback)(NFA_EE_MODE_SET_COMPLETE);
 }
@@ -2346,6 +3248,11 @@ void nfa_ee_nci_wait_rsp(tNFA_EE_MSG* p_data) {
   if (nfa_ee_cb.wait_rsp) {
     if (p_rsp->opcode == NCI_MSG_RF_SET_ROUTING) nfa_ee_cb.wait_rsp--;
   }
+  if ((p_rsp->opcode == NCI_MSG_RF_SET_ROUTING) && (p_rsp->p_data) &&
+      (((tNFC_RESPONSE*)p_rsp->p_data)->status != NFC_STATUS_OK)) {
+    /* content of the LMRT in NFCC is unknown */
+    nfa_ee_cb.lmrt_sent_valid = false;
+  }
   nfa_ee_report_update_evt();
 }
 
@@ -2399,6 +3306,7 @@ void nfa_ee_nci_conn(tNFA_EE_MSG* p_data) {
         if (p_conn->conn_create.status == NFC_STATUS_OK) {
           p_cb->conn_id = p_cbk->conn_id;
           p_cb->conn_st = NFA_EE_CONN_ST_CONN;
+          nfa_ee_apdu_reset(p_cb);
         } else {
           p_cb->conn_st = NFA_EE_CONN_ST_NONE;
         }
@@ -2417,6 +3325,7 @@ void nfa_ee_nci_conn(tNFA_EE_MSG* p_data) {
         p_cb->conn_st = NFA_EE_CONN_ST_NONE;
         p_cb->p_ee_cback = nullptr;
         p_cb->conn_id = 0;
+        nfa_ee_apdu_reset(p_cb);
         if (nfa_ee_cb.em_state == NFA_EE_EM_STATE_DISABLING) {
           if (nfa_ee_cb.ee_flags & NFA_EE_FLAG_WAIT_DISCONN) {
             if (nfa_ee_cb.num_ee_expecting) {
@@ -2433,6 +3342,16 @@ void nfa_ee_nci_conn(tNFA_EE_MSG* p_data) {
       case NFC_DATA_CEVT:
         if (p_cb->conn_st == NFA_EE_CONN_ST_CONN) {
           /* report data event only in connected state */
+          if ((p_cb->use_interface == NFC_NFCEE_INTERFACE_APDU) && p_pkt) {
+            /* the R-APDU answers the oldest C-APDU in flight, send the next
+             * one before reporting this one */
+            evt_data.data.seq = p_cb->apdu_rx_seq;
+            if (p_conn->data.status != NFC_STATUS_CONTINUE) {
+              p_cb->apdu_rx_seq++;
+              if (p_cb->apdu_in_flight) p_cb->apdu_in_flight--;
+              nfa_ee_apdu_tx(p_cb);
+            }
+          }
           if (p_cb->p_ee_cback && p_pkt) {
             evt_data.data.len = p_pkt->len;
             evt_data.data.p_buf = (uint8_t*)(p_pkt + 1) + p_pkt->offset;
@@ -2619,6 +3538,64 @@ void nfa_ee_get_tech_route(uint8_t power_state, uint8_t* p_handles) {
                              p_handles[1], p_handles[2], p_handles[3]);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_queue_routing
+**
+** Description      Queue a routing command of the LMRT being built. Nothing is
+**                  sent to NFCC before nfa_ee_commit_routing().
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_queue_routing(bool more, uint8_t num_tlv, uint8_t tlv_size,
+                                 uint8_t* p_tlvs) {
+  nfa_ee_lmrt_pend.push_back(more);
+  nfa_ee_lmrt_pend.push_back(num_tlv);
+  nfa_ee_lmrt_pend.push_back(tlv_size);
+  nfa_ee_lmrt_pend.insert(nfa_ee_lmrt_pend.end(), p_tlvs, p_tlvs + tlv_size);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_ee_commit_routing
+**
+** Description      Send the queued routing commands to NFCC, unless NFCC
+**                  already accepted the very same LMRT. NCI has no command
+**                  to patch a part of the LMRT, so an unchanged table is the
+**                  only update that can be saved.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_ee_commit_routing(void) {
+  uint8_t* p = nfa_ee_lmrt_pend.data();
+  uint8_t* p_end = p + nfa_ee_lmrt_pend.size();
+  bool all_sent = true;
+
+  if (nfa_ee_cb.lmrt_sent_valid && (nfa_ee_lmrt_pend == nfa_ee_lmrt_sent)) {
+    LOG(VERBOSE) << StringPrintf("%s LMRT unchanged, skip %zu bytes", __func__,
+                                 nfa_ee_lmrt_pend.size());
+    nfa_ee_lmrt_pend.clear();
+    return;
+  }
+
+  while (p < p_end) {
+    if (NFC_SetRouting(p[0], p[1], p[2], p + 3) == NFA_STATUS_OK) {
+      nfa_ee_cb.wait_rsp++;
+    } else {
+      all_sent = false;
+    }
+    p += 3 + p[2];
+  }
+
+  /* valid until NFCC rejects one of the commands, unknown if one of them
+   * could not even be sent */
+  nfa_ee_lmrt_sent.swap(nfa_ee_lmrt_pend);
+  nfa_ee_lmrt_pend.clear();
+  nfa_ee_cb.lmrt_sent_valid = all_sent;
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_ee_check_set_routing
@@ -2637,9 +3614,7 @@ void nfa_ee_check_set_routing(uint16_t new_size, int* p_max_len, uint8_t* p,
                                   : *p_max_len);
 
   if (new_size + *p_cur_offset > max_tlv) {
-    if (NFC_SetRouting(true, *p, *p_cur_offset, p + 1) == NFA_STATUS_OK) {
-      nfa_ee_cb.wait_rsp++;
-    }
+    nfa_ee_queue_routing(true, *p, (uint8_t)*p_cur_offset, p + 1);
     /* after the routing command is sent, re-use the same buffer to send the
      * next routing command.
      * reset the related parameters */
@@ -2726,18 +3701,15 @@ void nfa_ee_route_add_one_ecb_by_route_order(
       }
       LOG(VERBOSE) << StringPrintf("%s : set routing num_tlv:%d tlv_size:%d",
                                  __func__, num_tlv, tlv_size);
-      if (NFC_SetRouting(more, num_tlv, (uint8_t)(*p_cur_offset), ps + 1) ==
-          NFA_STATUS_OK) {
-        nfa_ee_cb.wait_rsp++;
-      }
+      nfa_ee_queue_routing(more, num_tlv, (uint8_t)(*p_cur_offset), ps + 1);
+      nfa_ee_commit_routing();
     } else if (nfa_ee_cb.ee_cfg_sts & NFA_EE_STS_PREV_ROUTING) {
       if (tlv_size == 0) {
         nfa_ee_cb.ee_cfg_sts &= ~NFA_EE_STS_PREV_ROUTING;
         /* indicated routing is configured to NFCC */
         nfa_ee_cb.ee_cfg_sts |= NFA_EE_STS_CHANGED_ROUTING;
-        if (NFC_SetRouting(more, 0, 0, ps + 1) == NFA_STATUS_OK) {
-          nfa_ee_cb.wait_rsp++;
-        }
+        nfa_ee_queue_routing(more, 0, 0, ps + 1);
+        nfa_ee_commit_routing();
       }
     }
   }
@@ -2884,6 +3856,14 @@ void nfa_ee_lmrt_to_nfcc(__attribute__((unused)) tNFA_EE_MSG* p_data) {
     return;
   }
 
+  /* commands queued without the final one are not sent */
+  nfa_ee_lmrt_pend.clear();
+
+  /* pack aid_cfg[] of DH and NFCEEs before walking it */
+  for (xx = 0; xx < NFA_EE_NUM_ECBS; xx++)
+    nfa_ee_compact_aid(&nfa_ee_cb.ecb[xx]);
+  if (nfa_ee_cb.aid_compact) nfa_ee_compile_aid_route();
+
   /* find the last active NFCEE. */
   if (nfa_ee_cb.cur_ee > 0) p_cb = &nfa_ee_cb.ecb[nfa_ee_cb.cur_ee - 1];
 
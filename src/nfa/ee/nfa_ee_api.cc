@@ -641,6 +641,154 @@ tNFA_STATUS NFA_EeRemoveAidRouting(uint8_t aid_len, uint8_t* p_aid) {
   return status;
 }
 
+/*******************************************************************************
+**
+** Function         nfa_ee_send_aid_bulk
+**
+** Description      Copy the AID routing entries into one message and send it
+**                  to NFA EE
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_ee_send_aid_bulk(uint16_t event, uint16_t num_aid,
+                                        tNFA_EE_AID_ROUTE* p_aid_route) {
+  tNFA_EE_API_AID_BULK* p_msg;
+  uint32_t size = sizeof(tNFA_EE_API_AID_BULK) +
+                  (uint32_t)num_aid * sizeof(tNFA_EE_AID_ROUTE);
+  uint8_t* p;
+  uint16_t xx;
+
+  for (xx = 0; xx < num_aid; xx++) size += p_aid_route[xx].aid_len;
+  if (size > UINT16_MAX) {
+    LOG(ERROR) << StringPrintf("Too many AIDs:%d", num_aid);
+    return NFA_STATUS_INVALID_PARAM;
+  }
+
+  p_msg = (tNFA_EE_API_AID_BULK*)GKI_getbuf((uint16_t)size);
+  if (p_msg == nullptr) return NFA_STATUS_FAILED;
+
+  p_msg->hdr.event = event;
+  p_msg->num_aid = num_aid;
+  p_msg->p_aid_route = (tNFA_EE_AID_ROUTE*)(p_msg + 1);
+  p = (uint8_t*)(p_msg->p_aid_route + num_aid);
+  for (xx = 0; xx < num_aid; xx++) {
+    p_msg->p_aid_route[xx] = p_aid_route[xx];
+    p_msg->p_aid_route[xx].p_aid = p;
+    if (p_aid_route[xx].aid_len)
+      memcpy(p, p_aid_route[xx].p_aid, p_aid_route[xx].aid_len);
+    p += p_aid_route[xx].aid_len;
+  }
+
+  nfa_sys_sendmsg(p_msg);
+
+  return NFA_STATUS_OK;
+}
+
+/*******************************************************************************
+**
+** Function         NFA_EeAddAidRoutingBulk
+**
+** Description      This function is called to add num_aid AID entries in the
+**                  listen mode routing table in NFCC at once. All entries are
+**                  validated before any is added. The status of this operation
+**                  is reported as the NFA_EE_ADD_AID_BULK_EVT.
+**
+** Note:            If RF discovery is started,
+**                  NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT should
+**                  happen before calling this function
+**
+** Note:            NFA_EeUpdateNow() should be called after last NFA-EE
+**                  function to change the listen mode routing is called.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+tNFA_STATUS NFA_EeAddAidRoutingBulk(uint16_t num_aid,
+                                    tNFA_EE_AID_ROUTE* p_aid_route) {
+  uint8_t aid_len;
+  uint8_t* p_aid;
+
+  LOG(VERBOSE) << StringPrintf("num_aid:%d", num_aid);
+  if ((num_aid == 0) || (p_aid_route == nullptr)) {
+    LOG(ERROR) << StringPrintf("No AID");
+    return NFA_STATUS_INVALID_PARAM;
+  }
+
+  /* validate parameters - same rules as NFA_EeAddAidRouting() */
+  for (uint16_t xx = 0; xx < num_aid; xx++) {
+    aid_len = p_aid_route[xx].aid_len;
+    p_aid = p_aid_route[xx].p_aid;
+    if ((nfa_ee_find_ecb((uint8_t)(p_aid_route[xx].ee_handle & 0xFF)) ==
+         nullptr) ||
+        ((NFA_GetNCIVersion() >= NCI_VERSION_2_0) && (aid_len != 0) &&
+         (p_aid == nullptr)) ||
+        ((NFA_GetNCIVersion() < NCI_VERSION_2_0) &&
+         ((aid_len == 0) || (p_aid == nullptr) ||
+          (aid_len < NFA_MIN_AID_LEN))) ||
+        (aid_len > NFA_MAX_AID_LEN)) {
+      LOG(ERROR) << StringPrintf("Bad ee_handle or AID[%d] (len=%d)", xx,
+                                 aid_len);
+      return NFA_STATUS_INVALID_PARAM;
+    }
+  }
+
+  return nfa_ee_send_aid_bulk(NFA_EE_API_ADD_AID_BULK_EVT, num_aid,
+                              p_aid_route);
+}
+
+/*******************************************************************************
+**
+** Function         NFA_EeRemoveAidRoutingBulk
+**
+** Description      This function is called to remove num_aid AID entries from
+**                  the listen mode routing table at once. The status of this
+**                  operation is reported as the NFA_EE_REMOVE_AID_BULK_EVT.
+**
+** Note:            If RF discovery is started,
+**                  NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT should
+**                  happen before calling this function
+**
+** Note:            NFA_EeUpdateNow() should be called after last NFA-EE
+**                  function to change the listen mode routing is called.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+tNFA_STATUS NFA_EeRemoveAidRoutingBulk(uint16_t num_aid,
+                                       tNFA_EE_AID_ROUTE* p_aid_route) {
+  uint8_t aid_len;
+  uint8_t* p_aid;
+
+  LOG(VERBOSE) << StringPrintf("num_aid:%d", num_aid);
+  if ((num_aid == 0) || (p_aid_route == nullptr)) {
+    LOG(ERROR) << StringPrintf("No AID");
+    return NFA_STATUS_INVALID_PARAM;
+  }
+
+  /* validate parameters - same rules as NFA_EeRemoveAidRouting() */
+  for (uint16_t xx = 0; xx < num_aid; xx++) {
+    aid_len = p_aid_route[xx].aid_len;
+    p_aid = p_aid_route[xx].p_aid;
+    if (((NFA_GetNCIVersion() >= NCI_VERSION_2_0) && (aid_len != 0) &&
+         (p_aid == nullptr)) ||
+        ((NFA_GetNCIVersion() < NCI_VERSION_2_0) &&
+         ((aid_len == 0) || (p_aid == nullptr) ||
+          (aid_len < NFA_MIN_AID_LEN))) ||
+        (aid_len > NFA_MAX_AID_LEN)) {
+      LOG(ERROR) << StringPrintf("Bad AID[%d]", xx);
+      return NFA_STATUS_INVALID_PARAM;
+    }
+  }
+
+  return nfa_ee_send_aid_bulk(NFA_EE_API_REMOVE_AID_BULK_EVT, num_aid,
+                              p_aid_route);
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_EeAddSystemCodeRouting
@@ -910,6 +1058,88 @@ tNFA_STATUS NFA_EeSendData(tNFA_HANDLE ee_handle, uint16_t data_len,
   return status;
 }
 
+/*******************************************************************************
+**
+** Function         NFA_EeSendApdus
+**
+** Description      Send num_apdu C-APDUs to the given NFCEE over its APDU
+**                  interface connection. The C-APDUs are kept in flight as
+**                  far as the connection allows, the R-APDUs are reported in
+**                  order as NFA_EE_DATA_EVT. The seq of an NFA_EE_DATA_EVT
+**                  counts the C-APDUs sent since NFA_EE_CONNECT_EVT, starting
+**                  at 0, including those sent by NFA_EeSendData().
+**                  Up to NFA_EE_MAX_APDU_IN_FLIGHT (config) C-APDUs are in
+**                  flight, 1 by default. If a C-APDU cannot be sent, it and
+**                  the C-APDUs queued after it are dropped and reported in
+**                  apdu_err of NFA_EE_NO_CB_ERR_EVT.
+**                  This function shall be called after NFA_EE_CONNECT_EVT is
+**                  reported and before NFA_EeDisconnect is called on the given
+**                  ee_handle.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+tNFA_STATUS NFA_EeSendApdus(tNFA_HANDLE ee_handle, uint16_t num_apdu,
+                            tNFA_EE_APDU* p_apdu) {
+  tNFA_EE_API_SEND_APDUS* p_msg;
+  uint8_t nfcee_id = (uint8_t)(ee_handle & 0xFF);
+  tNFA_EE_ECB* p_cb;
+  NFC_HDR* p_pkt;
+  uint16_t xx;
+
+  LOG(VERBOSE) << StringPrintf("handle:<0x%x> num_apdu:%d", ee_handle,
+                             num_apdu);
+
+  p_cb = nfa_ee_find_ecb(nfcee_id);
+
+  if ((p_cb == nullptr) || (p_cb->conn_st != NFA_EE_CONN_ST_CONN) ||
+      (p_cb->use_interface != NFC_NFCEE_INTERFACE_APDU) || (num_apdu == 0) ||
+      (p_apdu == nullptr)) {
+    LOG(ERROR) << StringPrintf("Bad ee_handle or no APDU");
+    return NFA_STATUS_INVALID_PARAM;
+  }
+  for (xx = 0; xx < num_apdu; xx++) {
+    /* the C-APDU has to fit in one GKI buffer with the NCI headers */
+    if ((p_apdu[xx].p_data == nullptr) ||
+        (p_apdu[xx].len > GKI_MAX_BUF_SIZE - NFC_HDR_SIZE -
+                              NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE)) {
+      LOG(ERROR) << StringPrintf("Bad APDU[%d] len:%d", xx, p_apdu[xx].len);
+      return NFA_STATUS_INVALID_PARAM;
+    }
+  }
+
+  p_msg = (tNFA_EE_API_SEND_APDUS*)GKI_getbuf(sizeof(tNFA_EE_API_SEND_APDUS));
+  if (p_msg == nullptr) return NFA_STATUS_FAILED;
+  GKI_init_q(&p_msg->apdu_q);
+
+  /* build the NCI data packets here, the NFC task sends them as they are */
+  for (xx = 0; xx < num_apdu; xx++) {
+    p_pkt = (NFC_HDR*)GKI_getbuf(NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE +
+                                 p_apdu[xx].len + NFC_HDR_SIZE);
+    if (p_pkt == nullptr) {
+      while ((p_pkt = (NFC_HDR*)GKI_dequeue(&p_msg->apdu_q)) != nullptr)
+        GKI_freebuf(p_pkt);
+      GKI_freebuf(p_msg);
+      return NFA_STATUS_FAILED;
+    }
+    p_pkt->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
+    p_pkt->len = p_apdu[xx].len;
+    p_pkt->layer_specific = 0;
+    memcpy((uint8_t*)(p_pkt + 1) + p_pkt->offset, p_apdu[xx].p_data,
+           p_pkt->len);
+    GKI_enqueue(&p_msg->apdu_q, p_pkt);
+  }
+
+  p_msg->hdr.event = NFA_EE_API_SEND_APDUS_EVT;
+  p_msg->p_cb = p_cb;
+
+  nfa_sys_sendmsg(p_msg);
+
+  return NFA_STATUS_OK;
+}
+
 /*******************************************************************************
 **
 ** Function         NFA_EeDisconnect
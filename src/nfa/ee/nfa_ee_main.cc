@@ -60,12 +60,15 @@ const tNFA_EE_SM_ACT nfa_ee_actions[] = {
     nfa_ee_api_clear_proto_cfg,   /*NFA_EE_API_CLEAR_PROTO_CFG_EVT*/
     nfa_ee_api_add_aid,           /* NFA_EE_API_ADD_AID_EVT       */
     nfa_ee_api_remove_aid,        /* NFA_EE_API_REMOVE_AID_EVT    */
+    nfa_ee_api_add_aid_bulk,      /* NFA_EE_API_ADD_AID_BULK_EVT  */
+    nfa_ee_api_remove_aid_bulk,   /* NFA_EE_API_REMOVE_AID_BULK_EVT */
     nfa_ee_api_add_sys_code,      /* NFA_EE_API_ADD_SYSCODE_EVT   */
     nfa_ee_api_remove_sys_code,   /* NFA_EE_API_REMOVE_SYSCODE_EVT*/
     nfa_ee_api_lmrt_size,         /* NFA_EE_API_LMRT_SIZE_EVT     */
     nfa_ee_api_update_now,        /* NFA_EE_API_UPDATE_NOW_EVT    */
     nfa_ee_api_connect,           /* NFA_EE_API_CONNECT_EVT       */
     nfa_ee_api_send_data,         /* NFA_EE_API_SEND_DATA_EVT     */
+    nfa_ee_api_send_apdus,        /* NFA_EE_API_SEND_APDUS_EVT    */
     nfa_ee_api_disconnect,        /* NFA_EE_API_DISCONNECT_EVT    */
     nfa_ee_api_pwr_and_link_ctrl, /* NFA_EE_API_PWR_AND_LINK_CTRL_EVT */
     nfa_ee_nci_disc_rsp,          /* NFA_EE_NCI_DISC_RSP_EVT      */
@@ -125,6 +128,22 @@ void nfa_ee_sys_enable(void) {
   LOG(VERBOSE) << StringPrintf("%s", __func__);
 
   nfa_ee_cb.route_block_control = 0x00;
+  /* NFCC was reset, it has no LMRT */
+  nfa_ee_cb.lmrt_sent_valid = false;
+
+  /* long select qualifier (prefix match) is defined since NCI 2.0 */
+  nfa_ee_cb.aid_compact =
+      (NFC_GetNCIVersion() >= NCI_VERSION_2_0) &&
+      (NfcConfig::getUnsigned(NAME_NFA_AID_ROUTE_COMPACT, 1) != 0);
+
+  /* C-APDU pipelining is opt-in, for NFCEEs which accept it */
+  nfa_ee_cb.apdu_max_in_flight = NFA_EE_MAX_APDU_IN_FLIGHT;
+  if (NfcConfig::hasKey(NAME_NFA_EE_MAX_APDU_IN_FLIGHT)) {
+    unsigned max_in_flight =
+        NfcConfig::getUnsigned(NAME_NFA_EE_MAX_APDU_IN_FLIGHT);
+    if ((max_in_flight > 0) && (max_in_flight <= 0xFF))
+      nfa_ee_cb.apdu_max_in_flight = (uint8_t)max_in_flight;
+  }
 
   if (NfcConfig::hasKey(NAME_NFA_AID_BLOCK_ROUTE)) {
     unsigned retlen = NfcConfig::getUnsigned(NAME_NFA_AID_BLOCK_ROUTE);
@@ -173,7 +192,7 @@ void nfa_ee_restore_one_ecb(tNFA_EE_ECB* p_cb) {
     if (p_cb->ee_status != p_cb->ee_old_status) {
       p_cb->ecb_flags |= NFA_EE_ECB_FLAGS_RESTORE;
       if (p_cb->ee_old_status == NFC_NFCEE_STATUS_ACTIVE) {
-        NFC_NfceeModeSet(p_cb->nfcee_id, NFC_MODE_ACTIVATE);
+        nfa_ee_mode_set(p_cb, NFC_MODE_ACTIVATE);
 
         if (nfa_ee_cb.ee_cfged & mask) {
           /* if any routing is configured on this NFCEE. need to mark this NFCEE
@@ -183,7 +202,7 @@ void nfa_ee_restore_one_ecb(tNFA_EE_ECB* p_cb) {
           p_cb->ecb_flags |= NFA_EE_ECB_FLAGS_VS;
         }
       } else {
-        NFC_NfceeModeSet(p_cb->nfcee_id, NFC_MODE_DEACTIVATE);
+        nfa_ee_mode_set(p_cb, NFC_MODE_DEACTIVATE);
       }
     } else if (p_cb->ee_status == NFC_NFCEE_STATUS_ACTIVE) {
       /* the initial NFCEE status after start up is the same as the current
@@ -472,8 +491,10 @@ void nfa_ee_sys_disable(void) {
   }
 
   nfa_ee_cb.num_ee_expecting = 0;
+  nfa_ee_cb.num_mode_set = 0;
   p_cb = nfa_ee_cb.ecb;
   for (xx = 0; xx < nfa_ee_cb.cur_ee; xx++, p_cb++) {
+    p_cb->mode_set_st = NFA_EE_MODE_SET_ST_IDLE;
     if (p_cb->conn_st == NFA_EE_CONN_ST_CONN) {
       if (nfa_sys_is_graceful_disable()) {
         /* Disconnect NCI connection on graceful shutdown */
@@ -587,6 +608,10 @@ static std::string nfa_ee_sm_evt_2_str(uint16_t event) {
       return "API_ADD_AID";
     case NFA_EE_API_REMOVE_AID_EVT:
       return "API_REMOVE_AID";
+    case NFA_EE_API_ADD_AID_BULK_EVT:
+      return "API_ADD_AID_BULK";
+    case NFA_EE_API_REMOVE_AID_BULK_EVT:
+      return "API_REMOVE_AID_BULK";
     case NFA_EE_API_ADD_SYSCODE_EVT:
       return "NFA_EE_API_ADD_SYSCODE_EVT";
     case NFA_EE_API_REMOVE_SYSCODE_EVT:
@@ -599,6 +624,8 @@ static std::string nfa_ee_sm_evt_2_str(uint16_t event) {
       return "API_CONNECT";
     case NFA_EE_API_SEND_DATA_EVT:
       return "API_SEND_DATA";
+    case NFA_EE_API_SEND_APDUS_EVT:
+      return "API_SEND_APDUS";
     case NFA_EE_API_DISCONNECT_EVT:
       return "API_DISCONNECT";
     case NFA_EE_API_PWR_AND_LINK_CTRL_EVT:
@@ -48,6 +48,11 @@ static bool nfa_hci_api_send_event(tNFA_HCI_EVENT_DATA* p_evt_data);
 static bool nfa_hci_api_send_cmd(tNFA_HCI_EVENT_DATA* p_evt_data);
 static void nfa_hci_api_send_rsp(tNFA_HCI_EVENT_DATA* p_evt_data);
 static void nfa_hci_api_add_static_pipe(tNFA_HCI_EVENT_DATA* p_evt_data);
+static uint8_t nfa_hci_api_get_pipe(NFC_HDR* p_msg);
+static bool nfa_hci_api_pipe_busy(NFC_HDR* p_msg);
+static void nfa_hci_api_pipe_failed(NFC_HDR* p_msg);
+static bool nfa_hci_api_wait_for_pipe(NFC_HDR* p_msg);
+static void nfa_hci_check_pipe_cmd_q(void);
 
 static void nfa_hci_handle_identity_mgmt_gate_pkt(uint8_t* p_data,
                                                   tNFA_HCI_DYN_PIPE* p_pipe);
@@ -84,6 +89,9 @@ void nfa_hci_check_pending_api_requests(void) {
        nullptr))
     return;
 
+  /* Wait if a command is outstanding on the pipe of the request */
+  if (nfa_hci_api_wait_for_pipe(p_msg)) return;
+
   /* Process API request */
   p_evt_data = (tNFA_HCI_EVENT_DATA*)p_msg;
 
@@ -128,12 +136,18 @@ void nfa_hci_check_api_requests(void) {
   NFC_HDR* p_msg;
   tNFA_HCI_EVENT_DATA* p_evt_data;
 
+  /* Requests that waited for their pipe go first */
+  nfa_hci_check_pipe_cmd_q();
+
   for (;;) {
     /* If busy, or API queue is empty, then exit */
     if ((nfa_hci_cb.hci_state != NFA_HCI_STATE_IDLE) ||
         ((p_msg = (NFC_HDR*)GKI_dequeue(&nfa_hci_cb.hci_api_q)) == nullptr))
       break;
 
+    /* Wait if a command is outstanding on the pipe of the request */
+    if (nfa_hci_api_wait_for_pipe(p_msg)) continue;
+
     /* Process API request */
     p_evt_data = (tNFA_HCI_EVENT_DATA*)p_msg;
 
@@ -214,6 +228,227 @@ void nfa_hci_check_api_requests(void) {
   }
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hci_api_get_pipe
+**
+** Description      Find the pipe an API request sends a command or an event on
+**
+** Returns          the pipe, or 0 if the request is not for a pipe
+**
+*******************************************************************************/
+static uint8_t nfa_hci_api_get_pipe(NFC_HDR* p_msg) {
+  tNFA_HCI_EVENT_DATA* p_evt_data = (tNFA_HCI_EVENT_DATA*)p_msg;
+
+  switch (p_msg->event) {
+    case NFA_HCI_API_GET_REGISTRY_EVT:
+      return p_evt_data->get_registry.pipe;
+    case NFA_HCI_API_SET_REGISTRY_EVT:
+      return p_evt_data->set_registry.pipe;
+    case NFA_HCI_API_OPEN_PIPE_EVT:
+      return p_evt_data->open_pipe.pipe;
+    case NFA_HCI_API_CLOSE_PIPE_EVT:
+      return p_evt_data->close_pipe.pipe;
+    case NFA_HCI_API_DELETE_PIPE_EVT:
+      return p_evt_data->delete_pipe.pipe;
+    case NFA_HCI_API_SEND_CMD_EVT:
+      return p_evt_data->send_cmd.pipe;
+    case NFA_HCI_API_SEND_EVENT_EVT:
+      return p_evt_data->send_evt.pipe;
+  }
+  return 0;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_api_pipe_busy
+**
+** Description      Check if an API request is for a pipe with a command
+**                  outstanding, or with an earlier request still waiting in
+**                  pipe_cmd_q, so requests to a pipe are served in order
+**
+** Returns          TRUE, if the pipe of the request is busy
+**
+*******************************************************************************/
+static bool nfa_hci_api_pipe_busy(NFC_HDR* p_msg) {
+  uint8_t pipe = nfa_hci_api_get_pipe(p_msg);
+  NFC_HDR* p_queued;
+
+  if (pipe == 0) return false;
+
+  if (nfa_hciu_find_pipe_cmd(pipe) != nullptr) return true;
+
+  for (p_queued = (NFC_HDR*)GKI_getfirst(&nfa_hci_cb.pipe_cmd_q);
+       (p_queued != nullptr) && (p_queued != p_msg);
+       p_queued = (NFC_HDR*)GKI_getnext(p_queued)) {
+    if (nfa_hci_api_get_pipe(p_queued) == pipe) return true;
+  }
+  return false;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_api_pipe_failed
+**
+** Description      Tell the application that an API request waiting for its
+**                  pipe is dropped, with the event the request ends with
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hci_api_pipe_failed(NFC_HDR* p_msg) {
+  tNFA_HCI_EVENT_DATA* p_evt_data = (tNFA_HCI_EVENT_DATA*)p_msg;
+  tNFA_HCI_EVT_DATA evt_data;
+
+  switch (p_msg->event) {
+    case NFA_HCI_API_GET_REGISTRY_EVT:
+      nfa_hciu_send_pipe_cmd_failed(
+          p_evt_data->get_registry.pipe, NFA_HCI_ANY_GET_PARAMETER,
+          p_evt_data->get_registry.reg_inx, p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_SET_REGISTRY_EVT:
+      nfa_hciu_send_pipe_cmd_failed(
+          p_evt_data->set_registry.pipe, NFA_HCI_ANY_SET_PARAMETER,
+          p_evt_data->set_registry.reg_inx, p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_OPEN_PIPE_EVT:
+      nfa_hciu_send_pipe_cmd_failed(p_evt_data->open_pipe.pipe,
+                                    NFA_HCI_ANY_OPEN_PIPE, 0,
+                                    p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_CLOSE_PIPE_EVT:
+      nfa_hciu_send_pipe_cmd_failed(p_evt_data->close_pipe.pipe,
+                                    NFA_HCI_ANY_CLOSE_PIPE, 0,
+                                    p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_DELETE_PIPE_EVT:
+      evt_data.deleted.status = NFA_STATUS_FAILED;
+      evt_data.deleted.pipe = p_evt_data->delete_pipe.pipe;
+      nfa_hciu_send_to_app(NFA_HCI_DELETE_PIPE_EVT, &evt_data,
+                           p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_SEND_CMD_EVT:
+      evt_data.rsp_rcvd.status = NFA_STATUS_FAILED;
+      evt_data.rsp_rcvd.pipe = p_evt_data->send_cmd.pipe;
+      evt_data.rsp_rcvd.rsp_code = NFA_HCI_ANY_E_TIMEOUT;
+      evt_data.rsp_rcvd.rsp_len = 0;
+      nfa_hciu_send_to_app(NFA_HCI_RSP_RCVD_EVT, &evt_data,
+                           p_evt_data->comm.hci_handle);
+      break;
+
+    case NFA_HCI_API_SEND_EVENT_EVT:
+      evt_data.evt_sent.status = NFA_STATUS_FAILED;
+      nfa_hciu_send_to_app(NFA_HCI_EVENT_SENT_EVT, &evt_data,
+                           p_evt_data->comm.hci_handle);
+      break;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_flush_pipe_cmd_q
+**
+** Description      Drop the API requests waiting in pipe_cmd_q for a pipe
+**                  which is released, 0 for all the pipes, and tell their
+**                  applications
+**
+** Returns          none
+**
+*******************************************************************************/
+void nfa_hci_flush_pipe_cmd_q(uint8_t pipe) {
+  NFC_HDR* p_msg = (NFC_HDR*)GKI_getfirst(&nfa_hci_cb.pipe_cmd_q);
+  NFC_HDR* p_next;
+
+  while (p_msg != nullptr) {
+    p_next = (NFC_HDR*)GKI_getnext(p_msg);
+
+    if ((pipe == 0) || (nfa_hci_api_get_pipe(p_msg) == pipe)) {
+      GKI_remove_from_queue(&nfa_hci_cb.pipe_cmd_q, p_msg);
+      nfa_hci_api_pipe_failed(p_msg);
+      GKI_freebuf(p_msg);
+    }
+    p_msg = p_next;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_api_wait_for_pipe
+**
+** Description      Queue an API request sending a command on a pipe, while
+**                  another command is outstanding on that pipe
+**
+** Returns          TRUE, if the request is queued
+**                  FALSE, if the request can be processed
+**
+*******************************************************************************/
+static bool nfa_hci_api_wait_for_pipe(NFC_HDR* p_msg) {
+  if (!nfa_hci_api_pipe_busy(p_msg)) return false;
+
+  GKI_enqueue(&nfa_hci_cb.pipe_cmd_q, p_msg);
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_check_pipe_cmd_q
+**
+** Description      Process the API requests waiting for a command on their
+**                  pipe, in order, for each pipe that became free
+**
+** Returns          none
+**
+*******************************************************************************/
+static void nfa_hci_check_pipe_cmd_q(void) {
+  NFC_HDR* p_msg = (NFC_HDR*)GKI_getfirst(&nfa_hci_cb.pipe_cmd_q);
+  NFC_HDR* p_next;
+  tNFA_HCI_EVENT_DATA* p_evt_data;
+  bool b_free;
+
+  while ((p_msg != nullptr) && (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE)) {
+    p_next = (NFC_HDR*)GKI_getnext(p_msg);
+
+    /* Leave the request queued while its pipe is still busy */
+    if (nfa_hci_api_pipe_busy(p_msg) == false) {
+      GKI_remove_from_queue(&nfa_hci_cb.pipe_cmd_q, p_msg);
+      p_evt_data = (tNFA_HCI_EVENT_DATA*)p_msg;
+      nfa_hci_cb.app_in_use = p_evt_data->comm.hci_handle;
+
+      b_free = true;
+      switch (p_msg->event) {
+        case NFA_HCI_API_GET_REGISTRY_EVT:
+          b_free = nfa_hci_api_get_reg_value(p_evt_data);
+          break;
+        case NFA_HCI_API_SET_REGISTRY_EVT:
+          b_free = nfa_hci_api_set_reg_value(p_evt_data);
+          break;
+        case NFA_HCI_API_OPEN_PIPE_EVT:
+          nfa_hci_api_open_pipe(p_evt_data);
+          break;
+        case NFA_HCI_API_CLOSE_PIPE_EVT:
+          nfa_hci_api_close_pipe(p_evt_data);
+          break;
+        case NFA_HCI_API_DELETE_PIPE_EVT:
+          nfa_hci_api_delete_pipe(p_evt_data);
+          break;
+        case NFA_HCI_API_SEND_CMD_EVT:
+          b_free = nfa_hci_api_send_cmd(p_evt_data);
+          break;
+        case NFA_HCI_API_SEND_EVENT_EVT:
+          b_free = nfa_hci_api_send_event(p_evt_data);
+          break;
+      }
+      if (b_free) GKI_freebuf(p_msg);
+    }
+    p_msg = p_next;
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hci_api_register
@@ -1428,6 +1663,15 @@ void nfa_hci_handle_admin_gate_rsp(uint8_t* p_data, uint8_t data_len) {
             nfa_hciu_send_set_param_cmd(
                 NFA_HCI_ADMIN_PIPE, NFA_HCI_WHITELIST_INDEX,
                 p_nfa_hci_cfg->num_allowlist_host, p_nfa_hci_cfg->p_allowlist);
+
+            /* The host controller kept the session, so the other hosts do
+             * not depend on the rest of the DH setup: start activating the
+             * NFCEEs now. Completion is checked again once the WHITELIST is
+             * set. */
+            if (NFA_GetNCIVersion() >= NCI_VERSION_2_0) {
+              NFA_EeGetInfo(&nfa_hci_cb.num_nfcee, nfa_hci_cb.ee_info);
+              nfa_hci_enable_one_nfcee();
+            }
           } else {
             /* Something wrong, NVRAM data could be corrupt or first start with
              * default session id */
@@ -1957,10 +2201,22 @@ static void nfa_hci_handle_generic_gate_rsp(uint8_t* p_data, uint8_t data_len,
                                             tNFA_HCI_DYN_PIPE* p_pipe) {
   tNFA_HCI_EVT_DATA evt_data;
   tNFA_STATUS status = NFA_STATUS_OK;
+  tNFA_HCI_PIPE_CMD* p_cmd = nfa_hciu_find_pipe_cmd(p_pipe->pipe_id);
+  tNFA_HCI_COMMAND cmd_sent = nfa_hci_cb.cmd_sent;
+  tNFA_HANDLE app_handle = nfa_hci_cb.app_in_use;
+  uint8_t param = nfa_hci_cb.param_in_use;
 
   if (nfa_hci_cb.inst != NFA_HCI_ANY_OK) status = NFA_STATUS_FAILED;
 
-  if (nfa_hci_cb.cmd_sent == NFA_HCI_ANY_OPEN_PIPE) {
+  /* Response to the command outstanding on this pipe */
+  if (p_cmd != nullptr) {
+    cmd_sent = p_cmd->cmd_sent;
+    app_handle = p_cmd->app_handle;
+    param = p_cmd->param_in_use;
+    nfa_hciu_pipe_cmd_done(p_cmd);
+  }
+
+  if (cmd_sent == NFA_HCI_ANY_OPEN_PIPE) {
     if (status == NFA_STATUS_OK) p_pipe->pipe_state = NFA_HCI_PIPE_OPENED;
 
     nfa_hci_cb.nv_write_needed = true;
@@ -1969,8 +2225,8 @@ static void nfa_hci_handle_generic_gate_rsp(uint8_t* p_data, uint8_t data_len,
     evt_data.opened.pipe = p_pipe->pipe_id;
 
     nfa_hciu_send_to_app(NFA_HCI_OPEN_PIPE_EVT, &evt_data,
-                         nfa_hci_cb.app_in_use);
-  } else if (nfa_hci_cb.cmd_sent == NFA_HCI_ANY_CLOSE_PIPE) {
+                         app_handle);
+  } else if (cmd_sent == NFA_HCI_ANY_CLOSE_PIPE) {
     p_pipe->pipe_state = NFA_HCI_PIPE_CLOSED;
 
     nfa_hci_cb.nv_write_needed = true;
@@ -1980,26 +2236,26 @@ static void nfa_hci_handle_generic_gate_rsp(uint8_t* p_data, uint8_t data_len,
     evt_data.opened.pipe = p_pipe->pipe_id;
 
     nfa_hciu_send_to_app(NFA_HCI_CLOSE_PIPE_EVT, &evt_data,
-                         nfa_hci_cb.app_in_use);
-  } else if (nfa_hci_cb.cmd_sent == NFA_HCI_ANY_GET_PARAMETER) {
+                         app_handle);
+  } else if (cmd_sent == NFA_HCI_ANY_GET_PARAMETER) {
     /* Tell application */
     evt_data.registry.status = status;
     evt_data.registry.pipe = p_pipe->pipe_id;
     evt_data.registry.data_len = data_len;
-    evt_data.registry.index = nfa_hci_cb.param_in_use;
+    evt_data.registry.index = param;
 
     memcpy(evt_data.registry.reg_data, p_data, data_len);
 
     nfa_hciu_send_to_app(NFA_HCI_GET_REG_RSP_EVT, &evt_data,
-                         nfa_hci_cb.app_in_use);
-  } else if (nfa_hci_cb.cmd_sent == NFA_HCI_ANY_SET_PARAMETER) {
+                         app_handle);
+  } else if (cmd_sent == NFA_HCI_ANY_SET_PARAMETER) {
     /* Tell application */
     evt_data.registry.status = status;
     ;
     evt_data.registry.pipe = p_pipe->pipe_id;
 
     nfa_hciu_send_to_app(NFA_HCI_SET_REG_RSP_EVT, &evt_data,
-                         nfa_hci_cb.app_in_use);
+                         app_handle);
   } else {
     /* Could be a response to application specific command sent, pass it on */
     evt_data.rsp_rcvd.status = NFA_STATUS_OK;
@@ -2012,7 +2268,7 @@ static void nfa_hci_handle_generic_gate_rsp(uint8_t* p_data, uint8_t data_len,
       memcpy(evt_data.rsp_rcvd.rsp_data, p_data, data_len);
 
     nfa_hciu_send_to_app(NFA_HCI_RSP_RCVD_EVT, &evt_data,
-                         nfa_hci_cb.app_in_use);
+                         app_handle);
   }
 }
 
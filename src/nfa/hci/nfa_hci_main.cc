@@ -32,6 +32,7 @@
 #include "nfa_hci_defs.h"
 #include "nfa_hci_int.h"
 #include "nfa_nv_co.h"
+#include "nfc_config.h"
 
 using android::base::StringPrintf;
 
@@ -59,10 +60,13 @@ static bool nfa_hci_evt_hdlr(NFC_HDR* p_msg);
 static void nfa_hci_sys_enable(void);
 static void nfa_hci_sys_disable(void);
 static void nfa_hci_rsp_timeout(void);
+static void nfa_hci_pipe_rsp_timeout(void);
 static void nfa_hci_conn_cback(uint8_t conn_id, tNFC_CONN_EVT event,
                                tNFC_CONN* p_data);
 static void nfa_hci_set_receive_buf(uint8_t pipe);
 static void nfa_hci_assemble_msg(uint8_t* p_data, uint16_t data_len);
+static bool nfa_hci_grow_assembly_buf(uint16_t needed_len);
+static void nfa_hci_free_assembly_buf(void);
 static void nfa_hci_handle_nv_read(uint8_t block, tNFA_STATUS status);
 
 /*****************************************************************************
@@ -192,6 +196,13 @@ void nfa_hci_init(void) {
 
   nfa_hci_cb.hci_state = NFA_HCI_STATE_STARTUP;
   nfa_hci_cb.num_nfcee = NFA_HCI_MAX_HOST_IN_NETWORK;
+
+  nfa_hci_cb.max_assembly_len = NFA_HCI_MAX_MSG_LEN;
+  if (NfcConfig::hasKey(NAME_NFA_HCI_MAX_MSG_LEN) &&
+      (NfcConfig::getUnsigned(NAME_NFA_HCI_MAX_MSG_LEN) < NFA_HCI_MAX_MSG_LEN))
+    nfa_hci_cb.max_assembly_len =
+        (uint16_t)NfcConfig::getUnsigned(NAME_NFA_HCI_MAX_MSG_LEN);
+
   /* register message handler on NFA SYS */
   nfa_sys_register(NFA_ID_HCI, &nfa_hci_sys_reg);
 }
@@ -410,6 +421,7 @@ void nfa_hci_restore_default_config(uint8_t* p_session_id) {
   memset(&nfa_hci_cb.cfg, 0, sizeof(nfa_hci_cb.cfg));
   memcpy(nfa_hci_cb.cfg.admin_gate.session_id, p_session_id,
          NFA_HCI_SESSION_ID_LEN);
+  nfa_hciu_rebuild_lookup();
   nfa_hci_cb.nv_write_needed = true;
 }
 
@@ -430,6 +442,7 @@ void nfa_hci_proc_nfcc_power_mode(uint8_t nfcc_power_mode) {
     nfa_hci_cb.b_low_power_mode = false;
     if (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE) {
       nfa_hci_cb.hci_state = NFA_HCI_STATE_RESTORE;
+      nfa_hci_cb.startup_tick = GKI_get_os_tick_count();
       nfa_hci_cb.ee_disc_cmplt = false;
       nfa_hci_cb.ee_disable_disc = true;
       if (nfa_hci_cb.num_nfcee > 1)
@@ -502,7 +515,9 @@ void nfa_hci_dh_startup_complete(void) {
 void nfa_hci_startup_complete(tNFA_STATUS status) {
   tNFA_HCI_EVT_DATA evt_data;
 
-  LOG(VERBOSE) << StringPrintf("Status: %u", status);
+  LOG(VERBOSE) << StringPrintf(
+      "Status: %u after %u ms", status,
+      GKI_TICKS_TO_MS(GKI_get_os_tick_count() - nfa_hci_cb.startup_tick));
 
   nfa_sys_stop_timer(&nfa_hci_cb.timer);
 
@@ -536,18 +551,25 @@ void nfa_hci_startup_complete(tNFA_STATUS status) {
 void nfa_hci_enable_one_nfcee(void) {
   uint8_t xx;
   uint8_t nfceeid = 0;
+  tNFA_EE_ECB* p_cb;
+  bool pending = false;
 
   LOG(VERBOSE) << StringPrintf("%d", nfa_hci_cb.num_nfcee);
 
+  /* request activation of all inactive NFCEEs at once, NFA EE sends the mode
+   * sets back to back */
   for (xx = 0; xx < nfa_hci_cb.num_nfcee; xx++) {
     nfceeid = nfa_hci_cb.ee_info[xx].ee_handle & ~NFA_HANDLE_GROUP_EE;
     if (nfa_hci_cb.ee_info[xx].ee_status == NFA_EE_STATUS_INACTIVE) {
-      NFC_NfceeModeSet(nfceeid, NFC_MODE_ACTIVATE);
-      return;
+      p_cb = nfa_ee_find_ecb(nfceeid);
+      if (p_cb == nullptr) continue;
+      if ((p_cb->mode_set_st != NFA_EE_MODE_SET_ST_IDLE) ||
+          (nfa_ee_mode_set(p_cb, NFC_MODE_ACTIVATE) == NFC_STATUS_OK))
+        pending = true;
     }
   }
 
-  if (xx == nfa_hci_cb.num_nfcee) {
+  if (!pending) {
     if ((nfa_hci_cb.hci_state == NFA_HCI_STATE_WAIT_NETWK_ENABLE) ||
         (nfa_hci_cb.hci_state == NFA_HCI_STATE_RESTORE_NETWK_ENABLE)) {
       nfa_hciu_send_get_param_cmd(NFA_HCI_ADMIN_PIPE, NFA_HCI_HOST_LIST_INDEX);
@@ -598,7 +620,8 @@ void nfa_hci_startup(void) {
           found = true;
 
           if (nfa_hci_cb.ee_info[count].ee_status == NFA_EE_STATUS_INACTIVE) {
-            NFC_NfceeModeSet(target_handle, NFC_MODE_ACTIVATE);
+            tNFA_EE_ECB* p_cb = nfa_ee_find_ecb(target_handle);
+            if (p_cb) nfa_ee_mode_set(p_cb, NFC_MODE_ACTIVATE);
           }
           if ((status = NFC_ConnCreate(NCI_DEST_TYPE_NFCEE, target_handle,
                                        NFA_EE_INTERFACE_HCI_ACCESS,
@@ -638,6 +661,7 @@ static void nfa_hci_sys_enable(void) {
   LOG(VERBOSE) << __func__;
   nfa_ee_reg_cback_enable_done(&nfa_hci_ee_info_cback);
 
+  nfa_hci_cb.startup_tick = GKI_get_os_tick_count();
   nfa_nv_co_read((uint8_t*)&nfa_hci_cb.cfg, sizeof(nfa_hci_cb.cfg),
                  DH_NV_BLOCK);
   nfa_sys_start_timer(&nfa_hci_cb.timer, NFA_HCI_RSP_TIMEOUT_EVT,
@@ -655,8 +679,22 @@ static void nfa_hci_sys_enable(void) {
 *******************************************************************************/
 static void nfa_hci_sys_disable(void) {
   tNFA_HCI_EVT_DATA evt_data;
+  int xx;
 
   nfa_sys_stop_timer(&nfa_hci_cb.timer);
+  /* No response comes to the commands on the pipes any more */
+  for (xx = 0; xx < NFA_HCI_MAX_PIPE_CB; xx++) {
+    if (nfa_hci_cb.pipe_cmd[xx].in_use)
+      nfa_hciu_pipe_cmd_failed(nfa_hci_cb.cfg.dyn_pipes[xx].pipe_id,
+                               &nfa_hci_cb.pipe_cmd[xx]);
+  }
+  nfa_hci_flush_pipe_cmd_q(0);
+  nfa_hci_free_assembly_buf();
+  nfa_hci_cb.assembling = false;
+
+  /* The configuration written must be in NV memory before the stack goes
+   * down */
+  nfa_nv_co_flush();
 
   if (nfa_hci_cb.conn_id) {
     if (nfa_sys_is_graceful_disable()) {
@@ -691,6 +729,7 @@ static void nfa_hci_conn_cback(uint8_t conn_id, tNFC_CONN_EVT event,
   uint8_t chaining_bit;
   uint8_t pipe;
   uint16_t pkt_len;
+  bool pipe_cmd_rsp;
   const uint8_t MAX_BUFF_SIZE = 100;
   char buff[MAX_BUFF_SIZE];
   LOG(VERBOSE) << StringPrintf("%s State: %u  Cmd: %u", __func__,
@@ -808,9 +847,13 @@ static void nfa_hci_conn_cback(uint8_t conn_id, tNFC_CONN_EVT event,
     return;
   }
 
+  /* A response to a command outstanding on its pipe only concerns the pipe */
+  pipe_cmd_rsp = (nfa_hci_cb.type == NFA_HCI_RESPONSE_TYPE) &&
+                 (nfa_hciu_find_pipe_cmd(pipe) != nullptr);
+
   /* If we got a response, cancel the response timer. Also, if waiting for */
   /* a single response, we can go back to idle state                       */
-  if ((nfa_hci_cb.hci_state == NFA_HCI_STATE_WAIT_RSP) &&
+  if ((nfa_hci_cb.hci_state == NFA_HCI_STATE_WAIT_RSP) && (!pipe_cmd_rsp) &&
       ((nfa_hci_cb.type == NFA_HCI_RESPONSE_TYPE) ||
        (nfa_hci_cb.w4_rsp_evt && (nfa_hci_cb.type == NFA_HCI_EVENT_TYPE)))) {
     nfa_sys_stop_timer(&nfa_hci_cb.timer);
@@ -841,11 +884,14 @@ static void nfa_hci_conn_cback(uint8_t conn_id, tNFC_CONN_EVT event,
       break;
   }
 
-  if ((nfa_hci_cb.type == NFA_HCI_RESPONSE_TYPE) ||
+  if (((nfa_hci_cb.type == NFA_HCI_RESPONSE_TYPE) && (!pipe_cmd_rsp)) ||
       (nfa_hci_cb.w4_rsp_evt && (nfa_hci_cb.type == NFA_HCI_EVENT_TYPE))) {
     nfa_hci_cb.w4_rsp_evt = false;
   }
 
+  /* The handlers are done with the reassembled message */
+  nfa_hci_free_assembly_buf();
+
   /* Send a message to ouselves to check for anything to do */
   p_pkt->event = NFA_HCI_CHECK_QUEUE_EVT;
   p_pkt->len = 0;
@@ -887,6 +933,9 @@ void nfa_hci_handle_nv_read(uint8_t block, tNFA_STATUS status) {
       os_tick = GKI_get_os_tick_count();
       memcpy(session_id, (uint8_t*)&os_tick, (NFA_HCI_SESSION_ID_LEN / 2));
       nfa_hci_restore_default_config(session_id);
+    } else {
+      /* Index the pipes and gates restored from NV */
+      nfa_hciu_rebuild_lookup();
     }
     nfa_hci_startup();
   }
@@ -1065,6 +1114,43 @@ void nfa_hci_rsp_timeout() {
   if (evt != 0) nfa_hciu_send_to_app(evt, &evt_data, nfa_hci_cb.app_in_use);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hci_pipe_rsp_timeout
+**
+** Description      Handle the commands on pipes whose response timer expired
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hci_pipe_rsp_timeout(void) {
+  tNFA_HCI_PIPE_CMD* p_cmd;
+  uint8_t pipe_id;
+  int xx;
+
+  for (xx = 0; xx < NFA_HCI_MAX_PIPE_CB; xx++) {
+    p_cmd = &nfa_hci_cb.pipe_cmd[xx];
+    if ((!p_cmd->in_use) || (p_cmd->timer.in_use)) continue;
+
+    pipe_id = nfa_hci_cb.cfg.dyn_pipes[xx].pipe_id;
+
+    LOG(VERBOSE) << StringPrintf("%s: pipe: %u  Cmd: %u", __func__, pipe_id,
+                                 p_cmd->cmd_sent);
+
+    nfa_hciu_pipe_cmd_failed(pipe_id, p_cmd);
+
+    /* As no response to the command sent on this pipe, we may assume the pipe
+     * is deleted already and release the pipe, which fails the requests
+     * waiting for it. But still send delete pipe command to be safe, if the
+     * admin pipe is free. */
+    if (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE) {
+      nfa_hci_cb.app_in_use = p_cmd->app_handle;
+      nfa_hciu_send_delete_pipe_cmd(pipe_id);
+    }
+    nfa_hciu_release_pipe(pipe_id);
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hci_set_receive_buf
@@ -1075,6 +1161,8 @@ void nfa_hci_rsp_timeout() {
 **
 *******************************************************************************/
 static void nfa_hci_set_receive_buf(uint8_t pipe) {
+  nfa_hci_free_assembly_buf();
+
   if ((pipe >= NFA_HCI_FIRST_DYNAMIC_PIPE) &&
       (nfa_hci_cb.type == NFA_HCI_EVENT_TYPE)) {
     if ((nfa_hci_cb.rsp_buf_size) && (nfa_hci_cb.p_rsp_buf != nullptr)) {
@@ -1097,6 +1185,12 @@ static void nfa_hci_set_receive_buf(uint8_t pipe) {
 **
 *******************************************************************************/
 static void nfa_hci_assemble_msg(uint8_t* p_data, uint16_t data_len) {
+  if (((nfa_hci_cb.msg_len + data_len) > nfa_hci_cb.max_msg_len) &&
+      (nfa_hci_cb.p_msg_data != nfa_hci_cb.p_rsp_buf)) {
+    /* Internal buffer is too small, grow it towards the message size */
+    nfa_hci_grow_assembly_buf(nfa_hci_cb.msg_len + data_len);
+  }
+
   if ((nfa_hci_cb.msg_len + data_len) > nfa_hci_cb.max_msg_len) {
     /* Fill the buffer as much it can hold */
     memcpy(&nfa_hci_cb.p_msg_data[nfa_hci_cb.msg_len], p_data,
@@ -1114,6 +1208,66 @@ static void nfa_hci_assemble_msg(uint8_t* p_data, uint16_t data_len) {
   }
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hci_grow_assembly_buf
+**
+** Description      Move the message being reassembled into a GKI buffer of
+**                  at least needed_len bytes. The size doubles from the
+**                  current buffer size and is capped at max_assembly_len.
+**
+** Returns          TRUE if the buffer grew
+**
+*******************************************************************************/
+static bool nfa_hci_grow_assembly_buf(uint16_t needed_len) {
+  uint32_t new_len = nfa_hci_cb.max_msg_len;
+  uint8_t* p_new;
+
+  if (new_len >= nfa_hci_cb.max_assembly_len) return false;
+
+  while (new_len < needed_len) new_len <<= 1;
+  if (new_len > nfa_hci_cb.max_assembly_len)
+    new_len = nfa_hci_cb.max_assembly_len;
+
+  p_new = (uint8_t*)GKI_getbuf((uint16_t)new_len);
+  if (p_new == nullptr) {
+    LOG(ERROR) << StringPrintf("%s: Unable to allocate %u bytes", __func__,
+                               new_len);
+    return false;
+  }
+
+  LOG(VERBOSE) << StringPrintf("%s: %u -> %u bytes", __func__,
+                               nfa_hci_cb.max_msg_len, new_len);
+
+  memcpy(p_new, nfa_hci_cb.p_msg_data, nfa_hci_cb.msg_len);
+  if (nfa_hci_cb.p_assembly_buf != nullptr)
+    GKI_freebuf(nfa_hci_cb.p_assembly_buf);
+
+  nfa_hci_cb.p_assembly_buf = p_new;
+  nfa_hci_cb.p_msg_data = p_new;
+  nfa_hci_cb.max_msg_len = (uint16_t)new_len;
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hci_free_assembly_buf
+**
+** Description      Release the grown reassembly buffer, if any, and fall
+**                  back to the internal buffer
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hci_free_assembly_buf(void) {
+  if (nfa_hci_cb.p_assembly_buf == nullptr) return;
+
+  GKI_freebuf(nfa_hci_cb.p_assembly_buf);
+  nfa_hci_cb.p_assembly_buf = nullptr;
+  nfa_hci_cb.p_msg_data = nfa_hci_cb.msg_data;
+  nfa_hci_cb.max_msg_len = NFA_MAX_HCI_EVENT_LEN;
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hci_evt_hdlr
@@ -1150,6 +1304,10 @@ static bool nfa_hci_evt_hdlr(NFC_HDR* p_msg) {
         nfa_hci_rsp_timeout();
         break;
 
+      case NFA_HCI_PIPE_RSP_TIMEOUT_EVT:
+        nfa_hci_pipe_rsp_timeout();
+        break;
+
       case NFA_HCI_CHECK_QUEUE_EVT:
         if (HCI_LOOPBACK_DEBUG == NFA_HCI_DEBUG_ON) {
           if (p_msg->len != 0) {
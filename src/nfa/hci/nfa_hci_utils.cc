@@ -51,7 +51,14 @@ tNFA_HCI_DYN_PIPE* nfa_hciu_find_pipe_by_pid(uint8_t pipe_id) {
   tNFA_HCI_DYN_PIPE* pp = nfa_hci_cb.cfg.dyn_pipes;
   int xx = 0;
 
-  /* Loop through looking for a match */
+  if (pipe_id > NFA_HCI_MAX_PIPE_ID) return (nullptr);
+
+  if (pipe_id != 0) {
+    xx = nfa_hci_cb.pipe_lookup[pipe_id];
+    return (xx != 0) ? &nfa_hci_cb.cfg.dyn_pipes[xx - 1] : nullptr;
+  }
+
+  /* Pipe ID 0 matches the first free control block */
   for (; xx < NFA_HCI_MAX_PIPE_CB; xx++, pp++) {
     if (pp->pipe_id == pipe_id) return (pp);
   }
@@ -73,6 +80,12 @@ tNFA_HCI_DYN_GATE* nfa_hciu_find_gate_by_gid(uint8_t gate_id) {
   tNFA_HCI_DYN_GATE* pg = nfa_hci_cb.cfg.dyn_gates;
   int xx = 0;
 
+  if (gate_id != 0) {
+    xx = nfa_hci_cb.gate_lookup[gate_id];
+    return (xx != 0) ? &nfa_hci_cb.cfg.dyn_gates[xx - 1] : nullptr;
+  }
+
+  /* Gate ID 0 matches the first free control block */
   for (; xx < NFA_HCI_MAX_GATE_CB; xx++, pg++) {
     if (pg->gate_id == gate_id) return (pg);
   }
@@ -270,6 +283,7 @@ tNFA_HCI_DYN_GATE* nfa_hciu_alloc_gate(uint8_t gate_id,
       pg->gate_id = gate_id;
       pg->gate_owner = app_handle;
       pg->pipe_inx_mask = 0;
+      nfa_hci_cb.gate_lookup[gate_id] = xx + 1;
 
       LOG(VERBOSE) << StringPrintf(
           "nfa_hciu_alloc_gate id:%d  app_handle: 0x%04x", gate_id, app_handle);
@@ -288,40 +302,42 @@ tNFA_HCI_DYN_GATE* nfa_hciu_alloc_gate(uint8_t gate_id,
 
 /*******************************************************************************
 **
-** Function         nfa_hciu_send_msg
+** Function         nfa_hciu_send_pkt
 **
-** Description      This function will fragment the given packet, if necessary
-**                  and send it on the given pipe.
+** Description      Send one HCP packet to the HCI network
 **
 ** Returns          status
 **
 *******************************************************************************/
-tNFA_STATUS nfa_hciu_send_msg(uint8_t pipe_id, uint8_t type,
-                              uint8_t instruction, uint16_t msg_len,
-                              uint8_t* p_msg) {
+static tNFA_STATUS nfa_hciu_send_pkt(NFC_HDR* p_buf, uint8_t type,
+                                     uint8_t instruction) {
+  if (HCI_LOOPBACK_DEBUG == NFA_HCI_DEBUG_ON) {
+    handle_debug_loopback(p_buf, type, instruction);
+    return NFA_STATUS_OK;
+  }
+  return NFC_SendData(nfa_hci_cb.conn_id, p_buf);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_send_frags
+**
+** Description      This function will fragment the given message, if
+**                  necessary, copy the fragments into new buffers and send them
+**                  on the given pipe.
+**
+** Returns          status
+**
+*******************************************************************************/
+static tNFA_STATUS nfa_hciu_send_frags(uint8_t pipe_id, uint8_t type,
+                                       uint8_t instruction, uint16_t msg_len,
+                                       uint8_t* p_msg) {
   NFC_HDR* p_buf;
   uint8_t* p_data;
   bool first_pkt = true;
   uint16_t data_len;
   tNFA_STATUS status = NFA_STATUS_OK;
-  uint16_t max_seg_hcp_pkt_size;
-  if (nfa_hci_cb.buff_size > (NCI_DATA_HDR_SIZE + 2)) {
-    max_seg_hcp_pkt_size = nfa_hci_cb.buff_size - NCI_DATA_HDR_SIZE;
-  } else {
-    android_errorWriteLog(0x534e4554, "124521372");
-    return NFA_STATUS_NO_BUFFERS;
-  }
-  const uint8_t MAX_BUFF_SIZE = 100;
-  char buff[MAX_BUFF_SIZE];
-
-  LOG(VERBOSE) << StringPrintf(
-      "nfa_hciu_send_msg pipe_id:%d   %s  len:%d", pipe_id,
-      nfa_hciu_get_type_inst_names(pipe_id, type, instruction, buff,
-                                   MAX_BUFF_SIZE),
-      msg_len);
-
-  if (instruction == NFA_HCI_ANY_GET_PARAMETER)
-    nfa_hci_cb.param_in_use = *p_msg;
+  uint16_t max_seg_hcp_pkt_size = nfa_hci_cb.buff_size - NCI_DATA_HDR_SIZE;
 
   while ((first_pkt == true) || (msg_len != 0)) {
     p_buf = (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
@@ -364,10 +380,7 @@ tNFA_STATUS nfa_hciu_send_msg(uint8_t pipe_id, uint8_t type,
         }
       }
 
-      if (HCI_LOOPBACK_DEBUG == NFA_HCI_DEBUG_ON)
-        handle_debug_loopback(p_buf, type, instruction);
-      else
-        status = NFC_SendData(nfa_hci_cb.conn_id, p_buf);
+      status = nfa_hciu_send_pkt(p_buf, type, instruction);
     } else {
       LOG(ERROR) << StringPrintf("nfa_hciu_send_data_packet no buffers");
       status = NFA_STATUS_NO_BUFFERS;
@@ -375,6 +388,51 @@ tNFA_STATUS nfa_hciu_send_msg(uint8_t pipe_id, uint8_t type,
     }
   }
 
+  return status;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_msg_sent
+**
+** Description      Wait for the response, if a command was sent
+**
+**                  Commands sent from the idle state on the dynamic pipe of a
+**                  generic gate (i.e. application commands) only hold their
+**                  pipe. Other commands hold the whole HCI state machine.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void nfa_hciu_msg_sent(uint8_t pipe_id, uint8_t type,
+                              uint8_t instruction, uint8_t param,
+                              tNFA_STATUS status) {
+  tNFA_HCI_DYN_PIPE* p_pipe = nullptr;
+  tNFA_HCI_PIPE_CMD* p_cmd;
+
+  if ((type == NFA_HCI_COMMAND_TYPE) &&
+      (nfa_hci_cb.hci_state == NFA_HCI_STATE_IDLE) &&
+      (pipe_id >= NFA_HCI_FIRST_DYNAMIC_PIPE) &&
+      (pipe_id <= NFA_HCI_LAST_DYNAMIC_PIPE))
+    p_pipe = nfa_hciu_find_pipe_by_pid(pipe_id);
+
+  if ((p_pipe != nullptr) &&
+      (p_pipe->local_gate != NFA_HCI_IDENTITY_MANAGEMENT_GATE) &&
+      (p_pipe->local_gate != NFA_HCI_LOOP_BACK_GATE) &&
+      (p_pipe->local_gate != NFA_HCI_CONNECTIVITY_GATE)) {
+    if (status != NFA_STATUS_OK) return;
+
+    p_cmd = &nfa_hci_cb.pipe_cmd[p_pipe - nfa_hci_cb.cfg.dyn_pipes];
+    p_cmd->in_use = true;
+    p_cmd->cmd_sent = instruction;
+    p_cmd->app_handle = nfa_hci_cb.app_in_use;
+    p_cmd->param_in_use = param;
+
+    nfa_sys_start_timer(&p_cmd->timer, NFA_HCI_PIPE_RSP_TIMEOUT_EVT,
+                        p_nfa_hci_cfg->hcp_response_timeout);
+    return;
+  }
+
   /* Start timer if response to wait for a particular time for the response  */
   if (type == NFA_HCI_COMMAND_TYPE) {
     nfa_hci_cb.cmd_sent = instruction;
@@ -385,6 +443,42 @@ tNFA_STATUS nfa_hciu_send_msg(uint8_t pipe_id, uint8_t type,
     nfa_sys_start_timer(&nfa_hci_cb.timer, NFA_HCI_RSP_TIMEOUT_EVT,
                         p_nfa_hci_cfg->hcp_response_timeout);
   }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_send_msg
+**
+** Description      This function will fragment the given packet, if necessary
+**                  and send it on the given pipe.
+**
+** Returns          status
+**
+*******************************************************************************/
+tNFA_STATUS nfa_hciu_send_msg(uint8_t pipe_id, uint8_t type,
+                              uint8_t instruction, uint16_t msg_len,
+                              uint8_t* p_msg) {
+  tNFA_STATUS status;
+  if (nfa_hci_cb.buff_size <= (NCI_DATA_HDR_SIZE + 2)) {
+    android_errorWriteLog(0x534e4554, "124521372");
+    return NFA_STATUS_NO_BUFFERS;
+  }
+  const uint8_t MAX_BUFF_SIZE = 100;
+  char buff[MAX_BUFF_SIZE];
+
+  LOG(VERBOSE) << StringPrintf(
+      "nfa_hciu_send_msg pipe_id:%d   %s  len:%d", pipe_id,
+      nfa_hciu_get_type_inst_names(pipe_id, type, instruction, buff,
+                                   MAX_BUFF_SIZE),
+      msg_len);
+
+  if (instruction == NFA_HCI_ANY_GET_PARAMETER)
+    nfa_hci_cb.param_in_use = *p_msg;
+
+  status = nfa_hciu_send_frags(pipe_id, type, instruction, msg_len, p_msg);
+
+  nfa_hciu_msg_sent(pipe_id, type, instruction, (msg_len) ? *p_msg : 0,
+                    status);
 
   return status;
 }
@@ -416,6 +510,156 @@ uint8_t nfa_hciu_get_allocated_gate_list(uint8_t* p_gate_list) {
   return (count);
 }
 
+/*******************************************************************************
+**
+** Function         nfa_hciu_rebuild_lookup
+**
+** Description      Rebuild the pipe and gate lookup tables from the pipe and
+**                  gate control blocks, e.g. after they were restored from NV
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_hciu_rebuild_lookup(void) {
+  int xx;
+
+  memset(nfa_hci_cb.pipe_lookup, 0, sizeof(nfa_hci_cb.pipe_lookup));
+  memset(nfa_hci_cb.gate_lookup, 0, sizeof(nfa_hci_cb.gate_lookup));
+
+  for (xx = 0; xx < NFA_HCI_MAX_PIPE_CB; xx++) {
+    uint8_t pipe_id = nfa_hci_cb.cfg.dyn_pipes[xx].pipe_id;
+
+    /* First control block wins, as with the linear search */
+    if ((pipe_id != 0) && (pipe_id <= NFA_HCI_MAX_PIPE_ID) &&
+        (nfa_hci_cb.pipe_lookup[pipe_id] == 0))
+      nfa_hci_cb.pipe_lookup[pipe_id] = xx + 1;
+  }
+
+  for (xx = 0; xx < NFA_HCI_MAX_GATE_CB; xx++) {
+    uint8_t gate_id = nfa_hci_cb.cfg.dyn_gates[xx].gate_id;
+
+    if ((gate_id != 0) && (nfa_hci_cb.gate_lookup[gate_id] == 0))
+      nfa_hci_cb.gate_lookup[gate_id] = xx + 1;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_find_pipe_cmd
+**
+** Description      Find the command outstanding on the given pipe
+**
+** Returns          pointer to the pipe command state, or NULL if no command
+**                  is outstanding on the pipe
+**
+*******************************************************************************/
+tNFA_HCI_PIPE_CMD* nfa_hciu_find_pipe_cmd(uint8_t pipe_id) {
+  uint8_t xx;
+
+  if ((pipe_id < NFA_HCI_FIRST_DYNAMIC_PIPE) || (pipe_id > NFA_HCI_MAX_PIPE_ID))
+    return (nullptr);
+
+  xx = nfa_hci_cb.pipe_lookup[pipe_id];
+  if ((xx == 0) || (!nfa_hci_cb.pipe_cmd[xx - 1].in_use)) return (nullptr);
+
+  return (&nfa_hci_cb.pipe_cmd[xx - 1]);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_pipe_cmd_done
+**
+** Description      The command outstanding on a pipe got its response or is
+**                  given up, stop its timer
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_hciu_pipe_cmd_done(tNFA_HCI_PIPE_CMD* p_cmd) {
+  nfa_sys_stop_timer(&p_cmd->timer);
+  p_cmd->in_use = false;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_send_pipe_cmd_failed
+**
+** Description      Tell the application that the command it asked for on a
+**                  pipe gets no response, with the event it waits for
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_hciu_send_pipe_cmd_failed(uint8_t pipe_id, tNFA_HCI_COMMAND cmd,
+                                   uint8_t param, tNFA_HANDLE app_handle) {
+  tNFA_HCI_EVT evt;
+  tNFA_HCI_EVT_DATA evt_data;
+
+  evt_data.status = NFA_STATUS_FAILED;
+  switch (cmd) {
+    case NFA_HCI_ANY_SET_PARAMETER:
+    case NFA_HCI_ANY_GET_PARAMETER:
+      evt_data.registry.pipe = pipe_id;
+      evt_data.registry.data_len = 0;
+      evt_data.registry.index = param;
+      evt = (cmd == NFA_HCI_ANY_SET_PARAMETER) ? NFA_HCI_SET_REG_RSP_EVT
+                                               : NFA_HCI_GET_REG_RSP_EVT;
+      break;
+
+    case NFA_HCI_ANY_OPEN_PIPE:
+      evt_data.opened.pipe = pipe_id;
+      evt = NFA_HCI_OPEN_PIPE_EVT;
+      break;
+
+    case NFA_HCI_ANY_CLOSE_PIPE:
+      evt_data.closed.pipe = pipe_id;
+      evt = NFA_HCI_CLOSE_PIPE_EVT;
+      break;
+
+    default:
+      /* Application specific command */
+      evt_data.rsp_rcvd.pipe = pipe_id;
+      evt_data.rsp_rcvd.rsp_code = NFA_HCI_ANY_E_TIMEOUT;
+      evt_data.rsp_rcvd.rsp_len = 0;
+      evt = NFA_HCI_RSP_RCVD_EVT;
+      break;
+  }
+  nfa_hciu_send_to_app(evt, &evt_data, app_handle);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_pipe_cmd_failed
+**
+** Description      Give up the command outstanding on a pipe and tell the
+**                  application which sent it
+**
+** Returns          None
+**
+*******************************************************************************/
+void nfa_hciu_pipe_cmd_failed(uint8_t pipe_id, tNFA_HCI_PIPE_CMD* p_cmd) {
+  nfa_hciu_pipe_cmd_done(p_cmd);
+  nfa_hciu_send_pipe_cmd_failed(pipe_id, p_cmd->cmd_sent, p_cmd->param_in_use,
+                                p_cmd->app_handle);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_hciu_fail_pipe_cmds
+**
+** Description      A pipe is released, fail the command outstanding on it and
+**                  the API requests waiting for it
+**
+** Returns          None
+**
+*******************************************************************************/
+static void nfa_hciu_fail_pipe_cmds(uint8_t pipe_id, uint8_t pipe_index) {
+  tNFA_HCI_PIPE_CMD* p_cmd = &nfa_hci_cb.pipe_cmd[pipe_index];
+
+  if (p_cmd->in_use) nfa_hciu_pipe_cmd_failed(pipe_id, p_cmd);
+  nfa_hci_flush_pipe_cmd_q(pipe_id);
+}
+
 /*******************************************************************************
 **
 ** Function         nfa_hciu_alloc_pipe
@@ -444,6 +688,8 @@ tNFA_HCI_DYN_PIPE* nfa_hciu_alloc_pipe(uint8_t pipe_id) {
       LOG(VERBOSE) << StringPrintf("nfa_hciu_alloc_pipe:%d, index:%d", pipe_id,
                                  xx);
       pp->pipe_id = pipe_id;
+      if (pipe_id <= NFA_HCI_MAX_PIPE_ID)
+        nfa_hci_cb.pipe_lookup[pipe_id] = xx + 1;
 
       nfa_hci_cb.nv_write_needed = true;
       return (pp);
@@ -472,6 +718,7 @@ void nfa_hciu_release_gate(uint8_t gate_id) {
                                gate_id, p_gate->gate_owner,
                                p_gate->pipe_inx_mask);
 
+    nfa_hci_cb.gate_lookup[gate_id] = 0;
     p_gate->gate_id = 0;
     p_gate->gate_owner = 0;
     p_gate->pipe_inx_mask = 0;
@@ -832,7 +1079,9 @@ tNFA_HCI_RESPONSE nfa_hciu_release_pipe(uint8_t pipe_id) {
     p_gate = nfa_hciu_find_gate_by_gid(p_pipe->local_gate);
     if (p_gate == nullptr) {
       /* Mark the pipe control block as free */
+      nfa_hci_cb.pipe_lookup[pipe_id] = 0;
       p_pipe->pipe_id = 0;
+      nfa_hciu_fail_pipe_cmds(pipe_id, pipe_index);
       return (NFA_HCI_ANY_E_NOK);
     }
 
@@ -841,8 +1090,10 @@ tNFA_HCI_RESPONSE nfa_hciu_release_pipe(uint8_t pipe_id) {
   }
 
   /* Reset pipe control block */
+  nfa_hci_cb.pipe_lookup[pipe_id] = 0;
   memset(p_pipe, 0, sizeof(tNFA_HCI_DYN_PIPE));
   nfa_hci_cb.nv_write_needed = true;
+  nfa_hciu_fail_pipe_cmds(pipe_id, pipe_index);
   return NFA_HCI_ANY_OK;
 }
 
@@ -1265,6 +1516,8 @@ std::string nfa_hciu_get_event_name(uint16_t event) {
       return "NV_WRITE_EVT";
     case NFA_HCI_RSP_TIMEOUT_EVT:
       return "RESPONSE_TIMEOUT_EVT";
+    case NFA_HCI_PIPE_RSP_TIMEOUT_EVT:
+      return "PIPE_RESPONSE_TIMEOUT_EVT";
     case NFA_HCI_CHECK_QUEUE_EVT:
       return "CHECK_QUEUE";
     default:
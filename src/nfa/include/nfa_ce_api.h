@@ -31,6 +31,13 @@
 **  Constants and data types
 *****************************************************************************/
 
+/* Callback for C-APDUs of an AID registered with NFA_CeSetApduCback.
+ * status is NFA_STATUS_CONTINUE if more data of the C-APDU follows, as for
+ * NFA_CE_DATA_EVT, NFA_STATUS_OK for the last (or only) part.
+ * p_apdu is only valid until the callback returns. */
+typedef void(tNFA_CE_APDU_CBACK)(tNFA_HANDLE handle, tNFA_STATUS status,
+                                 uint8_t* p_apdu, uint16_t apdu_len);
+
 /*****************************************************************************
 **  External Function Declarations
 *****************************************************************************/
@@ -229,4 +236,48 @@ extern tNFA_STATUS NFA_CeDeregisterAidOnDH(tNFA_HANDLE handle);
 *******************************************************************************/
 extern tNFA_STATUS NFA_CeSetIsoDepListenTech(tNFA_TECHNOLOGY_MASK tech_mask);
 
+/*******************************************************************************
+**
+** Function         NFA_CeSetApduCback
+**
+** Description      Opt in to direct delivery of C-APDUs for an ISODEP AID
+**                  registered using NFA_CeRegisterAidOnDH.
+**
+**                  C-APDUs are passed to p_apdu_cback in NFC task context
+**                  instead of NFA_CE_DATA_EVT. Activation and deactivation
+**                  are still reported to the tNFA_CONN_CBACK of the AID.
+**                  Set p_apdu_cback to NULL to return to NFA_CE_DATA_EVT.
+**
+**                  The R-APDU is sent using NFA_CeSendApduRsp.
+**
+** Returns:
+**                  NFA_STATUS_OK, if command accepted
+**                  NFA_STATUS_BAD_HANDLE if invalid handle
+**                  NFA_STATUS_FAILED: otherwise
+**
+*******************************************************************************/
+extern tNFA_STATUS NFA_CeSetApduCback(tNFA_HANDLE handle,
+                                      tNFA_CE_APDU_CBACK* p_apdu_cback);
+
+/*******************************************************************************
+**
+** Function         NFA_CeSendApduRsp
+**
+** Description      Send R-APDU for the C-APDU received by the AID callback.
+**
+**                  If called from tNFA_CE_APDU_CBACK, the R-APDU is queued to
+**                  the RF connection right away. Otherwise, this is the same
+**                  as NFA_SendRawFrame.
+**
+**                  p_rsp is copied into a GKI buffer in both cases and may be
+**                  reused as soon as this function returns.
+**
+** Returns:
+**                  NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_INVALID_PARAM if invalid parameter
+**                  NFA_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+extern tNFA_STATUS NFA_CeSendApduRsp(uint8_t* p_rsp, uint16_t rsp_len);
+
 #endif /* NFA_CE_API_H */
@@ -42,7 +42,8 @@ enum {
   NFA_CE_API_DEREG_LISTEN_EVT,
   NFA_CE_API_CFG_ISODEP_TECH_EVT,
   NFA_CE_ACTIVATE_NTF_EVT,
-  NFA_CE_DEACTIVATE_NTF_EVT
+  NFA_CE_DEACTIVATE_NTF_EVT,
+  NFA_CE_API_SET_APDU_CBACK_EVT
 
 };
 
@@ -96,6 +97,13 @@ typedef struct {
   uint32_t listen_info;
 } tNFA_CE_API_DEREG_LISTEN;
 
+/* data type for NFA_CE_API_SET_APDU_CBACK_EVT */
+typedef struct {
+  NFC_HDR hdr;
+  tNFA_HANDLE handle;
+  tNFA_CE_APDU_CBACK* p_apdu_cback;
+} tNFA_CE_API_SET_APDU_CBACK;
+
 /* union of all data types */
 typedef union {
   /* GKI event buffer header */
@@ -104,6 +112,7 @@ typedef union {
   tNFA_CE_API_REG_LISTEN reg_listen;
   tNFA_CE_API_DEREG_LISTEN dereg_listen;
   tNFA_CE_ACTIVATE_NTF activate_ntf;
+  tNFA_CE_API_SET_APDU_CBACK set_apdu_cback;
 } tNFA_CE_MSG;
 
 /****************************************************************************
@@ -146,6 +155,7 @@ typedef struct {
   uint16_t t3t_system_code; /* Type-3 system code */
   uint8_t
       t4t_aid_handle; /* Type-4 aid callback handle (from CE_T4tRegisterAID) */
+  tNFA_CE_APDU_CBACK* p_apdu_cback; /* direct C-APDU callback (optional) */
 
   /* For UICC */
   tNFA_HANDLE ee_handle;
@@ -202,6 +212,7 @@ bool nfa_ce_api_dereg_listen(tNFA_CE_MSG* p_ce_msg);
 bool nfa_ce_api_cfg_isodep_tech(tNFA_CE_MSG* p_ce_msg);
 bool nfa_ce_activate_ntf(tNFA_CE_MSG* p_ce_msg);
 bool nfa_ce_deactivate_ntf(tNFA_CE_MSG* p_ce_msg);
+bool nfa_ce_api_set_apdu_cback(tNFA_CE_MSG* p_ce_msg);
 
 /* Internal function prototypes */
 void nfa_ce_t3t_generate_rand_nfcid(uint8_t nfcid2[NCI_RF_F_UID_LEN]);
@@ -69,7 +69,9 @@ enum {
   NFA_EE_DISCOVER_REQ_EVT, /* NFCEE Discover Request Notification */
   NFA_EE_PWR_AND_LINK_CTRL_EVT, /* NFCEE power and link ctrl */
   NFA_EE_NO_MEM_ERR_EVT,   /* Error - out of GKI buffers */
-  NFA_EE_NO_CB_ERR_EVT /* Error - Can not find control block or wrong state */
+  NFA_EE_NO_CB_ERR_EVT, /* Error - Can not find control block or wrong state */
+  NFA_EE_ADD_AID_BULK_EVT,   /* The status for NFA_EeAddAidRoutingBulk ()    */
+  NFA_EE_REMOVE_AID_BULK_EVT /* The status for NFA_EeRemoveAidRoutingBulk () */
 };
 typedef uint8_t tNFA_EE_EVT;
 
@@ -93,6 +95,16 @@ typedef uint8_t tNFA_EE_MD;
 #define NFA_EE_PWR_STATE_BATT_OFF 0x04
 typedef uint8_t tNFA_EE_PWR_STATE;
 
+/* AID routing entry for NFA_EeAddAidRoutingBulk ()/NFA_EeRemoveAidRoutingBulk
+ * (), ee_handle, power_state and aidInfo are ignored on removal */
+typedef struct {
+  tNFA_HANDLE ee_handle;         /* NFCEE the AID is routed to */
+  uint8_t aid_len;               /* Length of the AID          */
+  uint8_t* p_aid;                /* The AID                    */
+  tNFA_EE_PWR_STATE power_state; /* Power states of the route  */
+  uint8_t aidInfo;               /* Prefix/subset match info   */
+} tNFA_EE_AID_ROUTE;
+
 /* NFCEE connected and inactive */
 #define NFA_EE_STATUS_INACTIVE NFC_NFCEE_STATUS_INACTIVE
 /* NFCEE connected and active   */
@@ -184,8 +196,28 @@ typedef struct {
   tNFA_HANDLE handle; /* Connection handle */
   uint16_t len;       /* Length of data    */
   uint8_t* p_buf;     /* Data buffer       */
+  uint16_t seq; /* APDU interface: sequence number of the C-APDU answered */
 } tNFA_EE_DATA;
 
+/* C-APDU for NFA_EeSendApdus () */
+typedef struct {
+  uint16_t len;    /* Length of the C-APDU */
+  uint8_t* p_data; /* The C-APDU           */
+} tNFA_EE_APDU;
+
+/* Data for NFA_EE_NO_CB_ERR_EVT, if C-APDUs could not be sent */
+typedef struct {
+  tNFA_STATUS status; /* NFA_STATUS_FAILED                       */
+  uint16_t seq;       /* seq of the first C-APDU not sent        */
+  uint16_t num_apdu;  /* Number of C-APDUs not sent, from seq on */
+} tNFA_EE_APDU_ERR;
+
+/* Data for NFA_EE_ADD_AID_BULK_EVT and NFA_EE_REMOVE_AID_BULK_EVT */
+typedef struct {
+  tNFA_STATUS status; /* Status of the first AID failed, if any */
+  uint16_t num_done;  /* Number of AIDs added or removed        */
+} tNFA_EE_AID_BULK;
+
 /* Union of all EE callback structures */
 typedef union {
   tNFA_STATUS
@@ -209,6 +241,8 @@ typedef union {
   tNFA_EE_MODE_SET mode_set;
   tNFA_EE_INFO new_ee;
   tNFA_EE_DISCOVER_REQ discover_req;
+  tNFA_EE_AID_BULK aid_bulk;
+  tNFA_EE_APDU_ERR apdu_err;
 } tNFA_EE_CBACK_DATA;
 
 /* EE callback */
@@ -448,6 +482,53 @@ extern tNFA_STATUS NFA_EeAddAidRouting(tNFA_HANDLE ee_handle, uint8_t aid_len,
 *******************************************************************************/
 extern tNFA_STATUS NFA_EeRemoveAidRouting(uint8_t aid_len, uint8_t* p_aid);
 
+/*******************************************************************************
+**
+** Function         NFA_EeAddAidRoutingBulk
+**
+** Description      This function is called to add num_aid AID entries in the
+**                  listen mode routing table in NFCC at once. All entries are
+**                  validated before any is added. The status of this operation
+**                  is reported as the NFA_EE_ADD_AID_BULK_EVT.
+**
+** Note:            If RF discovery is started,
+**                  NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT should
+**                  happen before calling this function
+**
+** Note:            NFA_EeUpdateNow() should be called after last NFA-EE
+**                  function to change the listen mode routing is called.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+extern tNFA_STATUS NFA_EeAddAidRoutingBulk(uint16_t num_aid,
+                                           tNFA_EE_AID_ROUTE* p_aid_route);
+
+/*******************************************************************************
+**
+** Function         NFA_EeRemoveAidRoutingBulk
+**
+** Description      This function is called to remove num_aid AID entries from
+**                  the listen mode routing table at once. The status of this
+**                  operation is reported as the NFA_EE_REMOVE_AID_BULK_EVT.
+**
+** Note:            If RF discovery is started,
+**                  NFA_StopRfDiscovery()/NFA_RF_DISCOVERY_STOPPED_EVT should
+**                  happen before calling this function
+**
+** Note:            NFA_EeUpdateNow() should be called after last NFA-EE
+**                  function to change the listen mode routing is called.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+extern tNFA_STATUS NFA_EeRemoveAidRoutingBulk(uint16_t num_aid,
+                                              tNFA_EE_AID_ROUTE* p_aid_route);
+
 /*******************************************************************************
  **
  ** Function         NFA_EeAddSystemCodeRouting
@@ -573,6 +654,32 @@ extern tNFA_STATUS NFA_EeConnect(tNFA_HANDLE ee_handle, uint8_t ee_interface,
 extern tNFA_STATUS NFA_EeSendData(tNFA_HANDLE ee_handle, uint16_t data_len,
                                   uint8_t* p_data);
 
+/*******************************************************************************
+**
+** Function         NFA_EeSendApdus
+**
+** Description      Send num_apdu C-APDUs to the given NFCEE over its APDU
+**                  interface connection. The C-APDUs are kept in flight as
+**                  far as the connection allows, the R-APDUs are reported in
+**                  order as NFA_EE_DATA_EVT. The seq of an NFA_EE_DATA_EVT
+**                  counts the C-APDUs sent since NFA_EE_CONNECT_EVT, starting
+**                  at 0, including those sent by NFA_EeSendData().
+**                  Up to NFA_EE_MAX_APDU_IN_FLIGHT (config) C-APDUs are in
+**                  flight, 1 by default. If a C-APDU cannot be sent, it and
+**                  the C-APDUs queued after it are dropped and reported in
+**                  apdu_err of NFA_EE_NO_CB_ERR_EVT.
+**                  This function shall be called after NFA_EE_CONNECT_EVT is
+**                  reported and before NFA_EeDisconnect is called on the given
+**                  ee_handle.
+**
+** Returns          NFA_STATUS_OK if successfully initiated
+**                  NFA_STATUS_FAILED otherwise
+**                  NFA_STATUS_INVALID_PARAM If bad parameter
+**
+*******************************************************************************/
+extern tNFA_STATUS NFA_EeSendApdus(tNFA_HANDLE ee_handle, uint16_t num_apdu,
+                                   tNFA_EE_APDU* p_apdu);
+
 /*******************************************************************************
 **
 ** Function         NFA_EeDisconnect
@@ -55,12 +55,15 @@ enum {
   NFA_EE_API_CLEAR_PROTO_CFG_EVT,
   NFA_EE_API_ADD_AID_EVT,
   NFA_EE_API_REMOVE_AID_EVT,
+  NFA_EE_API_ADD_AID_BULK_EVT,
+  NFA_EE_API_REMOVE_AID_BULK_EVT,
   NFA_EE_API_ADD_SYSCODE_EVT,
   NFA_EE_API_REMOVE_SYSCODE_EVT,
   NFA_EE_API_LMRT_SIZE_EVT,
   NFA_EE_API_UPDATE_NOW_EVT,
   NFA_EE_API_CONNECT_EVT,
   NFA_EE_API_SEND_DATA_EVT,
+  NFA_EE_API_SEND_APDUS_EVT,
   NFA_EE_API_DISCONNECT_EVT,
   NFA_EE_API_PWR_AND_LINK_CTRL_EVT,
 
@@ -85,6 +88,12 @@ typedef uint16_t tNFA_EE_INT_EVT;
 /* for listen mode routing table*/
 #define NFA_EE_AE_ROUTE 0x80
 #define NFA_EE_AE_VS 0x40
+/* entry is removed, its room is reclaimed when the LMRT is built */
+#define NFA_EE_AE_REMOVED 0x20
+/* a prefix entry to the same NFCEE matches the AID, no LMRT entry needed */
+#define NFA_EE_AE_COVERED 0x10
+/* an AID routed elsewhere overlaps the AID, used while compiling the LMRT */
+#define NFA_EE_AE_OVERLAP 0x08
 
 /* NFA EE Management state */
 enum {
@@ -143,6 +152,14 @@ typedef uint8_t tNFA_EE_CONN_ST;
 #define NFA_EE_ECB_FLAGS_ORDER 0x80
 typedef uint8_t tNFA_EE_ECB_FLAGS;
 
+/* NFCEE mode set state of an ECB */
+/* no mode set pending                        */
+#define NFA_EE_MODE_SET_ST_IDLE 0
+/* queued; another mode set waits for its NTF */
+#define NFA_EE_MODE_SET_ST_QUEUED 1
+/* sent; waiting for the result from NFCC     */
+#define NFA_EE_MODE_SET_ST_SENT 2
+
 /* part of tNFA_EE_STATUS; for internal use only  */
 /* waiting for restore to full power mode to complete */
 #define NFA_EE_STATUS_RESTORING 0x20
@@ -179,6 +196,10 @@ typedef struct {
       proto_screen_off_lock; /* default routing - protocols screen_off_lock  */
   tNFA_EE_CONN_ST conn_st;   /* connection status */
   uint8_t conn_id;           /* connection id */
+  BUFFER_Q apdu_q;           /* C-APDUs waiting for room in flight */
+  uint8_t apdu_in_flight;    /* C-APDUs sent, R-APDU not received  */
+  uint16_t apdu_tx_seq;      /* seq of the next C-APDU sent        */
+  uint16_t apdu_rx_seq;      /* seq of the next R-APDU received    */
   tNFA_EE_CBACK* p_ee_cback; /* the callback function */
 
   /* Each AID entry has an ssociated aid_len, aid_pwr_cfg, aid_rt_info.
@@ -187,6 +208,8 @@ typedef struct {
    * length
    * the aid_len is the total length of all the TLVs associated with this AID
    * entry
+   * The arrays share one buffer, which is allocated with the first AID and
+   * grows on demand up to nfa_ee_cb.aid_max_entries/aid_max_cfg_len
    */
   uint8_t* aid_len;     /* the actual lengths in aid_cfg */
   uint8_t* aid_pwr_cfg; /* power configuration of this
@@ -196,7 +219,10 @@ typedef struct {
   uint8_t* aid_cfg;     /* routing entries based on AID */
   uint8_t* aid_info;    /* Aid Info Prefix/Suffix/Exact */
 
-  uint8_t aid_entries;   /* The number of AID entries in aid_cfg */
+  uint16_t aid_entries;       /* The number of AID entries in aid_cfg */
+  uint16_t aid_rm_entries;    /* The number of removed entries in aid_cfg */
+  uint16_t aid_alloc_entries; /* The room for entries in aid_len, ... */
+  uint16_t aid_alloc_cfg_len; /* The room in aid_cfg */
   uint8_t nfcee_id;      /* ID for this NFCEE */
   uint8_t ee_status;     /* The NFCEE status */
   uint8_t ee_old_status; /* The NFCEE status before going to low power mode */
@@ -207,6 +233,9 @@ typedef struct {
   uint8_t num_tlvs;                       /* number of TLVs */
   uint8_t ee_power_supply_status;         /* power supply of NFCEE*/
   tNFA_EE_ECB_FLAGS ecb_flags;            /* the flags of this control block */
+  uint8_t mode_set_st;                    /* NFA_EE_MODE_SET_ST_*  */
+  tNFC_NFCEE_MODE mode_set_mode;          /* mode of queued mode set */
+  uint32_t mode_set_tick;                 /* tick mode set requested */
   tNFA_EE_INTERFACE use_interface; /* NFCEE interface used for the connection */
   tNFA_NFC_PROTOCOL la_protocol;   /* Listen A protocol    */
   tNFA_NFC_PROTOCOL lb_protocol;   /* Listen B protocol    */
@@ -303,6 +332,14 @@ typedef struct {
   uint8_t* p_aid;
 } tNFA_EE_API_REMOVE_AID;
 
+/* data type for NFA_EE_API_ADD_AID_BULK_EVT and
+ * NFA_EE_API_REMOVE_AID_BULK_EVT, the entries and AIDs follow the header */
+typedef struct {
+  NFC_HDR hdr;
+  uint16_t num_aid;
+  tNFA_EE_AID_ROUTE* p_aid_route;
+} tNFA_EE_API_AID_BULK;
+
 /* data type for NFA_EE_API_ADD_SYSCODE_EVT */
 typedef struct {
   NFC_HDR hdr;
@@ -339,6 +376,13 @@ typedef struct {
   uint8_t* p_data;
 } tNFA_EE_API_SEND_DATA;
 
+/* data type for NFA_EE_API_SEND_APDUS_EVT */
+typedef struct {
+  NFC_HDR hdr;
+  tNFA_EE_ECB* p_cb;
+  BUFFER_Q apdu_q; /* NCI data packets of the C-APDUs */
+} tNFA_EE_API_SEND_APDUS;
+
 /* data type for NFA_EE_API_DISCONNECT_EVT */
 typedef struct {
   NFC_HDR hdr;
@@ -432,11 +476,13 @@ typedef union {
   tNFA_EE_API_CLEAR_PROTO_CFG clear_proto;
   tNFA_EE_API_ADD_AID add_aid;
   tNFA_EE_API_REMOVE_AID rm_aid;
+  tNFA_EE_API_AID_BULK aid_bulk;
   tNFA_EE_API_ADD_SYSCODE add_syscode;
   tNFA_EE_API_REMOVE_SYSCODE rm_syscode;
   tNFA_EE_API_LMRT_SIZE lmrt_size;
   tNFA_EE_API_CONNECT connect;
   tNFA_EE_API_SEND_DATA send_data;
+  tNFA_EE_API_SEND_APDUS send_apdus;
   tNFA_EE_API_DISCONNECT disconnect;
   tNFA_EE_API_PWR_AND_LINK_CTRL pwr_and_link_ctrl;
   tNFA_EE_NCI_DISC_RSP disc_rsp;
@@ -500,6 +546,16 @@ typedef uint8_t tNFA_EE_DISC_STS;
 
 typedef void(tNFA_EE_ENABLE_DONE_CBACK)(tNFA_EE_DISC_STS status);
 
+/* Unused slot in the AID index */
+#define NFA_EE_AID_IDX_FREE 0xFF
+
+/* AID index slot: locates an AID entry in the ECB it is routed to */
+typedef struct {
+  uint8_t ecb_idx; /* index in nfa_ee_cb.ecb[] or NFA_EE_AID_IDX_FREE */
+  uint16_t entry;  /* index in aid_len[], aid_pwr_cfg[], ... */
+  uint16_t offset; /* offset of the AID TLV in aid_cfg[] */
+} tNFA_EE_AID_IDX;
+
 /* NFA EE Management control block */
 typedef struct {
   tNFA_EE_ECB ecb[NFA_EE_NUM_ECBS]; /* control block for DH and NFCEEs  */
@@ -519,6 +575,18 @@ typedef struct {
   tNFA_EE_FLAGS ee_flags;      /* flags                            */
   uint8_t route_block_control; /* controls route block feature   */
   bool isDiscoveryStopped;     /* discovery status                  */
+  tNFA_EE_AID_IDX* aid_idx;    /* hash index of all AID entries     */
+  uint16_t aid_idx_size;       /* number of slots in aid_idx        */
+  uint16_t aid_idx_count;      /* number of used slots in aid_idx   */
+  uint16_t aid_max_entries;    /* max AID entries of DH/an NFCEE    */
+  uint16_t aid_max_cfg_len;    /* max aid_cfg length of DH/an NFCEE */
+  bool lmrt_sent_valid;        /* NFCC accepted the LMRT last sent  */
+  bool aid_compact;            /* leave covered AIDs out of LMRT    */
+  uint16_t aid_saved;          /* LMRT size saved by covered AIDs   */
+  bool aid_saved_stale;        /* coverage may be lost since compile*/
+  uint8_t apdu_max_in_flight;  /* max C-APDUs in flight on an NFCEE */
+  uint8_t num_mode_set;        /* num of mode sets queued or sent   */
+  uint32_t mode_set_tick;      /* tick first pending mode set req'd */
 } tNFA_EE_CB;
 
 /* Order of Routing entries in Routing Table */
@@ -565,12 +633,15 @@ void nfa_ee_api_set_proto_cfg(tNFA_EE_MSG* p_data);
 void nfa_ee_api_clear_proto_cfg(tNFA_EE_MSG* p_data);
 void nfa_ee_api_add_aid(tNFA_EE_MSG* p_data);
 void nfa_ee_api_remove_aid(tNFA_EE_MSG* p_data);
+void nfa_ee_api_add_aid_bulk(tNFA_EE_MSG* p_data);
+void nfa_ee_api_remove_aid_bulk(tNFA_EE_MSG* p_data);
 void nfa_ee_api_add_sys_code(tNFA_EE_MSG* p_data);
 void nfa_ee_api_remove_sys_code(tNFA_EE_MSG* p_data);
 void nfa_ee_api_lmrt_size(tNFA_EE_MSG* p_data);
 void nfa_ee_api_update_now(tNFA_EE_MSG* p_data);
 void nfa_ee_api_connect(tNFA_EE_MSG* p_data);
 void nfa_ee_api_send_data(tNFA_EE_MSG* p_data);
+void nfa_ee_api_send_apdus(tNFA_EE_MSG* p_data);
 void nfa_ee_api_disconnect(tNFA_EE_MSG* p_data);
 void nfa_ee_api_pwr_and_link_ctrl(tNFA_EE_MSG* p_data);
 void nfa_ee_report_disc_done(bool notify_sys);
@@ -595,6 +666,7 @@ tNFA_EE_ECB* nfa_ee_find_sys_code_offset(uint16_t sys_code, int* p_offset,
                                          int* p_entry);
 int nfa_ee_find_total_aid_len(tNFA_EE_ECB* p_cb, int start_entry);
 void nfa_ee_start_timer(void);
+tNFC_STATUS nfa_ee_mode_set(tNFA_EE_ECB* p_cb, tNFC_NFCEE_MODE mode);
 void nfa_ee_reg_cback_enable_done(tNFA_EE_ENABLE_DONE_CBACK* p_cback);
 void nfa_ee_report_update_evt(void);
 
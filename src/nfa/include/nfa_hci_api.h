@@ -496,7 +496,7 @@ extern tNFA_STATUS NFA_HciSendCommand(tNFA_HANDLE hci_handle, uint8_t pipe,
 **                  provide response buffer for collecting the response. If it
 **                  provides a response buffer it should also provide response
 **                  timeout indicating duration validity of the response buffer.
-**                  Maximum of NFA_MAX_HCI_EVENT_LEN bytes APDU can be received
+**                  Maximum of NFA_HCI_MAX_MSG_LEN bytes APDU can be received
 **                  using internal buffer if no response buffer is provided by
 **                  the application. The app will be notified by
 **                  NFA_HCI_EVENT_RCVD_EVT after receiving the response event
@@ -47,6 +47,17 @@ extern uint8_t HCI_LOOPBACK_DEBUG;
 
 #define NFA_HCI_SESSION_ID_LEN 8 /* HCI Session ID length */
 
+#define NFA_HCI_MAX_PIPE_ID 0x7F /* Pipe ID is 7 bits in the HCP header */
+#define NFA_HCI_MAX_GATE_ID 0xFF
+
+/* pipe_inx_mask of a gate has one bit per pipe control block */
+#if (NFA_HCI_MAX_PIPE_CB > 32)
+#error NFA_HCI_MAX_PIPE_CB must not exceed 32
+#endif
+#if (NFA_HCI_MAX_GATE_CB > 0xFE)
+#error NFA_HCI_MAX_GATE_CB must not exceed 254
+#endif
+
 /* HCI SW Version number                       */
 #define NFA_HCI_VERSION_SW 0x090000
 /* HCI HW Version number                       */
@@ -113,6 +124,7 @@ enum {
   NFA_HCI_RSP_NV_READ_EVT,  /* Non volatile read complete event */
   NFA_HCI_RSP_NV_WRITE_EVT, /* Non volatile write complete event */
   NFA_HCI_RSP_TIMEOUT_EVT,  /* Timeout to response for the HCP Command packet */
+  NFA_HCI_PIPE_RSP_TIMEOUT_EVT, /* Timeout to response for a pipe command */
   NFA_HCI_CHECK_QUEUE_EVT
 };
 
@@ -336,6 +348,17 @@ typedef struct {
   uint32_t pipe_inx_mask; /* Bit 0 == pipe inx 0, etc */
 } tNFA_HCI_DYN_GATE;
 
+/* Command outstanding on a dynamic pipe of a generic gate. The HCI allows
+ * one outstanding command per pipe, so pipes are not serialized with each
+ * other, only with the admin commands of the HCI state machine. */
+typedef struct {
+  TIMER_LIST_ENT timer;      /* Timer for the response to the command */
+  bool in_use;               /* Command sent, waiting for its response */
+  tNFA_HCI_COMMAND cmd_sent; /* The command sent on the pipe */
+  tNFA_HANDLE app_handle;    /* Application that sent the command */
+  uint8_t param_in_use;      /* Registry parameter of GET/SET PARAMETER */
+} tNFA_HCI_PIPE_CMD;
+
 /* Admin gate control block */
 typedef struct {
   tNFA_HCI_PIPE_STATE pipe01_state; /* State of Pipe '01' */
@@ -395,23 +418,32 @@ typedef struct {
   tNFA_HCI_COMMAND cmd_sent; /* The last command sent */
   bool ee_disc_cmplt;        /* EE Discovery operation completed */
   bool ee_disable_disc;      /* EE Discovery operation is disabled */
+  uint32_t startup_tick;     /* OS tick HCI (re)initialization started at */
   uint16_t msg_len;     /* For segmentation - length of the combined message */
   uint16_t max_msg_len; /* Maximum reassembled message size */
   uint8_t msg_data[NFA_MAX_HCI_EVENT_LEN]; /* For segmentation - the combined
                                               message data */
   uint8_t* p_msg_data; /* For segmentation - reassembled message */
+  uint8_t* p_assembly_buf; /* GKI buffer replacing msg_data once it overflows */
+  uint16_t max_assembly_len; /* Max size p_assembly_buf may grow to */
   uint8_t type;        /* Instruction type of incoming message */
   uint8_t inst;        /* Instruction of incoming message */
 
   BUFFER_Q hci_api_q;            /* Buffer Q to hold incoming API commands */
   BUFFER_Q hci_host_reset_api_q; /* Buffer Q to hold incoming API commands to a
                                     host that is reactivating */
+  BUFFER_Q pipe_cmd_q; /* API commands waiting for a command on their pipe */
+  /* Command state of each pipe, same index as cfg.dyn_pipes */
+  tNFA_HCI_PIPE_CMD pipe_cmd[NFA_HCI_MAX_PIPE_CB];
   tNFA_HCI_CBACK* p_app_cback[NFA_HCI_MAX_APP_CB]; /* Callback functions
                                                       registered by the
                                                       applications */
   uint16_t rsp_buf_size; /* Maximum size of APDU buffer */
   uint8_t* p_rsp_buf;    /* Buffer to hold response to sent event */
-  struct                 /* Persistent information for Device Host */
+  /* Index + 1 into cfg.dyn_pipes/cfg.dyn_gates by ID, 0 if not allocated */
+  uint8_t pipe_lookup[NFA_HCI_MAX_PIPE_ID + 1];
+  uint8_t gate_lookup[NFA_HCI_MAX_GATE_ID + 1];
+  struct /* Persistent information for Device Host */
   {
     char reg_app_names[NFA_HCI_MAX_APP_CB][NFA_MAX_HCI_APP_NAME_LEN + 1];
 
@@ -451,6 +483,7 @@ extern void nfa_hci_enable_one_nfcee(void);
 */
 extern void nfa_hci_check_pending_api_requests(void);
 extern void nfa_hci_check_api_requests(void);
+extern void nfa_hci_flush_pipe_cmd_q(uint8_t pipe);
 extern void nfa_hci_handle_admin_gate_cmd(uint8_t* p_data, uint16_t data_len);
 extern void nfa_hci_handle_admin_gate_rsp(uint8_t* p_data, uint8_t data_len);
 extern void nfa_hci_handle_admin_gate_evt();
@@ -500,6 +533,13 @@ extern tNFA_HCI_RESPONSE nfa_hciu_release_pipe(uint8_t pipe_id);
 extern void nfa_hciu_release_gate(uint8_t gate);
 extern void nfa_hciu_remove_all_pipes_from_host(uint8_t host);
 extern uint8_t nfa_hciu_get_allocated_gate_list(uint8_t* p_gate_list);
+extern void nfa_hciu_rebuild_lookup(void);
+extern tNFA_HCI_PIPE_CMD* nfa_hciu_find_pipe_cmd(uint8_t pipe_id);
+extern void nfa_hciu_pipe_cmd_done(tNFA_HCI_PIPE_CMD* p_cmd);
+extern void nfa_hciu_pipe_cmd_failed(uint8_t pipe_id, tNFA_HCI_PIPE_CMD* p_cmd);
+extern void nfa_hciu_send_pipe_cmd_failed(uint8_t pipe_id,
+                                          tNFA_HCI_COMMAND cmd, uint8_t param,
+                                          tNFA_HANDLE app_handle);
 
 extern void nfa_hciu_send_to_app(tNFA_HCI_EVT event, tNFA_HCI_EVT_DATA* p_evt,
                                  tNFA_HANDLE app_handle);
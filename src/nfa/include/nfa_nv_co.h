@@ -100,4 +100,17 @@ extern void nfa_nv_co_read(uint8_t* p_buf, uint16_t nbytes, uint8_t block);
 extern void nfa_nv_co_write(const uint8_t* p_buf, uint16_t nbytes,
                             uint8_t block);
 
+/*******************************************************************************
+**
+** Function         nfa_nv_co_flush
+**
+** Description      This function is called by NFA when it is disabled. It
+**                  returns once the data of every nfa_nv_co_write () is in
+**                  non volatile memory.
+**
+** Returns          void
+**
+*******************************************************************************/
+extern void nfa_nv_co_flush(void);
+
 #endif /* NFA_NV_CO_H */
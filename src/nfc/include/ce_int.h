@@ -46,6 +46,9 @@ typedef struct {
       nbr; /* NBr: number of blocks that can be read using one Check command */
   uint8_t nbw;    /* Nbw: number of blocks that can be written using one Update
                      command */
+  /* NBr/NBw as set by CE_T3tSetLocalNDefParams (0 to size to frame) */
+  uint8_t cfg_nbr;
+  uint8_t cfg_nbw;
   uint16_t nmaxb; /* Nmaxb: maximum number of blocks available for NDEF data */
   uint8_t writef; /* WriteFlag: 00h if writing data finished; 0Fh if writing
                      data in progress */
@@ -58,6 +61,7 @@ typedef struct {
   uint8_t scratch_writef;
   uint32_t scratch_ln;
   uint8_t* p_scratch_buf; /* Scratch buffer for WRITE/readback */
+  bool scratch_valid;     /* p_scratch_buf holds a copy of p_buf */
 } tCE_T3T_NDEF_INFO;
 
 /* Type 3 Tag current command processing */
@@ -93,6 +97,7 @@ typedef struct {
   uint16_t nlen;          /* current size of NDEF message         */
   uint16_t max_file_size; /* size of storage + 2 bytes for NLEN   */
   uint8_t* p_scratch_buf; /* temp storage of NDEF message for update */
+  bool scratch_valid;     /* p_scratch_buf holds a copy of p_ndef_msg */
 
 /* T4T CE App is selected       */
 #define CE_T4T_STATUS_T4T_APP_SELECTED 0x01
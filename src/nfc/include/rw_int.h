@@ -44,6 +44,8 @@
 #define RW_T1T_MAX_LOCK_TLVS 0x05
 /* Maximum supported dynamic lock bytes                     */
 #define RW_T1T_MAX_LOCK_BYTES 0x1E
+/* Segments of a dynamic tag cached per activation (TOPAZ512) */
+#define RW_T1T_MAX_CACHED_SEGMENTS 0x04
 
 /* State of the Tag as interpreted by RW */
 /* TAG State is unknown to RW                               */
@@ -186,6 +188,9 @@ typedef struct {
   bool b_update;    /* Tag header updated                                   */
   bool b_rseg;      /* Segment 0 read from tag                              */
   bool b_hard_lock; /* Hard lock the tag as part of config tag to Read only */
+  uint8_t cached_segs; /* Bitmap of segments held in seg_cache              */
+  uint8_t seg_cache[RW_T1T_MAX_CACHED_SEGMENTS]
+                   [T1T_SEGMENT_SIZE]; /* Segments read since activation */
 #if (RW_NDEF_INCLUDED == TRUE)
   uint8_t segment;  /* Current Tag segment                                  */
   uint8_t substate; /* Current substate of RW module                        */
@@ -195,6 +200,7 @@ typedef struct {
   uint8_t* p_ndef_buffer;                   /* Buffer to store ndef message */
   uint16_t new_ndef_msg_len; /* Lenght of new updating NDEF Message */
   uint8_t block_read; /* Last read Block                                      */
+  uint16_t read_offset; /* Tag offset of the next NDEF byte to read         */
   uint8_t write_byte; /* Index of last written byte                           */
   uint8_t tlv_detect; /* TLV type under detection                             */
   uint16_t ndef_msg_offset; /* The offset on Tag where first NDEF message is
@@ -545,8 +551,25 @@ typedef struct {
   (NFC_RW_POOL_BUF_SIZE - NFC_HDR_SIZE - NCI_MSG_OFFSET_SIZE - \
    NCI_DATA_HDR_SIZE - T4T_CMD_MAX_EXT_HDR_SIZE)
 
+/* Max data size using a single ReadBinary with Extended Field Coding.
+ * Fragmented R-APDUs are reassembled by NCI into the biggest GKI pool */
+#define RW_T4T_MAX_DATA_PER_READ_EXT                                     \
+  (GKI_MAX_BUF_SIZE - NFC_HDR_SIZE - NFC_RECEIVE_MSGS_OFFSET -           \
+   NCI_DATA_HDR_SIZE - T4T_RSP_STATUS_WORDS_SIZE)
+
+/* Max data size using a single UpdateBinary with Extended Field Coding.
+ * C-APDU is allocated from the biggest GKI pool and segmented by NCI */
+#define RW_T4T_MAX_DATA_PER_WRITE_EXT                             \
+  (GKI_MAX_BUF_SIZE - NFC_HDR_SIZE - NCI_MSG_OFFSET_SIZE -        \
+   NCI_DATA_HDR_SIZE - T4T_CMD_MAX_EXT_HDR_SIZE)
+
 #define RW_T4T_EXT_FIELD_CODING 0x01
 #define RW_T4T_DDO_LC_FIELD_CODING 0x02
+/* NDEF Tag Application is known to be selected on the tag */
+#define RW_T4T_NDEF_APP_SELECTED 0x04
+
+/* No file known to be selected on the tag */
+#define RW_T4T_FILE_ID_NONE 0xFFFF
 
 #define RW_T4T_BER_TLV_LENGTH_1_BYTE 0x01
 #define RW_T4T_BER_TLV_LENGTH_2_BYTES 0x02
@@ -610,7 +633,8 @@ typedef struct {
   uint16_t max_update_size; /* max updating size per a command  */
   uint16_t card_size;
   uint8_t card_type;
-  uint8_t intl_flags; /* flags for internal information   */
+  uint8_t intl_flags;     /* flags for internal information   */
+  uint16_t selected_file; /* file currently selected on tag   */
 } tRW_T4T_CB;
 
 /* RW retransmission statistics */
@@ -640,6 +664,12 @@ typedef struct {
 
 #define MFC_MAX_SECTOR_NUMBER 40
 #define MFC_LAST_4BLOCK_SECTOR 32
+
+/* Keys tried when authenticating a sector (bitmask in the key cache) */
+#define MFC_KEY_NONE 0x00
+#define MFC_KEY_MAD 0x01     /* MAD sector public key A */
+#define MFC_KEY_NDEF 0x02    /* NFC Forum public key A */
+#define MFC_KEY_DEFAULT 0x04 /* Transport configuration key */
 typedef uint8_t tRW_MFC_RW_STATE;
 typedef uint8_t tRW_MFC_RW_SUBSTATE;
 typedef struct {
@@ -671,6 +701,11 @@ typedef struct {
   bool mifare_ndefsector[MFC_MAX_SECTOR_NUMBER]; /* buffer to check ndef
                                                     compatible sector */
   uint8_t ndef_status; /* bitmap for NDEF status */
+  bool mad_valid;      /* MAD already parsed since activation */
+  uint8_t auth_sector; /* Sector of the pending authentication */
+  uint8_t auth_key;    /* Key used for the pending authentication */
+  uint8_t sector_key[MFC_MAX_SECTOR_NUMBER]; /* Key accepted by each sector */
+  uint8_t key_failed[MFC_MAX_SECTOR_NUMBER]; /* Keys rejected by each sector */
 } tRW_MFC_CB;
 
 /* ISO 15693 RW Control Block */
@@ -31,6 +31,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 
+#include "include/debug_hce_stats.h"
 #include "include/debug_nfcsnoop.h"
 #include "metrics.h"
 #include "nci_defs.h"
@@ -231,6 +232,10 @@ uint8_t nfc_ncif_send_data(tNFC_CONN_CB* p_cb, NFC_HDR* p_data) {
     }
   }
 
+  if (!empty_p_data && (p_cb->conn_id == NFC_RF_CONN_ID)) {
+    debug_hce_stats_tx();
+  }
+
   // log duration for the first hce data response
   if (!empty_p_data && (timer_start.tv_sec != 0 || timer_start.tv_usec != 0)) {
     gettimeofday(&timer_end, nullptr);
@@ -1078,6 +1083,7 @@ void nfc_ncif_proc_activate(uint8_t* p, uint8_t len) {
         plen--;
         p_intf->intf_param.la_iso.rats = *p++;
         gettimeofday(&timer_start, nullptr);
+        debug_hce_stats_activated();
         break;
 
       case NCI_DISCOVERY_TYPE_POLL_B:
@@ -1158,6 +1164,7 @@ void nfc_ncif_proc_activate(uint8_t* p, uint8_t len) {
                  p_lb_iso->hi_info_len);
         }
         gettimeofday(&timer_start, nullptr);
+        debug_hce_stats_activated();
         break;
     }
 
@@ -1300,6 +1307,7 @@ void nfc_ncif_proc_deactivate(uint8_t status, uint8_t deact_type, bool is_ntf) {
   if (timer_start.tv_sec != 0 || timer_start.tv_usec != 0) {
     memset(&timer_start, 0, sizeof(timer_start));
   }
+  debug_hce_stats_deactivated();
 }
 /*******************************************************************************
 **
@@ -1854,6 +1862,8 @@ void nfc_ncif_proc_data(NFC_HDR* p_msg) {
   if (p_cb && (p_msg->len >= NCI_DATA_HDR_SIZE)) {
     LOG(VERBOSE) << StringPrintf("nfc_ncif_proc_data len:%d", len);
 
+    if (cid == NFC_RF_CONN_ID) debug_hce_stats_rx();
+
     len = p_msg->len - NCI_MSG_HDR_SIZE;
     p_msg->layer_specific = 0;
     if (pbf) {
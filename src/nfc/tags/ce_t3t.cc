@@ -48,6 +48,14 @@ enum { CE_T3T_STATE_NOT_ACTIVATED, CE_T3T_STATE_IDLE, CE_T3T_STATE_UPDATING };
 #define CE_T3T_UPDATE_FL_NDEF_UPDATE_CPLT 0x02
 #define CE_T3T_UPDATE_FL_UPDATE 0x04
 
+/* Maximum length of a NFC-F frame, including SoD */
+#define CE_T3T_MAX_FRAME_LEN 255
+/* CHECK response header: SoD + rspcode + NFCID2 + status flags + num_blocks */
+#define CE_T3T_CHECK_RSP_HDR_LEN (1 + T3T_MSG_RSP_COMMON_HDR_LEN + 1)
+/* UPDATE command header: SoD + cmdcode + NFCID2 + num_services + service code
+ * + num_blocks */
+#define CE_T3T_UPDATE_CMD_HDR_LEN (T3T_MSG_CMD_COMMON_HDR_LEN + 2 + 1)
+
 /*******************************************************************************
  * Static constant definitions
  *******************************************************************************/
@@ -57,6 +65,52 @@ static const uint8_t CE_DEFAULT_LF_PMM[NCI_T3T_PMM_LEN] = {
     0xFE, /* This PAD0 is used to identify HCE-F on Android */
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
+/*******************************************************************************
+**
+** Function         ce_t3t_update_ndef_params
+**
+** Description      Set NBr/NBw advertised in the NDEF attribute block.
+**
+**                  Unless set by CE_T3tSetLocalNDefParams, use the largest
+**                  number of blocks whose CHECK response (or UPDATE command)
+**                  fits into one NFC-F frame and one CE pool buffer. UPDATE
+**                  block list elements are 3 bytes if NDEF memory has blocks
+**                  numbered 256 or more.
+**
+** Returns          none
+**
+*******************************************************************************/
+static void ce_t3t_update_ndef_params(tCE_T3T_MEM* p_cb) {
+  uint16_t max_len, max_rsp_len, elem_len;
+  uint8_t max_nbr, max_nbw;
+
+  max_len = CE_T3T_MAX_FRAME_LEN;
+  max_rsp_len = GKI_get_pool_bufsize(NFC_CE_POOL_ID) - NFC_HDR_SIZE -
+                NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE;
+  if (max_rsp_len < max_len) max_len = max_rsp_len;
+
+  max_nbr = (uint8_t)((max_len - CE_T3T_CHECK_RSP_HDR_LEN) / T3T_MSG_BLOCKSIZE);
+  if (max_nbr > T3T_MSG_NUM_BLOCKS_CHECK_MAX)
+    max_nbr = T3T_MSG_NUM_BLOCKS_CHECK_MAX;
+
+  elem_len = (p_cb->ndef_info.nmaxb > 0xFF) ? 3 : 2;
+  max_nbw = (uint8_t)((CE_T3T_MAX_FRAME_LEN - CE_T3T_UPDATE_CMD_HDR_LEN) /
+                      (T3T_MSG_BLOCKSIZE + elem_len));
+  if (max_nbw > T3T_MSG_NUM_BLOCKS_UPDATE_MAX)
+    max_nbw = T3T_MSG_NUM_BLOCKS_UPDATE_MAX;
+
+  p_cb->ndef_info.nbr = p_cb->ndef_info.cfg_nbr;
+  if ((p_cb->ndef_info.nbr == 0) || (p_cb->ndef_info.nbr > max_nbr))
+    p_cb->ndef_info.nbr = max_nbr;
+
+  p_cb->ndef_info.nbw = p_cb->ndef_info.cfg_nbw;
+  if ((p_cb->ndef_info.nbw == 0) || (p_cb->ndef_info.nbw > max_nbw))
+    p_cb->ndef_info.nbw = max_nbw;
+
+  LOG(VERBOSE) << StringPrintf("CE: nbr=%i, nbw=%i", p_cb->ndef_info.nbr,
+                             p_cb->ndef_info.nbw);
+}
+
 /*******************************************************************************
 **
 ** Function         ce_t3t_init
@@ -68,8 +122,9 @@ static const uint8_t CE_DEFAULT_LF_PMM[NCI_T3T_PMM_LEN] = {
 *******************************************************************************/
 void ce_t3t_init(void) {
   memcpy(ce_cb.mem.t3t.local_pmm, CE_DEFAULT_LF_PMM, NCI_T3T_PMM_LEN);
-  ce_cb.mem.t3t.ndef_info.nbr = CE_T3T_DEFAULT_CHECK_MAXBLOCKS;
-  ce_cb.mem.t3t.ndef_info.nbw = CE_T3T_DEFAULT_UPDATE_MAXBLOCKS;
+  ce_cb.mem.t3t.ndef_info.cfg_nbr = CE_T3T_DEFAULT_CHECK_MAXBLOCKS;
+  ce_cb.mem.t3t.ndef_info.cfg_nbw = CE_T3T_DEFAULT_UPDATE_MAXBLOCKS;
+  ce_t3t_update_ndef_params(&ce_cb.mem.t3t);
 }
 
 /*******************************************************************************
@@ -183,6 +238,25 @@ void ce_t3t_send_rsp(tCE_CB* p_ce_cb, uint8_t* p_nfcid2, uint8_t opcode,
   }
 }
 
+/*******************************************************************************
+**
+** Function         ce_t3t_prepare_scratch_buf
+**
+** Description      Copy read-buffer into scratch buffer before first NDEF
+**                  UPDATE. CHECK commands are served from the read-buffer
+**                  until then.
+**
+** Returns          none
+**
+*******************************************************************************/
+static void ce_t3t_prepare_scratch_buf(tCE_T3T_MEM* p_cb) {
+  if (p_cb->ndef_info.scratch_valid) return;
+
+  memcpy(p_cb->ndef_info.p_scratch_buf, p_cb->ndef_info.p_buf,
+         p_cb->ndef_info.ln);
+  p_cb->ndef_info.scratch_valid = true;
+}
+
 /*******************************************************************************
 **
 ** Function         ce_t3t_handle_update_cmd
@@ -244,7 +318,11 @@ void ce_t3t_handle_update_cmd(tCE_CB* p_ce_cb, NFC_HDR* p_cmd_msg) {
             "CE: error: write-request to read-only NDEF message.");
         nfc_status = NFC_STATUS_FAILED;
         break;
-      } else if (block_number == 0) {
+      }
+
+      ce_t3t_prepare_scratch_buf(p_cb);
+
+      if (block_number == 0) {
         LOG(VERBOSE) << StringPrintf("CE: Update sc 0x%04x block %i.",
                                    service_code, block_number);
 
@@ -466,7 +544,7 @@ void ce_t3t_handle_check_cmd(tCE_CB* p_ce_cb, NFC_HDR* p_cmd_msg) {
             /* If card is RW, then read from the scratch buffer (so reader/write
              * can read back what it had just written */
             if ((p_cb->ndef_info.rwflag == T3T_MSG_NDEF_RWFLAG_RW) &&
-                (p_cb->ndef_info.p_scratch_buf)) {
+                (p_cb->ndef_info.scratch_valid)) {
               ARRAY_TO_STREAM(
                   p_dst,
                   (&p_cb->ndef_info
@@ -892,12 +970,15 @@ tNFC_STATUS CE_T3tSetLocalNDEFMsg(bool read_only, uint32_t size_max,
     p_cb->ndef_info.p_buf = p_buf;
     p_cb->ndef_info.p_scratch_buf = p_scratch_buf;
 
-    /* Initiate scratch buffer with same contents as read-buffer */
+    /* Nbw depends on block list element size, i.e. on Nmaxb */
+    ce_t3t_update_ndef_params(p_cb);
+
+    /* Scratch buffer is filled with read-buffer contents on first UPDATE */
     if (p_scratch_buf) {
       p_cb->ndef_info.scratch_ln = p_cb->ndef_info.ln;
       p_cb->ndef_info.scratch_writef = T3T_MSG_NDEF_WRITEF_OFF;
-      memcpy(p_scratch_buf, p_buf, p_cb->ndef_info.ln);
     }
+    p_cb->ndef_info.scratch_valid = false;
   }
 
   return (NFC_STATUS_OK);
@@ -926,8 +1007,9 @@ tNFC_STATUS CE_T3tSetLocalNDefParams(uint8_t nbr, uint8_t nbw) {
     return NFC_STATUS_FAILED;
   }
 
-  p_cb->ndef_info.nbr = nbr;
-  p_cb->ndef_info.nbw = nbw;
+  p_cb->ndef_info.cfg_nbr = nbr;
+  p_cb->ndef_info.cfg_nbw = nbw;
+  ce_t3t_update_ndef_params(p_cb);
 
   return NFC_STATUS_OK;
 }
@@ -30,6 +30,7 @@
 #include "bt_types.h"
 #include "ce_api.h"
 #include "ce_int.h"
+#include "include/debug_hce_stats.h"
 #include "nfc_int.h"
 #include "nfc_target.h"
 #include "tags_int.h"
@@ -160,7 +161,7 @@ static bool ce_t4t_read_binary(uint16_t offset, uint8_t length) {
   if (p_t4t->status & CE_T4T_STATUS_CC_FILE_SELECTED) {
     p_src = p_t4t->cc_file;
   } else if (p_t4t->status & CE_T4T_STATUS_NDEF_SELECTED) {
-    if (p_t4t->p_scratch_buf)
+    if (p_t4t->scratch_valid)
       p_src = p_t4t->p_scratch_buf;
     else
       p_src = p_t4t->p_ndef_msg;
@@ -222,6 +223,27 @@ static bool ce_t4t_read_binary(uint16_t offset, uint8_t length) {
   }
 }
 
+/*******************************************************************************
+**
+** Function         ce_t4t_prepare_scratch_buf
+**
+** Description      Copy NDEF message into scratch buffer before first update
+**
+**                  Until peer starts updating NDEF file, READ BINARY is served
+**                  straight from the NDEF message set by upper layer.
+**
+** Returns          none
+**
+*******************************************************************************/
+static void ce_t4t_prepare_scratch_buf(void) {
+  tCE_T4T_MEM* p_t4t = &ce_cb.mem.t4t;
+
+  if (p_t4t->scratch_valid) return;
+
+  memcpy(p_t4t->p_scratch_buf, p_t4t->p_ndef_msg, p_t4t->nlen);
+  p_t4t->scratch_valid = true;
+}
+
 /*******************************************************************************
 **
 ** Function         ce_t4t_update_binary
@@ -246,6 +268,8 @@ static bool ce_t4t_update_binary(uint16_t offset, uint8_t length,
 
   starting_offset = offset;
 
+  ce_t4t_prepare_scratch_buf();
+
   /* update file size (NLEN) */
   if ((offset < T4T_FILE_LENGTH_SIZE) && (length > 0)) {
     p = file_length;
@@ -393,6 +417,9 @@ static void ce_t4t_process_select_app_cmd(uint8_t* p_cmd, NFC_HDR* p_c_apdu) {
     GKI_freebuf(p_c_apdu);
     return;
   }
+
+  debug_hce_stats_select_aid(p_cmd, data_len);
+
 #if (CE_TEST_INCLUDED == TRUE)
   if (mapping_aid_test_enabled) {
     if ((data_len == T4T_V20_NDEF_TAG_AID_LEN) &&
@@ -866,12 +893,9 @@ tNFC_STATUS CE_T4tSetLocalNDEFMsg(bool read_only, uint16_t ndef_msg_max,
   p_t4t->nlen = ndef_msg_len;
   p_t4t->max_file_size = ndef_msg_max + T4T_FILE_LENGTH_SIZE;
 
-  /* Initialize scratch buffer */
+  /* Scratch buffer is filled on first UPDATE BINARY */
   p_t4t->p_scratch_buf = p_scratch_buf;
-
-  if (p_scratch_buf) {
-    memcpy(p_scratch_buf, p_ndef_msg, ndef_msg_len);
-  }
+  p_t4t->scratch_valid = false;
 
   return NFC_STATUS_OK;
 }
@@ -77,6 +77,9 @@ using com::android::nfc::nci::flags::mfc_read_mad;
 
 #define RW_MFC_1K_BLOCK_SIZE 16
 
+/* No sector currently authenticated */
+#define RW_MFC_SECTOR_NONE 0xFF
+
 uint8_t KeyNDEF[6] = {0xD3, 0XF7, 0xD3, 0XF7, 0xD3, 0XF7};
 uint8_t KeyMAD[6] = {0xA0, 0XA1, 0xA2, 0XA3, 0xA4, 0XA5};
 uint8_t KeyDefault[6] = {0xFF, 0XFF, 0xFF, 0XFF, 0xFF, 0XFF};
@@ -105,6 +108,7 @@ static void rw_mfc_handle_read_op(uint8_t* data);
 static void rw_mfc_handle_op_complete(void);
 static void rw_mfc_handle_ndef_read_rsp(uint8_t* p_data);
 static void rw_mfc_process_error();
+static void rw_mfc_fail_op();
 
 static tNFC_STATUS rw_mfc_formatBlock(int block);
 static void rw_mfc_handle_format_rsp(uint8_t* p_data);
@@ -115,6 +119,10 @@ static void rw_mfc_handle_write_op();
 static tNFC_STATUS rw_MfcCheckMad();
 static void rw_mfc_handle_mad_detect_rsp(uint8_t* p_data);
 static bool rw_nfc_StoreMad(uint8_t* data);
+static uint8_t rw_mfc_sector_of(int block);
+static uint16_t rw_mfc_next_data_block(uint16_t block);
+static void rw_mfc_handle_auth_rsp(uint8_t status);
+static void rw_mfc_update_key_cache(uint16_t block);
 
 using android::base::StringPrintf;
 
@@ -147,10 +155,17 @@ tNFC_STATUS RW_MfcFormatNDef(void) {
   p_mfc->last_block_accessed.block = 1;
   p_mfc->next_block.block = 1;
 
+  /* MAD is rewritten, it has to be parsed again on next detection */
+  p_mfc->mad_valid = false;
+  if (mfc_read_mad()) {
+    memset(p_mfc->mifare_ndefsector, 0, sizeof(p_mfc->mifare_ndefsector));
+  }
+
   status = rw_mfc_formatBlock(p_mfc->next_block.block);
   if (status == NFC_STATUS_OK) {
     p_mfc->state = RW_MFC_STATE_NDEF_FORMAT;
   } else {
+    p_mfc->state = RW_MFC_STATE_IDLE;
     p_mfc->substate = RW_MFC_SUBSTATE_NONE;
   }
 
@@ -170,16 +185,11 @@ static tNFC_STATUS rw_mfc_formatBlock(int block) {
   NFC_HDR* mfcbuf;
   uint8_t* p;
   tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
-  int sectorlength = block / 4;
   tNFC_STATUS status = NFC_STATUS_OK;
 
   LOG(VERBOSE) << __func__ << ": block : " << block;
 
-  if (block > 128) {
-    sectorlength = (p_mfc->next_block.block - 128) / 16 + 32;
-  }
-
-  if (sectorlength != p_mfc->sector_authentified) {
+  if (rw_mfc_sector_of(block) != p_mfc->sector_authentified) {
     if (rw_mfc_authenticate(block, true) == true) {
       return NFC_STATUS_OK;
     }
@@ -243,30 +253,12 @@ static void rw_mfc_handle_format_rsp(uint8_t* p_data) {
   switch (p_mfc->substate) {
     case RW_MFC_SUBSTATE_WAIT_ACK:
       p_mfc->last_block_accessed.block = p_mfc->current_block;
-
-      if (p[0] == 0x0) {
-        p_mfc->next_block.auth = true;
-        p_mfc->last_block_accessed.auth = true;
-
-        if (mfc_read_mad() && p_mfc->current_block < 127) {
-          p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-        } else if (!mfc_read_mad() && p_mfc->next_block.block < 128) {
-          p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-        } else {
-          p_mfc->sector_authentified =
-              (p_mfc->next_block.block - 128) / 16 + 32;
-        }
-        rw_mfc_resume_op();
-      } else {
-        p_mfc->next_block.auth = false;
-        p_mfc->last_block_accessed.auth = false;
-        nfc_stop_quick_timer(&p_mfc->timer);
-        rw_mfc_process_error();
-      }
+      rw_mfc_handle_auth_rsp(p[0]);
       break;
 
     case RW_MFC_SUBSTATE_FORMAT_BLOCK:
       if (p[0] == 0x0) {
+        rw_mfc_update_key_cache(p_mfc->current_block);
         rw_mfc_handle_format_op();
       } else {
         nfc_stop_quick_timer(&p_mfc->timer);
@@ -307,6 +299,7 @@ static void rw_mfc_handle_format_op() {
     if (rw_mfc_formatBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
       evt_data.status = NFC_STATUS_FAILED;
       evt_data.p_data = NULL;
+      rw_mfc_handle_op_complete();
       (*rw_cb.p_cback)(RW_MFC_NDEF_FORMAT_CPLT_EVT, (tRW_DATA*)&evt_data);
     }
   } else {
@@ -377,6 +370,7 @@ tNFC_STATUS RW_MfcWriteNDef(uint16_t buf_len, uint8_t* p_buffer) {
   if (status == NFC_STATUS_OK) {
     p_mfc->state = RW_MFC_STATE_UPDATE_NDEF;
   } else {
+    p_mfc->state = RW_MFC_STATE_IDLE;
     p_mfc->substate = RW_MFC_SUBSTATE_NONE;
   }
 
@@ -396,16 +390,11 @@ static tNFC_STATUS rw_mfc_writeBlock(int block) {
   NFC_HDR* mfcbuf;
   uint8_t* p;
   tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
-  int sectorlength = block / 4;
   tNFC_STATUS status = NFC_STATUS_OK;
 
   LOG(VERBOSE) << __func__ << ": block : " << block;
 
-  if (block > 128) {
-    sectorlength = (p_mfc->next_block.block - 128) / 16 + 32;
-  }
-
-  if (sectorlength != p_mfc->sector_authentified) {
+  if (rw_mfc_sector_of(block) != p_mfc->sector_authentified) {
     if (rw_mfc_authenticate(block, true) == true) {
       return NFC_STATUS_OK;
     }
@@ -473,26 +462,7 @@ static void rw_mfc_handle_write_rsp(uint8_t* p_data) {
   switch (p_mfc->substate) {
     case RW_MFC_SUBSTATE_WAIT_ACK:
       p_mfc->last_block_accessed.block = p_mfc->current_block;
-
-      if (p[0] == 0x0) {
-        p_mfc->next_block.auth = true;
-        p_mfc->last_block_accessed.auth = true;
-
-        if (mfc_read_mad() && p_mfc->current_block < 128) {
-          p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-        } else if (!mfc_read_mad() && p_mfc->next_block.block < 128) {
-          p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-        } else {
-          p_mfc->sector_authentified =
-              (p_mfc->next_block.block - 128) / 16 + 32;
-        }
-        rw_mfc_resume_op();
-      } else {
-        p_mfc->next_block.auth = false;
-        p_mfc->last_block_accessed.auth = false;
-        nfc_stop_quick_timer(&p_mfc->timer);
-        rw_mfc_process_error();
-      }
+      rw_mfc_handle_auth_rsp(p[0]);
       break;
 
     case RW_MFC_SUBSTATE_WRITE_BLOCK:
@@ -517,26 +487,7 @@ static void rw_mfc_handle_write_op() {
     (*rw_cb.p_cback)(RW_MFC_NDEF_WRITE_CPLT_EVT, (tRW_DATA*)&evt_data);
   } else {
     p_mfc->last_block_accessed.block = p_mfc->current_block;
-
-    if (p_mfc->current_block % 4 == 2) {
-      p_mfc->next_block.block = p_mfc->current_block + 2;
-    } else {
-      p_mfc->next_block.block = p_mfc->current_block + 1;
-    }
-
-    /* Do not read block 16 (MAD2) - Mifare Classic4 k */
-    if (p_mfc->next_block.block == 64) {
-      p_mfc->next_block.block += 4;
-    }
-
-    if ((p_mfc->selres & RW_MFC_4K_Support) &&
-        (p_mfc->next_block.block >= 128)) {
-      if (p_mfc->current_block % 16 == 14) {
-        p_mfc->next_block.block = p_mfc->current_block + 2;
-      } else {
-        p_mfc->next_block.block = p_mfc->current_block + 1;
-      }
-    }
+    p_mfc->next_block.block = rw_mfc_next_data_block(p_mfc->current_block);
 
     /* Write next blocks */
     if (rw_mfc_writeBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
@@ -566,8 +517,20 @@ static void rw_mfc_handle_write_op() {
  **
  *****************************************************************************/
 tNFC_STATUS RW_MfcDetectNDef(void) {
+  tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
+
   LOG(DEBUG) << __func__;
   if (mfc_read_mad()) {
+    if (p_mfc->mad_valid && (p_mfc->state == RW_MFC_STATE_IDLE)) {
+      /* MAD already parsed since activation, go straight to the NDEF TLV */
+      LOG(VERBOSE) << __func__ << "; reusing MAD read at activation";
+      p_mfc->state = RW_MFC_STATE_DETECT_MAD;
+      if (rw_MfcLocateTlv(TAG_NDEF_TLV) != NFC_STATUS_OK) {
+        p_mfc->state = RW_MFC_STATE_IDLE;
+        return NFC_STATUS_FAILED;
+      }
+      return NFC_STATUS_OK;
+    }
     return rw_MfcCheckMad();
   } else {
     return rw_MfcLocateTlv(TAG_NDEF_TLV);
@@ -618,7 +581,12 @@ tNFC_STATUS rw_mfc_select(uint8_t selres, uint8_t uid[MFC_UID_LEN]) {
     p_mfc->next_block.block = 4;
   }
   p_mfc->next_block.auth = false;
-  p_mfc->sector_authentified = -1;
+  p_mfc->sector_authentified = RW_MFC_SECTOR_NONE;
+
+  /* Key cache and MAD are only valid for the current activation */
+  p_mfc->mad_valid = false;
+  memset(p_mfc->sector_key, MFC_KEY_NONE, sizeof(p_mfc->sector_key));
+  memset(p_mfc->key_failed, MFC_KEY_NONE, sizeof(p_mfc->key_failed));
 
   return NFC_STATUS_OK;
 }
@@ -831,11 +799,12 @@ static tNFC_STATUS rw_MfcCheckMad() {
     LOG(DEBUG) << __func__
                << "; RW_MFC_STATE_DETECT_TLV state=" << p_mfc->state;
   } else {
+    p_mfc->state = RW_MFC_STATE_IDLE;
     p_mfc->substate = RW_MFC_SUBSTATE_NONE;
     LOG(DEBUG) << __func__ << "; rw_MfcLocateTlv state=" << p_mfc->state;
   }
 
-  return NFC_STATUS_OK;
+  return success;
 }
 /*******************************************************************************
  **
@@ -903,12 +872,13 @@ static tNFC_STATUS rw_MfcLocateTlv(uint8_t tlv_type) {
     LOG(VERBOSE) << StringPrintf("%s RW_MFC_STATE_DETECT_TLV state=%d", __func__,
                                p_mfc->state);
   } else {
+    p_mfc->state = RW_MFC_STATE_IDLE;
     p_mfc->substate = RW_MFC_SUBSTATE_NONE;
     LOG(VERBOSE) << StringPrintf("%s rw_MfcLocateTlv state=%d", __func__,
                                p_mfc->state);
   }
 
-  return NFC_STATUS_OK;
+  return success;
 }
 
 /*******************************************************************************
@@ -929,6 +899,42 @@ static bool rw_mfc_authenticate(int block, bool KeyA) {
   LOG(VERBOSE) << __func__ << ": block:" << block;
 
   uint8_t* KeyToUse;
+  uint8_t sector = rw_mfc_sector_of(block);
+  uint8_t key;
+
+  if (p_mfc->state == RW_MFC_STATE_NDEF_FORMAT) {
+    key = MFC_KEY_DEFAULT;
+  } else if (p_mfc->sector_key[sector] != MFC_KEY_NONE) {
+    /* Reuse the key this sector already accepted since activation */
+    key = p_mfc->sector_key[sector];
+  } else if (mfc_read_mad()) {
+    // support large memory size mapping
+    if ((block >= 0 && block < 4) || (block >= 64 && block < 68)) {
+      key = MFC_KEY_MAD;
+    } else {
+      key = MFC_KEY_NDEF;
+    }
+  } else {
+    if ((block >= 0 && block < 4)) {
+      key = MFC_KEY_MAD;
+    } else {
+      key = MFC_KEY_NDEF;
+    }
+  }
+
+  if (p_mfc->key_failed[sector] & key) {
+    LOG(ERROR) << StringPrintf("%s: key 0x%02x already rejected by sector %d",
+                               __func__, key, sector);
+    return false;
+  }
+
+  if (key == MFC_KEY_DEFAULT) {
+    KeyToUse = KeyDefault;
+  } else if (key == MFC_KEY_MAD) {
+    KeyToUse = KeyMAD;
+  } else {
+    KeyToUse = KeyNDEF;
+  }
 
   mfcbuf = (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
 
@@ -948,25 +954,6 @@ static bool rw_mfc_authenticate(int block, bool KeyA) {
 
   UINT8_TO_BE_STREAM(p, block);
   ARRAY_TO_BE_STREAM(p, p_mfc->uid, 4);
-
-  if (p_mfc->state == RW_MFC_STATE_NDEF_FORMAT)
-    KeyToUse = KeyDefault;
-  else {
-    if (mfc_read_mad()) {
-      // support large memory size mapping
-      if ((block >= 0 && block < 4) || (block >= 64 && block < 68)) {
-        KeyToUse = KeyMAD;
-      } else {
-        KeyToUse = KeyNDEF;
-      }
-    } else {
-      if ((block >= 0 && block < 4)) {
-        KeyToUse = KeyMAD;
-      } else {
-        KeyToUse = KeyNDEF;
-      }
-    }
-  }
   ARRAY_TO_BE_STREAM(p, KeyToUse, 6);
 
   mfcbuf->len = 12;
@@ -974,6 +961,8 @@ static bool rw_mfc_authenticate(int block, bool KeyA) {
   if (!rw_mfc_send_to_lower(mfcbuf)) {
     return false;
   }
+  p_mfc->auth_sector = sector;
+  p_mfc->auth_key = key;
   /* Backup the current substate to move back to this substate after changing
    * sector */
   p_mfc->prev_substate = p_mfc->substate;
@@ -981,6 +970,124 @@ static bool rw_mfc_authenticate(int block, bool KeyA) {
   return true;
 }
 
+/*******************************************************************************
+ **
+ ** Function         rw_mfc_handle_auth_rsp
+ **
+ ** Description      Handle the response to an authentication command. The key
+ **                  accepted by the sector is cached so that later operations
+ **                  in this activation authenticate with it directly. A
+ **                  rejected key leaves the tag halted, so it is recorded and
+ **                  the operation fails without retransmission.
+ **
+ ** Returns          none
+ **
+ *******************************************************************************/
+static void rw_mfc_handle_auth_rsp(uint8_t status) {
+  tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
+
+  if (status == 0x0) {
+    p_mfc->next_block.auth = true;
+    p_mfc->last_block_accessed.auth = true;
+    p_mfc->sector_authentified = p_mfc->auth_sector;
+    p_mfc->sector_key[p_mfc->auth_sector] = p_mfc->auth_key;
+
+    LOG(VERBOSE) << StringPrintf("%s: sector authentified: %d", __func__,
+                                 p_mfc->sector_authentified);
+    rw_mfc_resume_op();
+  } else {
+    LOG(DEBUG) << StringPrintf("%s: sector %d rejected key 0x%02x, status=%d",
+                               __func__, p_mfc->auth_sector, p_mfc->auth_key,
+                               status);
+    p_mfc->next_block.auth = false;
+    p_mfc->last_block_accessed.auth = false;
+    p_mfc->key_failed[p_mfc->auth_sector] |= p_mfc->auth_key;
+    if (p_mfc->sector_key[p_mfc->auth_sector] == p_mfc->auth_key) {
+      p_mfc->sector_key[p_mfc->auth_sector] = MFC_KEY_NONE;
+    }
+    nfc_stop_quick_timer(&p_mfc->timer);
+    /* Retrying with the same key cannot succeed */
+    rw_mfc_fail_op();
+  }
+}
+
+/*******************************************************************************
+ **
+ ** Function         rw_mfc_update_key_cache
+ **
+ ** Description      Update the key cache after a sector trailer has been
+ **                  written during formatting.
+ **
+ ** Returns          none
+ **
+ *******************************************************************************/
+static void rw_mfc_update_key_cache(uint16_t block) {
+  tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
+  uint8_t sector = rw_mfc_sector_of(block);
+  bool is_trailer = (block < 128) ? ((block % 4) == 3) : ((block % 16) == 15);
+
+  if (!is_trailer) return;
+
+  if ((block == 3) || (block == 67)) {
+    p_mfc->sector_key[sector] = MFC_KEY_MAD;
+  } else {
+    p_mfc->sector_key[sector] = MFC_KEY_NDEF;
+  }
+  p_mfc->key_failed[sector] = MFC_KEY_NONE;
+}
+
+/*******************************************************************************
+ **
+ ** Function         rw_mfc_sector_of
+ **
+ ** Description      Get the sector containing a given block. Sectors 0 to 31
+ **                  have 4 blocks, sectors 32 to 39 (4K only) have 16 blocks.
+ **
+ ** Returns          sector number
+ **
+ *******************************************************************************/
+static uint8_t rw_mfc_sector_of(int block) {
+  if (block < 4 * MFC_LAST_4BLOCK_SECTOR) {
+    return block / 4;
+  }
+  return (block - 4 * MFC_LAST_4BLOCK_SECTOR) / 16 + MFC_LAST_4BLOCK_SECTOR;
+}
+
+/*******************************************************************************
+ **
+ ** Function         rw_mfc_next_data_block
+ **
+ ** Description      Get the data block following a given block, skipping
+ **                  sector trailers and the MAD2 sector of a 4K tag.
+ **
+ ** Returns          next data block
+ **
+ *******************************************************************************/
+static uint16_t rw_mfc_next_data_block(uint16_t block) {
+  tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
+  uint16_t next;
+
+  if (block % 4 == 2) {
+    next = block + 2;
+  } else {
+    next = block + 1;
+  }
+
+  /* Do not read block 16 (MAD2) - Mifare Classic4 k */
+  if (next == 64) {
+    next += 4;
+  }
+
+  if ((p_mfc->selres & RW_MFC_4K_Support) && (next >= 128)) {
+    if (block % 16 == 14) {
+      next = block + 2;
+    } else {
+      next = block + 1;
+    }
+  }
+  return next;
+}
+
 /*******************************************************************************
  **
  ** Function         rw_mfc_readBlock
@@ -994,16 +1101,11 @@ static tNFC_STATUS rw_mfc_readBlock(int block) {
   NFC_HDR* mfcbuf;
   uint8_t* p;
   tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
-  int sectorlength = block / 4;
   tNFC_STATUS status = NFC_STATUS_OK;
 
   LOG(VERBOSE) << __func__ << ": block : " << block;
 
-  if (block > 128) {
-    sectorlength = (p_mfc->next_block.block - 128) / 16 + 32;
-  }
-
-  if (sectorlength != p_mfc->sector_authentified) {
+  if (rw_mfc_sector_of(block) != p_mfc->sector_authentified) {
     if (rw_mfc_authenticate(block, true) == true) {
       LOG(DEBUG) << __func__ << ": RW_MFC_SUBSTATE_WAIT_ACK";
       return NFC_STATUS_OK;
@@ -1055,20 +1157,7 @@ static void rw_mfc_handle_mad_detect_rsp(uint8_t* p_data) {
   p_mfc->last_block_accessed.block = p_mfc->next_block.block;
   switch (p_mfc->substate) {
     case RW_MFC_SUBSTATE_WAIT_ACK:
-      /* Search for the tlv */
-      if (p[0] == 0x0) {
-        p_mfc->next_block.auth = true;
-        p_mfc->last_block_accessed.auth = true;
-        p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-
-        rw_mfc_resume_op();
-      } else {
-        p_mfc->next_block.auth = false;
-        p_mfc->last_block_accessed.auth = false;
-        LOG(DEBUG) << __func__ << "; status=" << p[0];
-        nfc_stop_quick_timer(&p_mfc->timer);
-        rw_mfc_process_error();
-      }
+      rw_mfc_handle_auth_rsp(p[0]);
       break;
 
     case RW_MFC_SUBSTATE_READ_BLOCK:
@@ -1108,20 +1197,7 @@ static void rw_mfc_handle_tlv_detect_rsp(uint8_t* p_data) {
   p_mfc->last_block_accessed.block = p_mfc->next_block.block;
   switch (p_mfc->substate) {
     case RW_MFC_SUBSTATE_WAIT_ACK:
-      /* Search for the tlv */
-      if (p[0] == 0x0) {
-        p_mfc->next_block.auth = true;
-        p_mfc->last_block_accessed.auth = true;
-        p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-
-        rw_mfc_resume_op();
-      } else {
-        p_mfc->next_block.auth = false;
-        p_mfc->last_block_accessed.auth = false;
-        LOG(VERBOSE) << StringPrintf("%s : status=%d", __func__, p[0]);
-        nfc_stop_quick_timer(&p_mfc->timer);
-        rw_mfc_process_error();
-      }
+      rw_mfc_handle_auth_rsp(p[0]);
       break;
 
     case RW_MFC_SUBSTATE_READ_BLOCK:
@@ -1151,34 +1227,33 @@ static void rw_mfc_handle_tlv_detect_rsp(uint8_t* p_data) {
  *******************************************************************************/
 static void rw_mfc_resume_op() {
   tRW_MFC_CB* p_mfc = &rw_cb.tcb.mfc;
+  tNFC_STATUS status = NFC_STATUS_OK;
 
   switch (p_mfc->state) {
     case RW_MFC_STATE_DETECT_MAD:
-      if (rw_mfc_readBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
-        LOG(ERROR) << __func__ << "; Error calling rw_mfc_readBlock()";
-      }
-      break;
     case RW_MFC_STATE_DETECT_TLV:
-      if (rw_mfc_readBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
-        LOG(ERROR) << __func__ << "; Error calling rw_mfc_readBlock()";
-      }
-      break;
     case RW_MFC_STATE_READ_NDEF:
-      if (rw_mfc_readBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
+      status = rw_mfc_readBlock(p_mfc->next_block.block);
+      if (status != NFC_STATUS_OK) {
         LOG(ERROR) << __func__ << "; Error calling rw_mfc_readBlock()";
       }
       break;
     case RW_MFC_STATE_NDEF_FORMAT:
-      if (rw_mfc_formatBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
+      status = rw_mfc_formatBlock(p_mfc->next_block.block);
+      if (status != NFC_STATUS_OK) {
         LOG(ERROR) << __func__ << "; Error calling rw_mfc_formatBlock()";
       }
       break;
     case RW_MFC_STATE_UPDATE_NDEF:
-      if (rw_mfc_writeBlock(p_mfc->next_block.block) != NFC_STATUS_OK) {
+      status = rw_mfc_writeBlock(p_mfc->next_block.block);
+      if (status != NFC_STATUS_OK) {
         LOG(ERROR) << __func__ << "; Error calling rw_mfc_writeBlock()";
       }
       break;
   }
+
+  /* Nothing was sent, so no response or timeout will end the operation */
+  if (status != NFC_STATUS_OK) rw_mfc_fail_op();
 }
 
 /*******************************************************************************
@@ -1218,11 +1293,14 @@ static void rw_mfc_handle_read_op(uint8_t* data) {
       } else if (p_mfc->current_block == 2 &&  // 2 is last block of MAD1
                  !(p_mfc->selres & RW_MFC_4K_Support)) {
         LOG(DEBUG) << __func__ << "; Finished reading the MAD1 sector";
+        p_mfc->mad_valid = true;
         for (int k = 0; k < 16; k++) {
           LOG(DEBUG) << __func__ << "; k= " << k
                      << " value = " << p_mfc->mifare_ndefsector[k];
         }
-        rw_MfcLocateTlv(TAG_NDEF_TLV);
+        if (rw_MfcLocateTlv(TAG_NDEF_TLV) != NFC_STATUS_OK) {
+          failed = true;
+        }
 
       } else if (p_mfc->current_block == 2 &&  // 2 is last block of MAD1
                  (p_mfc->selres & RW_MFC_4K_Support)) {
@@ -1233,13 +1311,17 @@ static void rw_mfc_handle_read_op(uint8_t* data) {
         }
       } else if (p_mfc->current_block == 66) {  // 66 is last block of MAD2
         LOG(DEBUG) << __func__ << "; Finished reading the MAD1 & MAD2 sectors";
+        p_mfc->mad_valid = true;
         for (int k = 0; k < 40; k++) {
           LOG(DEBUG) << __func__ << "; k= " << k
                      << " value = " << p_mfc->mifare_ndefsector[k];
         }
-        rw_MfcLocateTlv(TAG_NDEF_TLV);
+        if (rw_MfcLocateTlv(TAG_NDEF_TLV) != NFC_STATUS_OK) {
+          failed = true;
+        }
       }
 
+      if (failed) rw_mfc_fail_op();
       break;
     case RW_MFC_STATE_DETECT_TLV:
       tlv_found = rw_nfc_decodeTlv(data);
@@ -1559,32 +1641,7 @@ static void rw_mfc_handle_ndef_read_rsp(uint8_t* p_data) {
     case RW_MFC_SUBSTATE_WAIT_ACK:
       /* Search for the tlv */
       p_mfc->last_block_accessed.block = p_mfc->current_block;
-
-      if (p[0] == 0x0) {
-        p_mfc->next_block.auth = true;
-        p_mfc->last_block_accessed.auth = true;
-
-        if (p_mfc->current_block < 128) {
-          p_mfc->sector_authentified = p_mfc->next_block.block / 4;
-        }
-
-        else
-          p_mfc->sector_authentified =
-              (p_mfc->next_block.block - 128) / 16 + 32;
-
-        rw_mfc_resume_op();
-        LOG(VERBOSE) << StringPrintf(
-            "rw_mfc_handle_ndef_read_rsp () sector authentified: %d",
-            p_mfc->sector_authentified);
-      } else {
-        p_mfc->next_block.auth = false;
-        p_mfc->last_block_accessed.auth = false;
-        if (mfc_read_mad()) {
-          LOG(DEBUG) << __func__ << "; status=" << p[0];
-          nfc_stop_quick_timer(&p_mfc->timer);
-          rw_mfc_process_error();
-        }
-      }
+      rw_mfc_handle_auth_rsp(p[0]);
       break;
 
     case RW_MFC_SUBSTATE_READ_BLOCK:
@@ -1592,27 +1649,7 @@ static void rw_mfc_handle_ndef_read_rsp(uint8_t* p_data) {
 
       if (mfc_data->len == 0x10) {
         p_mfc->last_block_accessed.block = p_mfc->current_block;
-
-        if (p_mfc->current_block % 4 == 2) {
-          p_mfc->next_block.block = p_mfc->current_block + 2;
-        } else {
-          p_mfc->next_block.block = p_mfc->current_block + 1;
-        }
-
-        /* Do not read block 16 (MAD2) - Mifare Classic4 k */
-        if (p_mfc->next_block.block == 64) {
-          p_mfc->next_block.block += 4;
-        }
-
-        if ((p_mfc->selres & RW_MFC_4K_Support) &&
-            (p_mfc->next_block.block >= 128)) {
-          if (p_mfc->current_block % 16 == 14) {
-            p_mfc->next_block.block = p_mfc->current_block + 2;
-          } else {
-            p_mfc->next_block.block = p_mfc->current_block + 1;
-          }
-        }
-
+        p_mfc->next_block.block = rw_mfc_next_data_block(p_mfc->current_block);
         p_mfc->next_block.auth = false;
         rw_mfc_handle_read_op((uint8_t*)mfc_data);
       } else if (mfc_read_mad()) {
@@ -1680,6 +1717,9 @@ static void rw_mfc_process_error() {
                << RW_MAX_RETRIES;
   }
 
+  /* Tag is halted after a failure, authentication has to be redone */
+  p_mfc->sector_authentified = RW_MFC_SECTOR_NONE;
+
   if (p_mfc->state == RW_MFC_STATE_DETECT_TLV) {
     rw_event = RW_MFC_NDEF_DETECT_EVT;
   } else if (p_mfc->state == RW_MFC_STATE_READ_NDEF) {
@@ -1713,3 +1753,21 @@ static void rw_mfc_process_error() {
     (*rw_cb.p_cback)(rw_event, (tRW_DATA*)&evt_data);
   }
 }
+
+/*******************************************************************************
+ **
+ ** Function         rw_mfc_fail_op
+ **
+ ** Description      Fail the current operation without retransmission, and
+ **                  notify the upper layer with the event of the operation.
+ **                  Used when the next command could not be sent, or can only
+ **                  fail, so that the operation does not wait for a response
+ **                  forever.
+ **
+ ** Returns          none
+ **
+ *******************************************************************************/
+static void rw_mfc_fail_op() {
+  rw_cb.cur_retry = RW_MAX_RETRIES;
+  rw_mfc_process_error();
+}
@@ -103,6 +103,8 @@ static void rw_t1t_data_cback(__attribute__((unused)) uint8_t conn_id,
       p_t1t->prev_cmd_rsp_info.pend_retx_rsp--;
       GKI_freebuf(p_pkt);
     } else {
+      /* Raw frame may have modified the tag, drop cached segments */
+      p_t1t->cached_segs = 0;
       /* Raw frame event */
       evt_data.data.p_data = p_pkt;
       (*rw_cb.p_cback)(RW_T1T_RAW_FRAME_EVT, &evt_data);
@@ -868,6 +870,7 @@ tNFC_STATUS RW_T1tWriteErase(uint8_t block, uint8_t byte, uint8_t new_byte) {
       p_t1t->b_update = false;
       p_t1t->b_rseg = false;
     }
+    p_t1t->cached_segs = 0;
   }
   return status;
 }
@@ -916,6 +919,7 @@ tNFC_STATUS RW_T1tWriteNoErase(uint8_t block, uint8_t byte, uint8_t new_byte) {
       p_t1t->b_update = false;
       p_t1t->b_rseg = false;
     }
+    p_t1t->cached_segs = 0;
   }
   return status;
 }
@@ -1026,6 +1030,7 @@ tNFC_STATUS RW_T1tWriteErase8(uint8_t block, uint8_t* p_new_dat) {
         p_t1t->b_update = false;
         p_t1t->b_rseg = false;
       }
+      p_t1t->cached_segs = 0;
     }
   }
   return status;
@@ -1074,6 +1079,7 @@ tNFC_STATUS RW_T1tWriteNoErase8(uint8_t block, uint8_t* p_new_dat) {
         p_t1t->b_update = false;
         p_t1t->b_rseg = false;
       }
+      p_t1t->cached_segs = 0;
     }
   }
   return status;
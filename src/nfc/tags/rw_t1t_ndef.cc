@@ -68,6 +68,8 @@ static void rw_t1t_update_attributes(void);
 static void rw_t1t_update_lock_attributes(void);
 static void rw_t1t_extract_lock_bytes(uint8_t* p_data);
 static void rw_t1t_update_tag_state(void);
+static bool rw_t1t_is_segment_cached(uint8_t segment);
+static tNFC_STATUS rw_t1t_read_next_ndef_bytes(void);
 
 const uint8_t rw_t1t_mask_bits[8] = {0x01, 0x02, 0x04, 0x08,
                                      0x10, 0x20, 0x40, 0x80};
@@ -87,6 +89,7 @@ tRW_EVENT rw_t1t_handle_rsp(const tT1T_CMD_RSP_INFO* p_info, bool* p_notify,
   tRW_EVENT rw_event;
   tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
   uint8_t adds;
+  uint8_t segment;
 
   if ((p_t1t->state == RW_T1T_STATE_READ) ||
       (p_t1t->state == RW_T1T_STATE_WRITE)) {
@@ -99,6 +102,13 @@ tRW_EVENT rw_t1t_handle_rsp(const tT1T_CMD_RSP_INFO* p_info, bool* p_notify,
     *p_status = rw_t1t_handle_rall_rsp(p_notify, p_data);
   } else if (p_info->opcode == T1T_CMD_RSEG) {
     adds = *p_data;
+    segment = adds >> 4;
+    if (segment < RW_T1T_MAX_CACHED_SEGMENTS) {
+      /* Keep the segment so that later operations are served locally */
+      memcpy(p_t1t->seg_cache[segment], p_data + T1T_ADD_LEN,
+             T1T_SEGMENT_SIZE);
+      p_t1t->cached_segs |= (1 << segment);
+    }
     if (adds == 0) {
       p_t1t->b_rseg = true;
       rw_t1t_update_tag_state();
@@ -285,18 +295,50 @@ tNFC_STATUS rw_t1t_read_locks(void) {
   tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
   tNFC_STATUS status = NFC_STATUS_CONTINUE;
   uint16_t offset;
+  uint16_t next_offset;
+  uint8_t segment;
+  uint8_t xx;
+  uint8_t adds;
+  bool b_read_seg;
 
   while (num_locks < p_t1t->num_lockbytes) {
     if (p_t1t->lockbyte[num_locks].b_lock_read == false) {
       offset = p_t1t->lock_tlv[p_t1t->lockbyte[num_locks].tlv_index].offset +
                p_t1t->lockbyte[num_locks].byte_index;
+      segment = (uint8_t)(offset / T1T_SEGMENT_SIZE);
       if (offset < T1T_STATIC_SIZE) {
         p_t1t->lockbyte[num_locks].lock_byte = p_t1t->mem[offset];
         p_t1t->lockbyte[num_locks].b_lock_read = true;
+      } else if (rw_t1t_is_segment_cached(segment)) {
+        p_t1t->lockbyte[num_locks].lock_byte =
+            p_t1t->seg_cache[segment][offset % T1T_SEGMENT_SIZE];
+        p_t1t->lockbyte[num_locks].b_lock_read = true;
       } else if (offset < (p_t1t->mem[T1T_CC_TMS_BYTE] + 1) * T1T_BLOCK_SIZE) {
-        /* send READ8 command */
-        p_t1t->block_read = (uint8_t)(offset / T1T_BLOCK_SIZE);
-        status = rw_t1t_send_dyn_cmd(T1T_CMD_READ8, p_t1t->block_read, nullptr);
+        /* Read the whole segment if its lock bytes span several blocks */
+        b_read_seg = false;
+        for (xx = num_locks + 1; (segment > 0) && (xx < p_t1t->num_lockbytes);
+             xx++) {
+          next_offset =
+              p_t1t->lock_tlv[p_t1t->lockbyte[xx].tlv_index].offset +
+              p_t1t->lockbyte[xx].byte_index;
+          if ((p_t1t->lockbyte[xx].b_lock_read == false) &&
+              (next_offset / T1T_SEGMENT_SIZE == segment) &&
+              (next_offset / T1T_BLOCK_SIZE != offset / T1T_BLOCK_SIZE)) {
+            b_read_seg = true;
+            break;
+          }
+        }
+        if (b_read_seg) {
+          /* send RSEG command */
+          p_t1t->segment = segment;
+          RW_T1T_BLD_ADDS((adds), (segment));
+          status = rw_t1t_send_dyn_cmd(T1T_CMD_RSEG, adds, nullptr);
+        } else {
+          /* send READ8 command */
+          p_t1t->block_read = (uint8_t)(offset / T1T_BLOCK_SIZE);
+          status =
+              rw_t1t_send_dyn_cmd(T1T_CMD_READ8, p_t1t->block_read, nullptr);
+        }
         if (status == NFC_STATUS_OK) {
           /* Reading Locks */
           status = NFC_STATUS_CONTINUE;
@@ -602,6 +644,8 @@ tNFC_STATUS rw_t1t_handle_read_rsp(bool* p_notify, uint8_t* p_data) {
     case RW_T1T_STATE_TLV_DETECT:
       switch (p_t1t->substate) {
         case RW_T1T_SUBSTATE_WAIT_READ_LOCKS:
+          /* Locks may have been read with RSEG of another segment */
+          p_t1t->segment = 0;
           status = rw_t1t_read_locks();
           if (status != NFC_STATUS_CONTINUE) {
             rw_t1t_update_lock_attributes();
@@ -1150,7 +1194,6 @@ static tNFC_STATUS rw_t1t_handle_ndef_rall_rsp(void) {
   tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
   tNFC_STATUS status = NFC_STATUS_CONTINUE;
   uint8_t count;
-  uint8_t adds;
 
   count = (uint8_t)p_t1t->ndef_msg_offset;
   p_t1t->work_offset = 0;
@@ -1165,29 +1208,13 @@ static tNFC_STATUS rw_t1t_handle_ndef_rall_rsp(void) {
   }
   if (p_t1t->work_offset != p_t1t->ndef_msg_len) {
     if ((p_t1t->hr[0] & 0x0F) != 1) {
-      if (p_t1t->work_offset == 0)
-        return NFC_STATUS_FAILED;
+      if (p_t1t->work_offset == 0) return NFC_STATUS_FAILED;
 
-      else {
-        p_t1t->block_read = T1T_STATIC_BLOCKS + 1;
-        p_t1t->segment++;
-      }
-      if (p_t1t->ndef_msg_len - p_t1t->work_offset <= 8) {
-        status = rw_t1t_send_dyn_cmd(T1T_CMD_READ8, p_t1t->block_read, nullptr);
-        if (status == NFC_STATUS_OK) {
-          p_t1t->tlv_detect = TAG_NDEF_TLV;
-          p_t1t->state = RW_T1T_STATE_READ_NDEF;
-          status = NFC_STATUS_CONTINUE;
-        }
-      } else {
-        /* send RSEG command */
-        RW_T1T_BLD_ADDS((adds), (p_t1t->segment));
-        status = rw_t1t_send_dyn_cmd(T1T_CMD_RSEG, adds, nullptr);
-        if (status == NFC_STATUS_OK) {
-          p_t1t->state = RW_T1T_STATE_READ_NDEF;
-          status = NFC_STATUS_CONTINUE;
-        }
-      }
+      /* Continue from the first block of the next segment */
+      p_t1t->read_offset = T1T_SEGMENT_SIZE;
+      p_t1t->tlv_detect = TAG_NDEF_TLV;
+      p_t1t->state = RW_T1T_STATE_READ_NDEF;
+      status = rw_t1t_read_next_ndef_bytes();
     } else {
       LOG(ERROR) << StringPrintf(
           "RW_T1tReadNDef - Invalid NDEF len: %u or NDEF corrupted",
@@ -1213,78 +1240,132 @@ static tNFC_STATUS rw_t1t_handle_ndef_rall_rsp(void) {
 **
 *******************************************************************************/
 static tNFC_STATUS rw_t1t_handle_ndef_read_rsp(uint8_t* p_data) {
-  tNFC_STATUS ndef_status = NFC_STATUS_CONTINUE;
   tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
-  uint8_t index;
-  uint8_t adds;
+  uint16_t start;
+  uint16_t len;
+  uint16_t index;
   tT1T_CMD_RSP_INFO* p_cmd_rsp_info =
       (tT1T_CMD_RSP_INFO*)rw_cb.tcb.t1t.p_cmd_rsp_info;
 
   /* The Response received could be for Read8 or Read Segment command */
   switch (p_cmd_rsp_info->opcode) {
     case T1T_CMD_READ8:
-      if (p_t1t->work_offset == 0) {
-        index = p_t1t->ndef_msg_offset % T1T_BLOCK_SIZE;
-      } else {
-        index = 0;
-      }
-      p_t1t->segment = (p_t1t->block_read * T1T_BLOCK_SIZE) / T1T_SEGMENT_SIZE;
-      while (index < T1T_BLOCK_SIZE &&
-             p_t1t->work_offset < p_t1t->ndef_msg_len) {
-        if (rw_t1t_is_lock_reserved_otp_byte(
-                (uint16_t)((p_t1t->block_read * T1T_BLOCK_SIZE) + index)) ==
-            false) {
-          p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
-          p_t1t->work_offset++;
-        }
-        index++;
-      }
+      start = p_t1t->block_read * T1T_BLOCK_SIZE;
+      len = T1T_BLOCK_SIZE;
       break;
 
     case T1T_CMD_RSEG:
-      if (p_t1t->work_offset == 0) {
-        index = p_t1t->ndef_msg_offset % T1T_SEGMENT_SIZE;
-      } else {
-        index = 0;
-      }
-      p_t1t->block_read = ((p_t1t->segment + 1) * T1T_BLOCKS_PER_SEGMENT) - 1;
-
-      while (index < T1T_SEGMENT_SIZE &&
-             p_t1t->work_offset < p_t1t->ndef_msg_len) {
-        if (rw_t1t_is_lock_reserved_otp_byte((uint16_t)(index)) == false) {
-          p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
-          p_t1t->work_offset++;
-        }
-        index++;
-      }
+      start = p_t1t->segment * T1T_SEGMENT_SIZE;
+      len = T1T_SEGMENT_SIZE;
       break;
 
     default:
-      break;
+      return NFC_STATUS_FAILED;
   }
-  if (p_t1t->work_offset < p_t1t->ndef_msg_len) {
-    if ((p_t1t->hr[0] & 0x0F) != 1) {
-      if ((p_t1t->ndef_msg_len - p_t1t->work_offset) <= T1T_BLOCK_SIZE) {
-        p_t1t->block_read++;
-        ndef_status = rw_t1t_send_dyn_cmd(
-            T1T_CMD_READ8, (uint8_t)(p_t1t->block_read), nullptr);
-        if (ndef_status == NFC_STATUS_OK) {
-          ndef_status = NFC_STATUS_CONTINUE;
-        }
-      } else {
-        p_t1t->segment++;
-        /* send RSEG command */
-        RW_T1T_BLD_ADDS((adds), (p_t1t->segment));
-        ndef_status = rw_t1t_send_dyn_cmd(T1T_CMD_RSEG, adds, nullptr);
-        if (ndef_status == NFC_STATUS_OK) {
-          ndef_status = NFC_STATUS_CONTINUE;
-        }
-      }
+
+  if ((p_t1t->read_offset < start) || (p_t1t->read_offset >= start + len)) {
+    LOG(ERROR) << StringPrintf(
+        "%s - Unexpected response, offset: %u not in [%u, %u)", __func__,
+        p_t1t->read_offset, start, start + len);
+    return NFC_STATUS_FAILED;
+  }
+
+  p_t1t->segment = (uint8_t)(start / T1T_SEGMENT_SIZE);
+  index = p_t1t->read_offset - start;
+  while (index < len && p_t1t->work_offset < p_t1t->ndef_msg_len) {
+    if (rw_t1t_is_lock_reserved_otp_byte((uint16_t)(start + index)) ==
+        false) {
+      p_t1t->p_ndef_buffer[p_t1t->work_offset] = p_data[index];
+      p_t1t->work_offset++;
     }
+    index++;
+  }
+  p_t1t->read_offset = start + index;
+
+  return rw_t1t_read_next_ndef_bytes();
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_is_segment_cached
+**
+** Description      Check if a segment of the tag was read since activation
+**
+** Returns          TRUE, if the segment content is in the segment cache
+**
+*******************************************************************************/
+static bool rw_t1t_is_segment_cached(uint8_t segment) {
+  tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
+
+  return (segment < RW_T1T_MAX_CACHED_SEGMENTS) &&
+         (p_t1t->cached_segs & (1 << segment));
+}
+
+/*******************************************************************************
+**
+** Function         rw_t1t_read_next_ndef_bytes
+**
+** Description      Collect NDEF bytes starting at read_offset. Bytes of
+**                  segments already read are taken from the segment cache.
+**                  Otherwise READ8 is sent if the current block holds all the
+**                  remaining NDEF bytes, and RSEG if not.
+**
+** Returns          NFC_STATUS_CONTINUE, if a read command was sent
+**                  NFC_STATUS_OK, if the whole NDEF message is collected
+**                  NFC_STATUS_FAILED, otherwise
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t1t_read_next_ndef_bytes(void) {
+  tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
+  uint16_t tag_size = (p_t1t->mem[T1T_CC_TMS_BYTE] + 1) * T1T_BLOCK_SIZE;
+  uint16_t offset = p_t1t->read_offset;
+  uint16_t block_end;
+  uint16_t avail = 0;
+  uint8_t segment;
+  uint8_t adds;
+  tNFC_STATUS status;
+
+  while ((p_t1t->work_offset < p_t1t->ndef_msg_len) && (offset < tag_size)) {
+    segment = (uint8_t)(offset / T1T_SEGMENT_SIZE);
+    if (!rw_t1t_is_segment_cached(segment)) break;
+
+    p_t1t->segment = segment;
+    if (rw_t1t_is_lock_reserved_otp_byte(offset) == false) {
+      p_t1t->p_ndef_buffer[p_t1t->work_offset] =
+          p_t1t->seg_cache[segment][offset % T1T_SEGMENT_SIZE];
+      p_t1t->work_offset++;
+    }
+    offset++;
+  }
+  p_t1t->read_offset = offset;
+
+  if (p_t1t->work_offset >= p_t1t->ndef_msg_len) return NFC_STATUS_OK;
+
+  if (offset >= tag_size) {
+    LOG(ERROR) << StringPrintf(
+        "%s - Invalid NDEF len: %u or NDEF corrupted", __func__,
+        p_t1t->ndef_msg_len);
+    return NFC_STATUS_FAILED;
+  }
+
+  /* Count the NDEF bytes still available in the current block */
+  p_t1t->segment = (uint8_t)(offset / T1T_SEGMENT_SIZE);
+  p_t1t->block_read = (uint8_t)(offset / T1T_BLOCK_SIZE);
+  block_end = (p_t1t->block_read + 1) * T1T_BLOCK_SIZE;
+  while (offset < block_end) {
+    if (rw_t1t_is_lock_reserved_otp_byte(offset) == false) avail++;
+    offset++;
+  }
+
+  if ((p_t1t->ndef_msg_len - p_t1t->work_offset) <= avail) {
+    status = rw_t1t_send_dyn_cmd(T1T_CMD_READ8, p_t1t->block_read, nullptr);
   } else {
-    ndef_status = NFC_STATUS_OK;
+    /* send RSEG command */
+    RW_T1T_BLD_ADDS((adds), (p_t1t->segment));
+    status = rw_t1t_send_dyn_cmd(T1T_CMD_RSEG, adds, nullptr);
   }
-  return ndef_status;
+
+  return (status == NFC_STATUS_OK) ? NFC_STATUS_CONTINUE : NFC_STATUS_FAILED;
 }
 
 /*******************************************************************************
@@ -2202,6 +2283,7 @@ tNFC_STATUS RW_T1tFormatNDef(void) {
       p_t1t->state = RW_T1T_STATE_FORMAT_TAG;
       p_t1t->b_update = false;
       p_t1t->b_rseg = false;
+      p_t1t->cached_segs = 0;
       if (p_ret->b_dynamic)
         p_t1t->substate = RW_T1T_SUBSTATE_WAIT_SET_CC;
       else
@@ -2219,6 +2301,7 @@ tNFC_STATUS RW_T1tFormatNDef(void) {
       p_t1t->substate = RW_T1T_SUBSTATE_WAIT_SET_NULL_NDEF;
       p_t1t->b_update = false;
       p_t1t->b_rseg = false;
+      p_t1t->cached_segs = 0;
     }
   }
 
@@ -2323,11 +2406,9 @@ tNFC_STATUS RW_T1tReadNDef(uint8_t* p_buffer, uint16_t buf_len) {
   tNFC_STATUS status = NFC_STATUS_FAILED;
   tRW_T1T_CB* p_t1t = &rw_cb.tcb.t1t;
   bool b_notify;
-  uint8_t adds;
+  tRW_DATA rw_data;
   const tT1T_CMD_RSP_INFO* p_cmd_rsp_info_rall =
       t1t_cmd_to_rsp_info(T1T_CMD_RALL);
-  const tT1T_CMD_RSP_INFO* p_cmd_rsp_info_rseg =
-      t1t_cmd_to_rsp_info(T1T_CMD_RSEG);
 
   if (p_t1t->state != RW_T1T_STATE_IDLE) {
     LOG(WARNING) << StringPrintf("RW_T1tReadNDef - Busy - State: %u",
@@ -2365,13 +2446,25 @@ tNFC_STATUS RW_T1tReadNDef(uint8_t* p_buffer, uint16_t buf_len) {
   }
   p_t1t->p_ndef_buffer = p_buffer;
 
-  if (p_t1t->b_rseg == true) {
-    /* If already got response to RSEG 0 */
+  if ((p_t1t->hr[0] & 0x0F) != 1) {
+    /* Dynamic memory: use segments read since activation, then RSEG/READ8 */
+    p_t1t->work_offset = 0;
+    p_t1t->read_offset = p_t1t->ndef_msg_offset;
     p_t1t->state = RW_T1T_STATE_READ_NDEF;
-    p_t1t->p_cmd_rsp_info = (tT1T_CMD_RSP_INFO*)p_cmd_rsp_info_rseg;
 
-    rw_t1t_handle_read_rsp(&b_notify, p_t1t->mem);
-    status = NFC_STATUS_OK;
+    status = rw_t1t_read_next_ndef_bytes();
+    if (status == NFC_STATUS_CONTINUE) {
+      status = NFC_STATUS_OK;
+    } else if (status == NFC_STATUS_OK) {
+      LOG(VERBOSE) << StringPrintf(
+          "RW_T1tReadNDef - NDEF read from cached segments");
+      rw_data.data.status = NFC_STATUS_OK;
+      rw_data.data.p_data = nullptr;
+      rw_t1t_handle_op_complete();
+      (*rw_cb.p_cback)(RW_T1T_NDEF_READ_EVT, &rw_data);
+    } else {
+      p_t1t->state = RW_T1T_STATE_IDLE;
+    }
   } else if (p_t1t->b_update == true) {
     /* If already got response to RALL */
     p_t1t->state = RW_T1T_STATE_READ_NDEF;
@@ -2383,13 +2476,7 @@ tNFC_STATUS RW_T1tReadNDef(uint8_t* p_buffer, uint16_t buf_len) {
   } else {
     p_t1t->segment = 0;
     p_t1t->work_offset = 0;
-    if ((p_t1t->hr[0] & 0x0F) != 1) {
-      /* send RSEG command */
-      RW_T1T_BLD_ADDS((adds), (p_t1t->segment));
-      status = rw_t1t_send_dyn_cmd(T1T_CMD_RSEG, adds, nullptr);
-    } else {
-      status = rw_t1t_send_static_cmd(T1T_CMD_RALL, 0, 0);
-    }
+    status = rw_t1t_send_static_cmd(T1T_CMD_RALL, 0, 0);
     if (status == NFC_STATUS_OK) p_t1t->state = RW_T1T_STATE_READ_NDEF;
   }
 
@@ -2481,6 +2568,7 @@ tNFC_STATUS RW_T1tWriteNDef(uint16_t msg_len, uint8_t* p_msg) {
 
   p_t1t->b_update = false;
   p_t1t->b_rseg = false;
+  p_t1t->cached_segs = 0;
 
   if ((p_t1t->hr[0] & 0x0F) != 1) {
     /* Dynamic data structure */
@@ -2544,6 +2632,7 @@ tNFC_STATUS RW_T1tSetTagReadOnly(bool b_hard_lock) {
     if (status == NFC_STATUS_OK) {
       p_t1t->b_update = false;
       p_t1t->b_rseg = false;
+      p_t1t->cached_segs = 0;
 
       if (p_t1t->b_hard_lock) {
         num_locks = 0;
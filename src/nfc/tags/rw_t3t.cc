@@ -39,12 +39,11 @@ using android::base::StringPrintf;
 
 /* Definitions for constructing t3t command messages */
 #define RW_T3T_FL_PADDING 0x01 /* Padding needed for last NDEF block */
-/* Maximum number of NDEF blocks updates that can fit into one command (when all
- * block-numbers are < 256) */
-#define RW_T3T_MAX_NDEF_BLOCKS_PER_UPDATE_1_BYTE_FORMAT (13)
-/* Maximum number of NDEF blocks updates that can fit into one command (when all
- * block-numbers are >= 256) */
-#define RW_T3T_MAX_NDEF_BLOCKS_PER_UPDATE_2_BYTE_FORMAT (12)
+/* Maximum length of a NFC-F frame, including SoD */
+#define RW_T3T_MAX_FRAME_LEN 255
+/* Length of UPDATE command header: SoD + cmdcode + NFCID2 + num_services +
+ * service code + num_blocks */
+#define RW_T3T_UPDATE_NDEF_HDR_LEN (T3T_MSG_CMD_COMMON_HDR_LEN + 2 + 1)
 
 /* Definitions for SENSF_RES */
 /* Offset of RD in SENSF_RES from NCI_POLL NTF (includes 1 byte SENSF_RES
@@ -742,6 +741,36 @@ tNFC_STATUS rw_t3t_send_update_ndef_attribute_cmd(tRW_T3T_CB* p_cb,
   return (retval);
 }
 
+/*****************************************************************************
+**
+** Function         rw_t3t_max_ndef_blocks_per_update
+**
+** Description      Get the number of NDEF blocks that can be written using
+**                  one UPDATE command, starting at first_block. The count is
+**                  limited by NBw and by the size of one NFC-F frame, block
+**                  list elements being 2 bytes for block-numbers < 256 and 3
+**                  bytes otherwise.
+**
+** Returns          number of blocks
+**
+*****************************************************************************/
+static uint8_t rw_t3t_max_ndef_blocks_per_update(tRW_T3T_CB* p_cb,
+                                                 uint16_t first_block) {
+  uint16_t cmd_len = RW_T3T_UPDATE_NDEF_HDR_LEN;
+  uint16_t block_len;
+  uint8_t num_blocks = 0;
+
+  while (num_blocks < p_cb->ndef_attrib.nbw) {
+    block_len = T3T_MSG_BLOCKSIZE +
+                (((first_block + num_blocks) < 256) ? 2 : 3);
+    if ((cmd_len + block_len) > RW_T3T_MAX_FRAME_LEN) break;
+    cmd_len += block_len;
+    num_blocks++;
+  }
+
+  return num_blocks;
+}
+
 /*****************************************************************************
 **
 ** Function         rw_t3t_send_next_ndef_update_cmd
@@ -785,22 +814,16 @@ tNFC_STATUS rw_t3t_send_next_ndef_update_cmd(tRW_T3T_CB* p_cb) {
     /* Calculate first NDEF block ID for this UPDATE command */
     first_block_to_write = (uint16_t)((p_cb->ndef_msg_bytes_sent >> 4) + 1);
 
-    /* Calculate max number of blocks per write. */
-    if ((first_block_to_write +
-         RW_T3T_MAX_NDEF_BLOCKS_PER_UPDATE_1_BYTE_FORMAT) < 0x100) {
-      /* All block-numbers are < 0x100 (i.e. can be specified using one-byte
-       * format) */
-      blocks_per_update = RW_T3T_MAX_NDEF_BLOCKS_PER_UPDATE_1_BYTE_FORMAT;
-    } else {
-      /* Block-numbers are >= 0x100 (i.e. need to be specified using two-byte
-       * format) */
-      blocks_per_update = RW_T3T_MAX_NDEF_BLOCKS_PER_UPDATE_2_BYTE_FORMAT;
+    /* Calculate max number of blocks per write, as allowed by the peer and
+     * by the frame size */
+    blocks_per_update =
+        rw_t3t_max_ndef_blocks_per_update(p_cb, first_block_to_write);
+    if (blocks_per_update == 0) {
+      LOG(ERROR) << StringPrintf("%s - Nbw=0, cannot update NDEF", __func__);
+      GKI_freebuf(p_cmd_buf);
+      return NFC_STATUS_FAILED;
     }
 
-    /* Check if blocks_per_update is bigger than what peer allows */
-    if (blocks_per_update > p_cb->ndef_attrib.nbw)
-      blocks_per_update = p_cb->ndef_attrib.nbw;
-
     /* Check if remaining blocks can fit into one UPDATE command */
     if (ndef_blocks_remaining <= blocks_per_update) {
       /* remaining blocks can fit into one UPDATE command */
@@ -909,6 +932,7 @@ tNFC_STATUS rw_t3t_send_next_ndef_check_cmd(tRW_T3T_CB* p_cb) {
   uint32_t ndef_bytes_remaining;
   NFC_HDR* p_cmd_buf;
   uint8_t *p_cmd_start, *p;
+  uint8_t blocks_per_check;
 
   p_cmd_buf = rw_t3t_get_cmd_buf();
   if (p_cmd_buf != nullptr) {
@@ -931,18 +955,22 @@ tNFC_STATUS rw_t3t_send_next_ndef_check_cmd(tRW_T3T_CB* p_cb) {
     /* Calculate first NDEF block ID */
     first_block_to_read = (uint16_t)((p_cb->ndef_rx_offset >> 4) + 1);
 
+    /* Read maximum number of blocks allowed by the peer, as long as the
+     * CHECK response fits into one NFC-F frame */
+    blocks_per_check = p_cb->ndef_attrib.nbr;
+    if (blocks_per_check > T3T_MSG_NUM_BLOCKS_CHECK_MAX)
+      blocks_per_check = T3T_MSG_NUM_BLOCKS_CHECK_MAX;
+
     /* Check if remaining blocks can fit into one CHECK command */
-    if (ndef_blocks_remaining <= p_cb->ndef_attrib.nbr) {
+    if (ndef_blocks_remaining <= blocks_per_check) {
       /* remaining blocks can fit into one CHECK command */
       cur_blocks_to_read = ndef_blocks_remaining;
       p_cb->ndef_rx_readlen = ndef_bytes_remaining;
       p_cb->flags |= RW_T3T_FL_IS_FINAL_NDEF_SEGMENT;
     } else {
       /* Remaining blocks cannot fit into one CHECK command */
-      cur_blocks_to_read =
-          p_cb->ndef_attrib
-              .nbr; /* Read maximum number of blocks allowed by the peer */
-      p_cb->ndef_rx_readlen = ((uint32_t)p_cb->ndef_attrib.nbr * 16);
+      cur_blocks_to_read = blocks_per_check;
+      p_cb->ndef_rx_readlen = ((uint32_t)blocks_per_check * 16);
     }
 
     LOG(VERBOSE) << StringPrintf(
@@ -1366,10 +1394,16 @@ void rw_t3t_act_handle_ndef_detect_rsp(tRW_T3T_CB* p_cb, NFC_HDR* p_msg_rsp) {
             p_cb->ndef_attrib.nbr, p_cb->ndef_attrib.nbw,
             p_cb->ndef_attrib.nmaxb, p_cb->ndef_attrib.writef,
             p_cb->ndef_attrib.rwflag, p_cb->ndef_attrib.ln);
-        if (p_cb->ndef_attrib.nbr > T3T_MSG_NUM_BLOCKS_CHECK_MAX ||
-            p_cb->ndef_attrib.nbw > T3T_MSG_NUM_BLOCKS_UPDATE_MAX) {
-          /* It would result in CHECK Responses exceeding the maximum length
-           * of an NFC-F Frame */
+        if ((p_cb->ndef_attrib.nbr > T3T_MSG_NUM_BLOCKS_CHECK_MAX) ||
+            (p_cb->ndef_attrib.nbw > T3T_MSG_NUM_BLOCKS_UPDATE_MAX)) {
+          /* CHECK and UPDATE commands are limited to what fits into one
+           * NFC-F Frame */
+          LOG(VERBOSE) << StringPrintf(
+              "Nbr=%i, Nbw=%i limited by NFC-F frame size",
+              p_cb->ndef_attrib.nbr, p_cb->ndef_attrib.nbw);
+        }
+        if (p_cb->ndef_attrib.nbr == 0) {
+          /* NDEF could not be read */
           LOG(ERROR) << StringPrintf(
               "Unsupported NDEF Attributes value: Nbr=%i, Nbw=%i, Nmaxb=%i,"
               "WriteF=%i, RWFlag=%i, Ln=%i",
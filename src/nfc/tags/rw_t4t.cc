@@ -91,6 +91,7 @@ static std::string rw_t4t_get_state_name(uint8_t state);
 static std::string rw_t4t_get_sub_state_name(uint8_t sub_state);
 
 static bool rw_t4t_send_to_lower(NFC_HDR* p_c_apdu);
+static NFC_HDR* rw_t4t_get_capdu_buf(uint32_t length);
 static bool rw_t4t_select_file(uint16_t file_id);
 static bool rw_t4t_read_file(uint32_t offset, uint32_t length,
                              bool is_continue);
@@ -98,6 +99,8 @@ static bool rw_t4t_update_nlen(uint32_t ndef_len);
 static bool rw_t4t_update_file(void);
 static bool rw_t4t_update_cc_to_readonly(void);
 static bool rw_t4t_select_application(uint8_t version);
+static bool rw_t4t_select_ndef_file(void);
+static void rw_t4t_invalidate_selection(void);
 static bool rw_t4t_validate_cc_file(void);
 
 static bool rw_t4t_get_hw_version(void);
@@ -117,6 +120,42 @@ static void rw_t4t_data_cback(uint8_t conn_id, tNFC_CONN_EVT event,
                               tNFC_CONN* p_data);
 static void rw_t4t_sm_ndef_format(NFC_HDR* p_r_apdu);
 
+/*******************************************************************************
+**
+** Function         rw_t4t_ext_xfer_size
+**
+** Description      Get the number of bytes an extended length C-APDU carries
+**                  and asks for, i.e. its Lc plus its Le
+**
+** Returns          Lc + Le, 0 for a short length C-APDU
+**
+*******************************************************************************/
+static uint32_t rw_t4t_ext_xfer_size(NFC_HDR* p_c_apdu) {
+  uint8_t* p = (uint8_t*)(p_c_apdu + 1) + p_c_apdu->offset;
+  uint16_t len = p_c_apdu->len;
+  uint32_t lc = 0, le = 0;
+
+  /* CLA INS P1 P2 followed by 00 and a 2 byte Lc or Le */
+  if ((len < T4T_CMD_MIN_HDR_SIZE + 3) || (p[T4T_CMD_MIN_HDR_SIZE] != 0x00))
+    return 0;
+  p += T4T_CMD_MIN_HDR_SIZE + 1;
+  len -= T4T_CMD_MIN_HDR_SIZE + 3;
+
+  if (len == 0) {
+    /* Le only, 0000 means 65536 */
+    BE_STREAM_TO_UINT16(le, p);
+    if (le == 0) le = 0x10000;
+  } else {
+    BE_STREAM_TO_UINT16(lc, p);
+    if (len == lc + 2) {
+      p += lc;
+      BE_STREAM_TO_UINT16(le, p);
+      if (le == 0) le = 0x10000;
+    }
+  }
+  return lc + le;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_send_to_lower
@@ -127,17 +166,51 @@ static void rw_t4t_sm_ndef_format(NFC_HDR* p_r_apdu);
 **
 *******************************************************************************/
 static bool rw_t4t_send_to_lower(NFC_HDR* p_c_apdu) {
+  tRW_T4T_CB* p_t4t = &rw_cb.tcb.t4t;
+  uint32_t tout = RW_T4T_TOUT_RESP;
+
+  /* Extended length APDUs may take longer than RW_T4T_TOUT_RESP on the air,
+   * allow for the Lc and Le of this one */
+  tout += (rw_t4t_ext_xfer_size(p_c_apdu) * RW_T4T_TOUT_RESP_PER_KB) / 1024;
+
   if (NFC_SendData(NFC_RF_CONN_ID, p_c_apdu) != NFC_STATUS_OK) {
     LOG(ERROR) << StringPrintf("failed");
     return false;
   }
 
-  nfc_start_quick_timer(&rw_cb.tcb.t4t.timer, NFC_TTYPE_RW_T4T_RESPONSE,
-                        (RW_T4T_TOUT_RESP * QUICK_TIMER_TICKS_PER_SEC) / 1000);
+  nfc_start_quick_timer(&p_t4t->timer, NFC_TTYPE_RW_T4T_RESPONSE,
+                        (tout * QUICK_TIMER_TICKS_PER_SEC) / 1000);
 
   return true;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t4t_get_capdu_buf
+**
+** Description      Allocate a buffer for a C-APDU carrying up to length bytes
+**                  of data. Extended Field Coding commands which do not fit
+**                  in NFC_RW_POOL_ID are allocated from a bigger pool.
+**
+** Returns          Pointer to the buffer, nullptr if failure
+**
+*******************************************************************************/
+static NFC_HDR* rw_t4t_get_capdu_buf(uint32_t length) {
+  uint32_t size = NFC_HDR_SIZE + NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE +
+                  T4T_CMD_MAX_EXT_HDR_SIZE + length;
+
+  if (size <= NFC_RW_POOL_BUF_SIZE) {
+    return (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
+  }
+
+  if (size > GKI_MAX_BUF_SIZE) {
+    LOG(ERROR) << StringPrintf("%s - C-APDU too big (%d)", __func__, length);
+    return nullptr;
+  }
+
+  return (NFC_HDR*)GKI_getbuf((uint16_t)size);
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_set_ber_tlv
@@ -763,6 +836,9 @@ static bool rw_t4t_select_file(uint16_t file_id) {
 
   LOG(VERBOSE) << StringPrintf("%s - File ID:0x%04X", __func__, file_id);
 
+  /* selected file is unknown until response is received */
+  rw_cb.tcb.t4t.selected_file = RW_T4T_FILE_ID_NONE;
+
   p_c_apdu = (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
 
   if (!p_c_apdu) {
@@ -997,13 +1073,6 @@ static bool rw_t4t_update_file(void) {
   LOG(VERBOSE) << StringPrintf("%s - rw_offset:%d, rw_length:%d", __func__,
                              p_t4t->rw_offset, p_t4t->rw_length);
 
-  p_c_apdu = (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
-
-  if (!p_c_apdu) {
-    LOG(ERROR) << StringPrintf("%s - Cannot allocate buffer", __func__);
-    return false;
-  }
-
   /* try to send all of remaining data */
   length = p_t4t->rw_length;
 
@@ -1019,6 +1088,13 @@ static bool rw_t4t_update_file(void) {
     length = (uint32_t)(p_t4t->max_update_size);
   }
 
+  p_c_apdu = rw_t4t_get_capdu_buf(length);
+
+  if (!p_c_apdu) {
+    LOG(ERROR) << StringPrintf("%s - Cannot allocate buffer", __func__);
+    return false;
+  }
+
   p_c_apdu->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
   p = (uint8_t*)(p_c_apdu + 1) + p_c_apdu->offset;
 
@@ -1046,18 +1122,26 @@ static bool rw_t4t_update_file(void) {
     UINT8_TO_BE_STREAM(p, T4T_CMD_INS_UPDATE_BINARY);
     UINT16_TO_BE_STREAM(p, p_t4t->rw_offset);
 
-    /* Lc field encoded using Short Field Coding */
-    if (length > T4T_MAX_LENGTH_LC) {
-      /* Write a max of 255 bytes,
-       * as Lc=00 is reserved for Extended Field coding */
-      length = T4T_MAX_LENGTH_LC;
+    if ((length > T4T_MAX_LENGTH_LC) &&
+        (p_t4t->intl_flags & RW_T4T_EXT_FIELD_CODING)) {
+      /* Lc field encoded using Extended Field Coding,
+       * coded over three bytes with first one null */
+      UINT8_TO_BE_STREAM(p, 0x00);
+      UINT16_TO_BE_STREAM(p, length);
+      p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + 2 + length;
+    } else {
+      /* Lc field encoded using Short Field Coding */
+      if (length > T4T_MAX_LENGTH_LC) {
+        /* Write a max of 255 bytes,
+         * as Lc=00 is reserved for Extended Field coding */
+        length = T4T_MAX_LENGTH_LC;
+      }
+      UINT8_TO_BE_STREAM(p, length);
+      p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + length;
     }
-    UINT8_TO_BE_STREAM(p, length);
 
     memcpy(p, p_t4t->p_update_data, length);
 
-    p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + length;
-
     if (!rw_t4t_send_to_lower(p_c_apdu)) {
       return false;
     }
@@ -1140,6 +1224,10 @@ static bool rw_t4t_select_application(uint8_t version) {
 
   LOG(VERBOSE) << StringPrintf("%s - version:0x%X", __func__, version);
 
+  /* selecting an application resets the file selection */
+  rw_cb.tcb.t4t.intl_flags &= ~RW_T4T_NDEF_APP_SELECTED;
+  rw_cb.tcb.t4t.selected_file = RW_T4T_FILE_ID_NONE;
+
   p_c_apdu = (NFC_HDR*)GKI_getpoolbuf(NFC_RW_POOL_ID);
 
   if (!p_c_apdu) {
@@ -1184,6 +1272,50 @@ static bool rw_t4t_select_application(uint8_t version) {
   return true;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t4t_select_ndef_file
+**
+** Description      Restore selection of NDEF file before NDEF operation,
+**                  selecting NDEF Tag Application first if it is not known
+**                  to be selected anymore
+**
+** Returns          TRUE if success
+**
+*******************************************************************************/
+static bool rw_t4t_select_ndef_file(void) {
+  tRW_T4T_CB* p_t4t = &rw_cb.tcb.t4t;
+
+  if (!(p_t4t->intl_flags & RW_T4T_NDEF_APP_SELECTED)) {
+    if (!rw_t4t_select_application(p_t4t->version)) {
+      return false;
+    }
+    p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_APP;
+  } else {
+    if (!rw_t4t_select_file(p_t4t->cc_file.ndef_fc.file_id)) {
+      return false;
+    }
+    p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE;
+  }
+
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t4t_invalidate_selection
+**
+** Description      Forget application and file selected on the tag, they
+**                  will be selected again by the next operation
+**
+** Returns          none
+**
+*******************************************************************************/
+static void rw_t4t_invalidate_selection(void) {
+  rw_cb.tcb.t4t.intl_flags &= ~RW_T4T_NDEF_APP_SELECTED;
+  rw_cb.tcb.t4t.selected_file = RW_T4T_FILE_ID_NONE;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t4t_validate_cc_file
@@ -1291,6 +1423,9 @@ static void rw_t4t_handle_error(tNFC_STATUS status, uint8_t sw1, uint8_t sw2) {
 
   nfc_stop_quick_timer(&p_t4t->timer);
 
+  /* state of the tag is unknown after failure */
+  rw_t4t_invalidate_selection();
+
   if (rw_cb.p_cback) {
     rw_data.status = status;
 
@@ -1573,6 +1708,7 @@ static void rw_t4t_sm_detect_ndef(NFC_HDR* p_r_apdu) {
     case RW_T4T_SUBSTATE_WAIT_SELECT_APP:
 
       /* NDEF Tag application has been selected then select CC file */
+      p_t4t->intl_flags |= RW_T4T_NDEF_APP_SELECTED;
       if (!rw_t4t_select_file(T4T_CC_FILE_ID)) {
         rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
       } else {
@@ -1583,6 +1719,7 @@ static void rw_t4t_sm_detect_ndef(NFC_HDR* p_r_apdu) {
     case RW_T4T_SUBSTATE_WAIT_SELECT_CC:
 
       /* CC file has been selected then read mandatory part of CC file */
+      p_t4t->selected_file = T4T_CC_FILE_ID;
       cc_file_offset = 0x00;
       if (!rw_t4t_read_file(cc_file_offset, cc_file_rsp_len, false)) {
         rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
@@ -1715,6 +1852,7 @@ static void rw_t4t_sm_detect_ndef(NFC_HDR* p_r_apdu) {
     case RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE:
 
       /* NDEF file has been selected then read the first 2 bytes (NLEN) */
+      p_t4t->selected_file = p_t4t->cc_file.ndef_fc.file_id;
       if (!rw_t4t_read_file(0, p_t4t->cc_file.ndef_fc.nlen_size, false)) {
         rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
       } else {
@@ -1744,7 +1882,17 @@ static void rw_t4t_sm_detect_ndef(NFC_HDR* p_r_apdu) {
           }
 
           /* Get max bytes to read per command */
-          if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ) {
+          if (p_t4t->cc_file.max_le > T4T_MAX_LENGTH_LE + 1) {
+            /* Le: valid range is 0x0001 to 0xFFFF */
+            /* Extended Field Coding supported by the tag, read as much
+             * as the R-APDU reassembly buffer can hold */
+            p_t4t->intl_flags |= RW_T4T_EXT_FIELD_CODING;
+            if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ_EXT) {
+              p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_READ_EXT;
+            } else {
+              p_t4t->max_read_size = p_t4t->cc_file.max_le;
+            }
+          } else if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ) {
             p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_READ;
           } else {
             p_t4t->max_read_size = p_t4t->cc_file.max_le;
@@ -1753,24 +1901,25 @@ static void rw_t4t_sm_detect_ndef(NFC_HDR* p_r_apdu) {
           LOG(VERBOSE) << StringPrintf("%s -    max_read_size:      0x%04X",
                                      __func__, p_t4t->max_read_size);
 
-          /* Le: valid range is 0x0001 to 0xFFFF */
-          if (p_t4t->max_read_size > T4T_MAX_LENGTH_LE + 1) {
-            /* Extended Field Coding supported by the tag */
-            p_t4t->intl_flags |= RW_T4T_EXT_FIELD_CODING;
-          }
-
           /* Get max bytes to update per command */
-          if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE) {
+          if (p_t4t->cc_file.max_lc > T4T_MAX_LENGTH_LC) {
+            /* Lc: valid range is 0x0001 to 0xFFFF */
+            /* Extended Field Coding supported by the tag, C-APDU is
+             * segmented by NCI */
+            p_t4t->intl_flags |= RW_T4T_EXT_FIELD_CODING;
+            if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE_EXT) {
+              p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_WRITE_EXT;
+            } else {
+              p_t4t->max_update_size = p_t4t->cc_file.max_lc;
+            }
+          } else if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE) {
             p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_WRITE;
           } else {
             p_t4t->max_update_size = p_t4t->cc_file.max_lc;
           }
 
-          /* Lc: valid range is 0x0001 to 0xFFFF */
-          if (p_t4t->max_update_size > T4T_MAX_LENGTH_LC) {
-            /* Extended Field Coding supported by the tag */
-            p_t4t->intl_flags |= RW_T4T_EXT_FIELD_CODING;
-          }
+          LOG(VERBOSE) << StringPrintf("%s -    max_update_size:    0x%04X",
+                                     __func__, p_t4t->max_update_size);
 
           p_t4t->ndef_length = nlen;
           p_t4t->state = RW_T4T_STATE_IDLE;
@@ -1853,6 +2002,27 @@ static void rw_t4t_sm_read_ndef(NFC_HDR* p_r_apdu) {
   }
 
   switch (p_t4t->sub_state) {
+    case RW_T4T_SUBSTATE_WAIT_SELECT_APP:
+
+      /* NDEF Tag application has been selected then select NDEF file */
+      p_t4t->intl_flags |= RW_T4T_NDEF_APP_SELECTED;
+      if (!rw_t4t_select_ndef_file()) {
+        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
+      }
+      break;
+
+    case RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE:
+
+      /* NDEF file has been selected then start reading NDEF */
+      p_t4t->selected_file = p_t4t->cc_file.ndef_fc.file_id;
+      if (!rw_t4t_read_file(p_t4t->cc_file.ndef_fc.nlen_size,
+                            p_t4t->ndef_length, false)) {
+        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
+      } else {
+        p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_READ_RESP;
+      }
+      break;
+
     case RW_T4T_SUBSTATE_WAIT_READ_RESP:
 
       /* Read partial or complete data */
@@ -2030,6 +2200,28 @@ static void rw_t4t_sm_update_ndef(NFC_HDR* p_r_apdu) {
   }
 
   switch (p_t4t->sub_state) {
+    case RW_T4T_SUBSTATE_WAIT_SELECT_APP:
+
+      /* NDEF Tag application has been selected then select NDEF file */
+      p_t4t->intl_flags |= RW_T4T_NDEF_APP_SELECTED;
+      if (!rw_t4t_select_ndef_file()) {
+        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
+        p_t4t->p_update_data = nullptr;
+      }
+      break;
+
+    case RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE:
+
+      /* NDEF file has been selected then set NLEN to 0x0000 */
+      p_t4t->selected_file = p_t4t->cc_file.ndef_fc.file_id;
+      if (!rw_t4t_update_nlen(0x0000)) {
+        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
+        p_t4t->p_update_data = nullptr;
+      } else {
+        p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_UPDATE_NLEN;
+      }
+      break;
+
     case RW_T4T_SUBSTATE_WAIT_UPDATE_NLEN:
 
       /* NLEN has been updated */
@@ -2113,10 +2305,22 @@ static void rw_t4t_sm_set_readonly(NFC_HDR* p_r_apdu) {
   }
 
   switch (p_t4t->sub_state) {
+    case RW_T4T_SUBSTATE_WAIT_SELECT_APP:
+
+      /* NDEF Tag application has been selected then select CC file */
+      p_t4t->intl_flags |= RW_T4T_NDEF_APP_SELECTED;
+      if (!rw_t4t_select_file(T4T_CC_FILE_ID)) {
+        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
+      } else {
+        p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_CC;
+      }
+      break;
+
     case RW_T4T_SUBSTATE_WAIT_SELECT_CC:
 
       /* CC file has been selected then update write access to read-only in CC
        * file */
+      p_t4t->selected_file = T4T_CC_FILE_ID;
       if (!rw_t4t_update_cc_to_readonly()) {
         rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
       } else {
@@ -2125,21 +2329,13 @@ static void rw_t4t_sm_set_readonly(NFC_HDR* p_r_apdu) {
       break;
 
     case RW_T4T_SUBSTATE_WAIT_UPDATE_CC:
-      /* CC Updated, Select NDEF File to allow NDEF operation */
+      /* CC Updated, NDEF file will be selected again by the next NDEF
+       * operation */
       p_t4t->cc_file.ndef_fc.write_access = T4T_FC_NO_WRITE_ACCESS;
       p_t4t->ndef_status |= RW_T4T_NDEF_STATUS_NDEF_READ_ONLY;
 
-      if (!rw_t4t_select_file(p_t4t->cc_file.ndef_fc.file_id)) {
-        rw_t4t_handle_error(NFC_STATUS_FAILED, 0, 0);
-      } else {
-        p_t4t->sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE;
-      }
-      break;
-
-    case RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE:
       p_t4t->state = RW_T4T_STATE_IDLE;
-      /* just finished last step of configuring tag read only (Selecting NDEF
-       * file CC) */
+      /* just finished last step of configuring tag read only */
       if (rw_cb.p_cback) {
         rw_data.status = NFC_STATUS_OK;
 
@@ -2236,6 +2432,7 @@ static void rw_t4t_data_cback(__attribute__((unused)) uint8_t conn_id,
     case NFC_DEACTIVATE_CEVT:
       NFC_SetStaticRfCback(nullptr);
       p_t4t->state = RW_T4T_STATE_NOT_ACTIVATED;
+      rw_t4t_invalidate_selection();
       return;
 
     case NFC_ERROR_CEVT:
@@ -2252,6 +2449,7 @@ static void rw_t4t_data_cback(__attribute__((unused)) uint8_t conn_id,
         rw_t4t_handle_error(rw_data.status, 0, 0);
       } else {
         p_t4t->state = RW_T4T_STATE_IDLE;
+        rw_t4t_invalidate_selection();
         rw_data.status = (tNFC_STATUS)(*(uint8_t*)p_data);
         (*(rw_cb.p_cback))(RW_T4T_INTF_ERROR_EVT, &rw_data);
       }
@@ -2286,6 +2484,8 @@ static void rw_t4t_data_cback(__attribute__((unused)) uint8_t conn_id,
       LOG(VERBOSE) << StringPrintf(
           "%s - RW T4T Raw Frame: Len [0x%X] Status [%s]", __func__,
           p_r_apdu->len, NFC_GetStatusName(p_data->data.status).c_str());
+      /* raw frames may have changed application or file selected on tag */
+      rw_t4t_invalidate_selection();
       if (rw_cb.p_cback) {
         rw_data.raw_frame.status = p_data->data.status;
         rw_data.raw_frame.p_data = p_r_apdu;
@@ -2357,6 +2557,10 @@ tNFC_STATUS RW_T4tFormatNDef(void) {
 
   rw_cb.tcb.t4t.card_type = 0x00;
 
+  /* CC file and NDEF file will be created again, NDEF must be detected */
+  rw_cb.tcb.t4t.ndef_status &= ~(RW_T4T_NDEF_STATUS_NDEF_DETECTED);
+  rw_t4t_invalidate_selection();
+
   if (!rw_t4t_get_hw_version()) {
     return NFC_STATUS_FAILED;
   }
@@ -2393,6 +2597,8 @@ tNFC_STATUS rw_t4t_select(void) {
   p_t4t->max_read_size = T4T_MAX_LENGTH_LE;
   p_t4t->max_update_size = T4T_MAX_LENGTH_LC;
 
+  p_t4t->selected_file = RW_T4T_FILE_ID_NONE;
+
   return NFC_STATUS_OK;
 }
 
@@ -2417,12 +2623,21 @@ tNFC_STATUS RW_T4tDetectNDef(void) {
     return NFC_STATUS_FAILED;
   }
 
-  if (rw_cb.tcb.t4t.ndef_status & RW_T4T_NDEF_STATUS_NDEF_DETECTED) {
-    /* NDEF Tag application has been selected then select CC file */
-    if (!rw_t4t_select_file(T4T_CC_FILE_ID)) {
-      return NFC_STATUS_FAILED;
+  if ((rw_cb.tcb.t4t.ndef_status & RW_T4T_NDEF_STATUS_NDEF_DETECTED) &&
+      (rw_cb.tcb.t4t.intl_flags & RW_T4T_NDEF_APP_SELECTED)) {
+    /* CC file is already known, only NLEN needs to be read again */
+    if (rw_cb.tcb.t4t.selected_file == rw_cb.tcb.t4t.cc_file.ndef_fc.file_id) {
+      if (!rw_t4t_read_file(0, rw_cb.tcb.t4t.cc_file.ndef_fc.nlen_size,
+                            false)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_READ_NLEN;
+    } else {
+      if (!rw_t4t_select_file(rw_cb.tcb.t4t.cc_file.ndef_fc.file_id)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_NDEF_FILE;
     }
-    rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_CC;
   } else {
     /* Select NDEF Tag Application */
     if (!rw_t4t_select_application(rw_cb.tcb.t4t.version)) {
@@ -2464,14 +2679,18 @@ tNFC_STATUS RW_T4tReadNDef(void) {
 
   /* if NDEF has been detected */
   if (rw_cb.tcb.t4t.ndef_status & RW_T4T_NDEF_STATUS_NDEF_DETECTED) {
-    /* start reading NDEF */
-    if (!rw_t4t_read_file(rw_cb.tcb.t4t.cc_file.ndef_fc.nlen_size,
-                          rw_cb.tcb.t4t.ndef_length, false)) {
+    if (rw_cb.tcb.t4t.selected_file == rw_cb.tcb.t4t.cc_file.ndef_fc.file_id) {
+      /* start reading NDEF */
+      if (!rw_t4t_read_file(rw_cb.tcb.t4t.cc_file.ndef_fc.nlen_size,
+                            rw_cb.tcb.t4t.ndef_length, false)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_READ_RESP;
+    } else if (!rw_t4t_select_ndef_file()) {
       return NFC_STATUS_FAILED;
     }
 
     rw_cb.tcb.t4t.state = RW_T4T_STATE_READ_NDEF;
-    rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_READ_RESP;
 
     return NFC_STATUS_OK;
   } else {
@@ -2530,13 +2749,17 @@ tNFC_STATUS RW_T4tUpdateNDef(uint32_t length, uint8_t* p_data) {
     rw_cb.tcb.t4t.rw_offset = rw_cb.tcb.t4t.cc_file.ndef_fc.nlen_size;
     rw_cb.tcb.t4t.rw_length = length;
 
-    /* set NLEN to 0x0000 for the first step */
-    if (!rw_t4t_update_nlen(0x0000)) {
+    if (rw_cb.tcb.t4t.selected_file == rw_cb.tcb.t4t.cc_file.ndef_fc.file_id) {
+      /* set NLEN to 0x0000 for the first step */
+      if (!rw_t4t_update_nlen(0x0000)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_UPDATE_NLEN;
+    } else if (!rw_t4t_select_ndef_file()) {
       return NFC_STATUS_FAILED;
     }
 
     rw_cb.tcb.t4t.state = RW_T4T_STATE_UPDATE_NDEF;
-    rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_UPDATE_NLEN;
 
     return NFC_STATUS_OK;
   } else {
@@ -2647,13 +2870,26 @@ tNFC_STATUS RW_T4tSetNDefReadOnly(void) {
       return (retval);
     }
 
-    /* NDEF Tag application has been selected then select CC file */
-    if (!rw_t4t_select_file(T4T_CC_FILE_ID)) {
-      return NFC_STATUS_FAILED;
+    if (rw_cb.tcb.t4t.selected_file == T4T_CC_FILE_ID) {
+      /* CC file is still selected then update write access */
+      if (!rw_t4t_update_cc_to_readonly()) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_UPDATE_CC;
+    } else if (rw_cb.tcb.t4t.intl_flags & RW_T4T_NDEF_APP_SELECTED) {
+      /* NDEF Tag application has been selected then select CC file */
+      if (!rw_t4t_select_file(T4T_CC_FILE_ID)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_CC;
+    } else {
+      if (!rw_t4t_select_application(rw_cb.tcb.t4t.version)) {
+        return NFC_STATUS_FAILED;
+      }
+      rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_APP;
     }
 
     rw_cb.tcb.t4t.state = RW_T4T_STATE_SET_READ_ONLY;
-    rw_cb.tcb.t4t.sub_state = RW_T4T_SUBSTATE_WAIT_SELECT_CC;
 
     return NFC_STATUS_OK;
   } else {
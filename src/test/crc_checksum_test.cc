@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CrcChecksum.h"
+
+// The byte-wise loop crcChecksumCompute() used before slicing-by-8, with its
+// table derived from the reflected polynomial 0xA001 (CRC-16/ARC).
+static uint16_t legacyCrc(const unsigned char* buffer, int bufferLen) {
+  static uint16_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    for (int i = 0; i < 256; i++) {
+      uint16_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+      table[i] = crc;
+    }
+    tableReady = true;
+  }
+
+  uint16_t crc = 0;
+  while (bufferLen-- > 0)
+    crc = ((crc >> 8) & 0xff) ^ table[(crc & 0xff) ^ *buffer++];
+  return crc;
+}
+
+static std::vector<unsigned char> testData(size_t len) {
+  std::vector<unsigned char> data(len);
+  uint32_t seed = 0x12345678;
+  for (auto& byte : data) {
+    seed = seed * 1103515245 + 12345;
+    byte = (unsigned char)(seed >> 16);
+  }
+  return data;
+}
+
+TEST(CrcChecksumTest, test_check_value) {
+  const unsigned char check[] = "123456789";
+  EXPECT_EQ(0xBB3D, crcChecksumCompute(check, 9));
+  EXPECT_EQ(0, crcChecksumCompute(check, 0));
+}
+
+TEST(CrcChecksumTest, test_lengths_and_alignments) {
+  const int kMaxLen = 4100;
+  const int kMaxOffset = 8;
+  std::vector<unsigned char> data = testData(kMaxLen + kMaxOffset);
+
+  for (int offset = 0; offset < kMaxOffset; offset++) {
+    for (int len = 0; len <= kMaxLen; len++) {
+      ASSERT_EQ(legacyCrc(data.data() + offset, len),
+                crcChecksumCompute(data.data() + offset, len))
+          << "offset:" << offset << " len:" << len;
+    }
+  }
+}
+
+TEST(CrcChecksumTest, test_all_byte_values) {
+  // Each byte value in each of the 8 lanes of a slicing-by-8 block.
+  for (int lane = 0; lane < 8; lane++) {
+    for (int value = 0; value < 256; value++) {
+      unsigned char block[19] = {0};
+      block[lane] = (unsigned char)value;
+      block[8 + lane] = (unsigned char)~value;
+      for (int len = 8; len <= 19; len++) {
+        ASSERT_EQ(legacyCrc(block, len), crcChecksumCompute(block, len))
+            << "lane:" << lane << " value:" << value << " len:" << len;
+      }
+    }
+  }
+}
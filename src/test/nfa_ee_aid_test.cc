@@ -0,0 +1,519 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+#include "gki.h"
+#include "nfa_dm_int.h"
+#include "nfa_ee_int.h"
+
+// The LMRT sent to NFCC, kept by NFC_SetRouting() in nfa_ee_stubs.cc
+extern std::vector<uint8_t> stub_lmrt_tlvs;
+extern uint16_t stub_lmrt_size;
+extern int stub_timer_starts;
+
+typedef std::vector<uint8_t> tAid;
+
+static const uint8_t kNfceeId = 0x81;
+static const tNFA_EE_PWR_STATE kPwrState = 0x01;
+
+static tNFA_EE_EVT last_event;
+static tNFA_STATUS last_status;
+static tNFA_EE_CBACK_DATA last_data;
+
+static void eeCback(tNFA_EE_EVT event, tNFA_EE_CBACK_DATA* p_data) {
+  last_event = event;
+  last_status = p_data->status;
+  last_data = *p_data;
+}
+
+// A distinct AID of 5 to 16 bytes for each n
+static tAid makeAid(uint32_t n) {
+  tAid aid = {0xA0, 0x00, 0x00, (uint8_t)(n >> 8), (uint8_t)n};
+  for (uint32_t xx = 0; xx < n % 12; xx++) aid.push_back((uint8_t)(n * 7 + xx));
+  return aid;
+}
+
+class NfaEeAidTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    tNFA_EE_MSG msg;
+
+    stub_lmrt_size = 0x8000;
+    nfa_ee_init();
+    nfa_ee_cb.em_state = NFA_EE_EM_STATE_INIT_DONE;
+    nfa_ee_cb.cur_ee = 1;
+    nfa_ee_cb.ecb[0].nfcee_id = kNfceeId;
+    nfa_ee_cb.ecb[0].ee_status = NFC_NFCEE_STATUS_ACTIVE;
+    nfa_ee_cb.ecb[0].p_ee_cback = eeCback;
+    nfa_ee_cb.ecb[NFA_EE_CB_4_DH].p_ee_cback = eeCback;
+
+    msg.ee_register.p_cback = eeCback;
+    nfa_ee_api_register(&msg);
+  }
+
+  void TearDown() override {
+    tNFA_EE_MSG msg;
+
+    msg.deregister.index = 0;
+    nfa_ee_api_deregister(&msg);
+    EXPECT_EQ(nullptr, nfa_ee_cb.aid_idx);
+  }
+
+  tNFA_STATUS addAid(tNFA_EE_ECB* p_cb, tAid& aid, uint8_t aid_info = 0,
+                     tNFA_EE_PWR_STATE power_state = kPwrState) {
+    tNFA_EE_MSG msg = {};
+
+    msg.add_aid.p_cb = p_cb;
+    msg.add_aid.nfcee_id = p_cb->nfcee_id;
+    msg.add_aid.aid_len = (uint8_t)aid.size();
+    msg.add_aid.p_aid = aid.data();
+    msg.add_aid.power_state = power_state;
+    msg.add_aid.aidInfo = aid_info;
+    last_status = NFA_STATUS_FAILED;
+    nfa_ee_api_add_aid(&msg);
+    EXPECT_EQ(NFA_EE_ADD_AID_EVT, last_event);
+    return last_status;
+  }
+
+  tNFA_STATUS removeAid(tAid& aid) {
+    tNFA_EE_MSG msg = {};
+
+    msg.rm_aid.aid_len = (uint8_t)aid.size();
+    msg.rm_aid.p_aid = aid.data();
+    last_status = NFA_STATUS_FAILED;
+    nfa_ee_api_remove_aid(&msg);
+    EXPECT_EQ(NFA_EE_REMOVE_AID_EVT, last_event);
+    return last_status;
+  }
+
+  // Build the LMRT and return its AID entries with their NFCEE ID
+  std::map<tAid, uint8_t> buildLmrt() {
+    std::map<tAid, uint8_t> aids;
+    size_t xx = 0;
+
+    nfa_ee_cb.lmrt_sent_valid = false;
+    nfa_ee_cb.ee_cfg_sts |= NFA_EE_STS_CHANGED_ROUTING;
+    stub_lmrt_tlvs.clear();
+    nfa_ee_lmrt_to_nfcc(nullptr);
+
+    while (xx + 2 <= stub_lmrt_tlvs.size()) {
+      uint8_t* p = &stub_lmrt_tlvs[xx];
+      if ((p[0] & 0x0F) == NFC_ROUTE_TAG_AID)
+        aids[tAid(p + 4, p + 2 + p[1])] = p[2];
+      xx += 2 + p[1];
+    }
+    EXPECT_EQ(stub_lmrt_tlvs.size(), xx);
+    return aids;
+  }
+};
+
+TEST_F(NfaEeAidTest, test_index_add_find_remove) {
+  tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+  tNFA_EE_ECB* p_dh_cb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
+  std::vector<tAid> aids;
+
+  for (uint32_t n = 0; n < 300; n++) {
+    aids.push_back(makeAid(n));
+    ASSERT_EQ(NFA_STATUS_OK, addAid((n & 1) ? p_dh_cb : p_cb, aids.back()));
+  }
+  EXPECT_EQ(300, nfa_ee_cb.aid_idx_count);
+  EXPECT_EQ(0, nfa_ee_cb.aid_idx_size & (nfa_ee_cb.aid_idx_size - 1));
+  EXPECT_GE(nfa_ee_cb.aid_idx_size, 2 * nfa_ee_cb.aid_idx_count);
+
+  // an AID is routed to one NFCEE only
+  EXPECT_EQ(NFA_STATUS_SEMANTIC_ERROR, addAid(p_dh_cb, aids[0]));
+  EXPECT_EQ(NFA_STATUS_SEMANTIC_ERROR, addAid(p_cb, aids[1]));
+  // adding it again to the same NFCEE only updates it
+  EXPECT_EQ(NFA_STATUS_OK, addAid(p_cb, aids[0]));
+  EXPECT_EQ(300, nfa_ee_cb.aid_idx_count);
+
+  // a prefix or an extension of an AID is another AID
+  tAid prefix(aids[20].begin(), aids[20].end() - 1);
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, removeAid(prefix));
+  tAid extension = aids[20];
+  extension.push_back(0x01);
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, removeAid(extension));
+
+  for (uint32_t n = 0; n < 300; n += 2) {
+    ASSERT_EQ(NFA_STATUS_OK, removeAid(aids[n]));
+    EXPECT_EQ(NFA_STATUS_INVALID_PARAM, removeAid(aids[n]));
+  }
+  EXPECT_EQ(150, nfa_ee_cb.aid_idx_count);
+  for (uint32_t n = 1; n < 300; n += 2)
+    EXPECT_EQ(NFA_STATUS_SEMANTIC_ERROR, addAid(p_cb, aids[n]));
+}
+
+TEST_F(NfaEeAidTest, test_grow_on_demand) {
+  tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+  tNFA_EE_ECB* p_dh_cb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
+
+  // nothing is allocated before the first AID
+  EXPECT_EQ(nullptr, p_cb->aid_len);
+  EXPECT_EQ(0, p_cb->aid_alloc_entries);
+  EXPECT_EQ(nullptr, nfa_ee_cb.aid_idx);
+
+  tAid aid = makeAid(0);
+  ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, aid));
+  EXPECT_EQ(NFA_EE_AID_INIT_ENTRIES, p_cb->aid_alloc_entries);
+  EXPECT_EQ(nullptr, p_dh_cb->aid_len);
+
+  for (uint32_t n = 1; n < 1000; n++) {
+    aid = makeAid(n);
+    ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, aid));
+    // the arrays double when full
+    ASSERT_GE(p_cb->aid_alloc_entries, p_cb->aid_entries);
+    if (p_cb->aid_alloc_entries > NFA_EE_AID_INIT_ENTRIES) {
+      ASSERT_LT(p_cb->aid_alloc_entries, 2 * p_cb->aid_entries);
+    }
+    ASSERT_LE(nfa_ee_find_total_aid_len(p_cb, 0), p_cb->aid_alloc_cfg_len);
+  }
+  EXPECT_EQ(1000, p_cb->aid_entries);
+  EXPECT_EQ(1000, nfa_ee_cb.aid_idx_count);
+
+  std::map<tAid, uint8_t> lmrt = buildLmrt();
+  EXPECT_EQ(1000u, lmrt.size());
+  for (uint32_t n = 0; n < 1000; n++) EXPECT_EQ(kNfceeId, lmrt[makeAid(n)]);
+}
+
+TEST_F(NfaEeAidTest, test_grow_up_to_max) {
+  tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+  uint32_t n;
+
+  nfa_ee_cb.aid_max_entries = 40;
+  for (n = 0; n < 40; n++) {
+    tAid aid = makeAid(n);
+    ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, aid));
+  }
+  tAid aid = makeAid(n);
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, addAid(p_cb, aid));
+  EXPECT_EQ(40, p_cb->aid_alloc_entries);
+  EXPECT_EQ(40, nfa_ee_cb.aid_idx_count);
+
+  // a removed entry makes room again, compacted before growing
+  tAid first = makeAid(0);
+  ASSERT_EQ(NFA_STATUS_OK, removeAid(first));
+  EXPECT_EQ(NFA_STATUS_OK, addAid(p_cb, aid));
+  EXPECT_EQ(40, p_cb->aid_alloc_entries);
+  EXPECT_EQ(0, p_cb->aid_rm_entries);
+}
+
+TEST_F(NfaEeAidTest, test_compact_on_lmrt_build) {
+  tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+  std::vector<tAid> aids;
+
+  for (uint32_t n = 0; n < 100; n++) {
+    aids.push_back(makeAid(n));
+    ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, aids.back()));
+  }
+  for (uint32_t n = 0; n < 100; n += 3)
+    ASSERT_EQ(NFA_STATUS_OK, removeAid(aids[n]));
+  // removing the last entry needs no compaction
+  EXPECT_EQ(99, p_cb->aid_entries);
+  EXPECT_EQ(33, p_cb->aid_rm_entries);
+
+  std::map<tAid, uint8_t> lmrt = buildLmrt();
+  EXPECT_EQ(66, p_cb->aid_entries);
+  EXPECT_EQ(0, p_cb->aid_rm_entries);
+  EXPECT_EQ(66u, lmrt.size());
+  for (uint32_t n = 0; n < 100; n++)
+    EXPECT_EQ((n % 3) ? 1u : 0u, lmrt.count(aids[n])) << "n:" << n;
+
+  // the index follows the moved entries
+  for (uint32_t n = 1; n < 100; n += 3)
+    ASSERT_EQ(NFA_STATUS_OK, removeAid(aids[n]));
+  lmrt = buildLmrt();
+  EXPECT_EQ(33u, lmrt.size());
+  EXPECT_EQ(33, nfa_ee_cb.aid_idx_count);
+}
+
+TEST_F(NfaEeAidTest, test_add_remove_churn) {
+  tNFA_EE_ECB* p_cbs[2] = {&nfa_ee_cb.ecb[0], &nfa_ee_cb.ecb[NFA_EE_CB_4_DH]};
+  std::map<tAid, uint8_t> model;
+  const uint32_t kAids = 400;
+  uint32_t seed = 1;
+
+  for (int op = 0; op < 20000; op++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t n = (seed >> 8) % kAids;
+    tAid aid = makeAid(n);
+    tNFA_EE_ECB* p_cb = p_cbs[(seed >> 24) & 1];
+
+    if ((seed >> 28) & 1) {
+      tNFA_STATUS expected = NFA_STATUS_OK;
+      if (model.count(aid) && (model[aid] != p_cb->nfcee_id))
+        expected = NFA_STATUS_SEMANTIC_ERROR;
+      ASSERT_EQ(expected, addAid(p_cb, aid)) << "op:" << op;
+      if (expected == NFA_STATUS_OK) model[aid] = p_cb->nfcee_id;
+    } else {
+      ASSERT_EQ(model.count(aid) ? NFA_STATUS_OK : NFA_STATUS_INVALID_PARAM,
+                removeAid(aid))
+          << "op:" << op;
+      model.erase(aid);
+    }
+    ASSERT_EQ(model.size(), nfa_ee_cb.aid_idx_count) << "op:" << op;
+
+    if (op % 1000 == 999) {
+      ASSERT_EQ(model, buildLmrt()) << "op:" << op;
+      for (tNFA_EE_ECB* p_cb_chk : p_cbs)
+        EXPECT_EQ(0, p_cb_chk->aid_rm_entries);
+    }
+  }
+
+  // removed entries are reused, the storage stays bounded by the live AIDs
+  for (tNFA_EE_ECB* p_cb : p_cbs) EXPECT_LE(p_cb->aid_alloc_entries, 2 * kAids);
+  EXPECT_LE(nfa_ee_cb.aid_idx_size, 4 * kAids);
+}
+
+static tNFA_EE_AID_ROUTE makeRoute(uint8_t nfcee_id, tAid& aid) {
+  tNFA_EE_AID_ROUTE route = {};
+
+  route.ee_handle = NFA_HANDLE_GROUP_EE | nfcee_id;
+  route.aid_len = (uint8_t)aid.size();
+  route.p_aid = aid.data();
+  route.power_state = kPwrState;
+  return route;
+}
+
+TEST_F(NfaEeAidTest, test_bulk_add_remove) {
+  std::vector<tAid> aids;
+  std::vector<tNFA_EE_AID_ROUTE> routes;
+  tNFA_EE_MSG msg = {};
+
+  for (uint32_t n = 0; n < 200; n++) aids.push_back(makeAid(n));
+  for (uint32_t n = 0; n < 200; n++)
+    routes.push_back(makeRoute((n & 1) ? NFC_DH_ID : kNfceeId, aids[n]));
+  // an unknown NFCEE, and an AID added twice to different NFCEEs
+  tAid unknown = makeAid(1000);
+  routes.push_back(makeRoute(0x99, unknown));
+  routes.push_back(makeRoute(NFC_DH_ID, aids[0]));
+
+  // each AID is added, the routing is committed once
+  stub_timer_starts = 0;
+  msg.aid_bulk.num_aid = (uint16_t)routes.size();
+  msg.aid_bulk.p_aid_route = routes.data();
+  nfa_ee_api_add_aid_bulk(&msg);
+  EXPECT_EQ(NFA_EE_ADD_AID_BULK_EVT, last_event);
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, last_data.aid_bulk.status);
+  EXPECT_EQ(200, last_data.aid_bulk.num_done);
+  EXPECT_EQ(1, stub_timer_starts);
+  EXPECT_EQ(200, nfa_ee_cb.aid_idx_count);
+
+  std::map<tAid, uint8_t> lmrt = buildLmrt();
+  EXPECT_EQ(200u, lmrt.size());
+  for (uint32_t n = 0; n < 200; n++)
+    EXPECT_EQ((n & 1) ? NFC_DH_ID : kNfceeId, lmrt[aids[n]]);
+
+  // half of them removed, together with one not added
+  routes.clear();
+  for (uint32_t n = 0; n < 200; n += 2)
+    routes.push_back(makeRoute(0, aids[n]));
+  routes.push_back(makeRoute(0, unknown));
+  stub_timer_starts = 0;
+  msg.aid_bulk.num_aid = (uint16_t)routes.size();
+  msg.aid_bulk.p_aid_route = routes.data();
+  nfa_ee_api_remove_aid_bulk(&msg);
+  EXPECT_EQ(NFA_EE_REMOVE_AID_BULK_EVT, last_event);
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, last_data.aid_bulk.status);
+  EXPECT_EQ(100, last_data.aid_bulk.num_done);
+  EXPECT_EQ(1, stub_timer_starts);
+
+  lmrt = buildLmrt();
+  EXPECT_EQ(100u, lmrt.size());
+  for (uint32_t n = 1; n < 200; n += 2) EXPECT_EQ(NFC_DH_ID, lmrt[aids[n]]);
+}
+
+TEST_F(NfaEeAidTest, test_bulk_full) {
+  std::vector<tAid> aids;
+  std::vector<tNFA_EE_AID_ROUTE> routes;
+  tNFA_EE_MSG msg = {};
+
+  // what fits is added, the rest is counted out
+  nfa_ee_cb.aid_max_entries = 50;
+  for (uint32_t n = 0; n < 80; n++) aids.push_back(makeAid(n));
+  for (uint32_t n = 0; n < 80; n++)
+    routes.push_back(makeRoute(kNfceeId, aids[n]));
+  msg.aid_bulk.num_aid = (uint16_t)routes.size();
+  msg.aid_bulk.p_aid_route = routes.data();
+  nfa_ee_api_add_aid_bulk(&msg);
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, last_data.aid_bulk.status);
+  EXPECT_EQ(50, last_data.aid_bulk.num_done);
+  EXPECT_EQ(50u, buildLmrt().size());
+}
+
+// AIDs under a long select (prefix) AID routed the same way are left out
+TEST_F(NfaEeAidTest, test_compact_covered) {
+  tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+  tNFA_EE_ECB* p_dh_cb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
+  tAid parent = {0xA0, 0x00, 0x00, 0x01};
+  std::vector<tAid> children;
+
+  nfa_ee_cb.aid_compact = true;
+  ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, parent, NCI_ROUTE_QUAL_LONG_SELECT));
+  for (uint8_t n = 0; n < 10; n++) {
+    children.push_back(parent);
+    children.back().push_back(n);
+    children.back().push_back(0x10);
+    ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, children.back()));
+  }
+  EXPECT_EQ(10 * (4 + 6), nfa_ee_cb.aid_saved);
+
+  std::map<tAid, uint8_t> lmrt = buildLmrt();
+  EXPECT_EQ(1u, lmrt.size());
+  EXPECT_EQ(kNfceeId, lmrt[parent]);
+  EXPECT_EQ(10 * (4 + 6), nfa_ee_cb.aid_saved);
+  EXPECT_FALSE(nfa_ee_cb.aid_saved_stale);
+
+  // another power state, or a longer AID to another NFCEE, takes the
+  // coverage away
+  ASSERT_EQ(NFA_STATUS_OK, addAid(p_cb, children[0], 0, kPwrState | 0x02));
+  tAid longer = children[1];
+  longer.push_back(0x20);
+  ASSERT_EQ(NFA_STATUS_OK, addAid(p_dh_cb, longer));
+  lmrt = buildLmrt();
+  EXPECT_EQ(4u, lmrt.size());
+  EXPECT_EQ(1u, lmrt.count(children[0]));
+  EXPECT_EQ(1u, lmrt.count(children[1]));
+  EXPECT_EQ(NFC_DH_ID, lmrt[longer]);
+  EXPECT_EQ(8 * (4 + 6), nfa_ee_cb.aid_saved);
+}
+
+class NfaEeAidCompactTest : public NfaEeAidTest {
+ protected:
+  // A long select AID and 20 AIDs it covers, in an LMRT of 40 bytes which
+  // holds only 3 uncovered ones
+  void SetUp() override {
+    NfaEeAidTest::SetUp();
+    nfa_ee_cb.aid_compact = true;
+    stub_lmrt_size = 40;
+
+    ASSERT_EQ(NFA_STATUS_OK, addAid(&nfa_ee_cb.ecb[0], parent_,
+                                    NCI_ROUTE_QUAL_LONG_SELECT));
+    for (uint8_t n = 0; n < 20; n++) {
+      children_.push_back(parent_);
+      children_.back().push_back(n);
+      children_.back().push_back(0x10);
+      ASSERT_EQ(NFA_STATUS_OK, addAid(&nfa_ee_cb.ecb[0], children_.back()));
+    }
+    ASSERT_EQ(20 * (4 + 6), nfa_ee_cb.aid_saved);
+  }
+
+  // the LMRT fits in NFCC, checked after the adds were accepted
+  void expectLmrtFits(size_t num_aid) {
+    std::map<tAid, uint8_t> lmrt = buildLmrt();
+    EXPECT_EQ(num_aid, lmrt.size());
+    EXPECT_LE(stub_lmrt_tlvs.size(), stub_lmrt_size);
+  }
+
+  tAid parent_ = {0xA0, 0x00, 0x00, 0x01};
+  std::vector<tAid> children_;
+};
+
+TEST_F(NfaEeAidCompactTest, test_parent_removed) {
+  tAid other = {0xA0, 0x00, 0x00, 0x02, 0x01};
+
+  ASSERT_EQ(NFA_STATUS_OK, removeAid(parent_));
+  // the 20 AIDs need an LMRT entry each now, no more room
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, addAid(&nfa_ee_cb.ecb[0], other));
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL,
+            addAid(&nfa_ee_cb.ecb[NFA_EE_CB_4_DH], other));
+  buildLmrt();
+  EXPECT_EQ(0, nfa_ee_cb.aid_saved);
+  EXPECT_EQ(20 * (4 + 6), stub_lmrt_tlvs.size());
+}
+
+TEST_F(NfaEeAidCompactTest, test_overlap_added) {
+  tNFA_EE_ECB* p_dh_cb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
+  tNFA_STATUS status = NFA_STATUS_OK;
+  int added = 0;
+
+  // a prefix of a covered AID routed to DH takes its coverage away, 19 more
+  // bytes for each
+  for (uint8_t n = 0; (n < 20) && (status == NFA_STATUS_OK); n++) {
+    tAid prefix(children_[n].begin(), children_[n].end() - 1);
+    status = addAid(p_dh_cb, prefix);
+    if (status == NFA_STATUS_OK) added++;
+  }
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, status);
+  EXPECT_EQ(1, added);
+  expectLmrtFits(3);
+}
+
+TEST_F(NfaEeAidCompactTest, test_overlap_added_each_build) {
+  tNFA_EE_ECB* p_dh_cb = &nfa_ee_cb.ecb[NFA_EE_CB_4_DH];
+  tNFA_STATUS status = NFA_STATUS_OK;
+  int added = 0;
+
+  // the same with the LMRT built, and the saving compiled, after each add
+  for (uint8_t n = 0; (n < 20) && (status == NFA_STATUS_OK); n++) {
+    tAid prefix(children_[n].begin(), children_[n].end() - 1);
+    status = addAid(p_dh_cb, prefix);
+    if (status == NFA_STATUS_OK) {
+      added++;
+      expectLmrtFits(1 + 2 * added);
+    }
+  }
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, status);
+  EXPECT_EQ(1, added);
+}
+
+TEST_F(NfaEeAidCompactTest, test_covered_add_and_remove) {
+  tAid child = parent_;
+  child.push_back(0x40);
+
+  // covered AIDs keep fitting, their removal gives nothing back
+  for (uint8_t n = 0; n < 50; n++) {
+    child.push_back(n);
+    ASSERT_EQ(NFA_STATUS_OK, addAid(&nfa_ee_cb.ecb[0], child));
+    child.pop_back();
+  }
+  EXPECT_FALSE(nfa_ee_cb.aid_saved_stale);
+  for (uint8_t n = 0; n < 20; n++)
+    ASSERT_EQ(NFA_STATUS_OK, removeAid(children_[n]));
+  EXPECT_EQ(50 * (4 + 6), nfa_ee_cb.aid_saved);
+  expectLmrtFits(1);
+}
+
+TEST_F(NfaEeAidCompactTest, test_churn_fits) {
+  tNFA_EE_ECB* p_cbs[2] = {&nfa_ee_cb.ecb[0], &nfa_ee_cb.ecb[NFA_EE_CB_4_DH]};
+  uint32_t seed = 1;
+
+  // random prefixes and extensions of each other, routed either way. A
+  // removal may take coverage away, but an accepted add leaves an LMRT
+  // which fits.
+  stub_lmrt_size = 200;
+  for (int op = 0; op < 5000; op++) {
+    seed = seed * 1103515245 + 12345;
+    tAid aid = parent_;
+    for (uint32_t xx = 0; xx < ((seed >> 8) & 3); xx++)
+      aid.push_back((seed >> (12 + xx)) & 1);
+
+    if (!((seed >> 28) & 1)) {
+      removeAid(aid);
+    } else if ((addAid(p_cbs[(seed >> 24) & 1], aid,
+                       ((seed >> 20) & 1) ? NCI_ROUTE_QUAL_LONG_SELECT : 0,
+                       ((seed >> 21) & 1) ? kPwrState : kPwrState | 0x02) ==
+                NFA_STATUS_OK) &&
+               (op % 5 == 0)) {
+      buildLmrt();
+      ASSERT_LE(stub_lmrt_tlvs.size(), stub_lmrt_size) << "op:" << op;
+    }
+  }
+}
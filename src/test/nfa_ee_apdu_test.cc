@@ -0,0 +1,219 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "gki.h"
+#include "nfa_dm_int.h"
+#include "nfa_ee_api.h"
+#include "nfa_ee_int.h"
+
+// The data packets sent to NFCC, see nfa_ee_stubs.cc
+extern std::vector<std::vector<uint8_t>> stub_sent_data;
+extern tNFC_STATUS stub_send_data_status;
+
+static const uint8_t kNfceeId = 0x81;
+static const uint8_t kConnId = 0x05;
+static const tNFA_HANDLE kEeHandle = NFA_HANDLE_GROUP_EE | kNfceeId;
+
+static std::vector<tNFA_EE_EVT> events;
+static std::vector<uint16_t> rx_seqs;
+static tNFA_EE_APDU_ERR last_apdu_err;
+
+static void eeCback(tNFA_EE_EVT event, tNFA_EE_CBACK_DATA* p_data) {
+  events.push_back(event);
+  if (event == NFA_EE_DATA_EVT) rx_seqs.push_back(p_data->data.seq);
+  if (event == NFA_EE_NO_CB_ERR_EVT) last_apdu_err = p_data->apdu_err;
+}
+
+// The C-APDU with seq n is 00 B0 00 n
+static std::vector<uint8_t> makeApdu(uint16_t n) {
+  return {0x00, 0xB0, 0x00, (uint8_t)n};
+}
+
+class NfaEeApduTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    tNFA_EE_ECB* p_cb = &nfa_ee_cb.ecb[0];
+
+    nfa_ee_init();
+    nfa_ee_cb.em_state = NFA_EE_EM_STATE_INIT_DONE;
+    nfa_ee_cb.cur_ee = 1;
+    nfa_ee_cb.apdu_max_in_flight = NFA_EE_MAX_APDU_IN_FLIGHT;
+    p_cb->nfcee_id = kNfceeId;
+    p_cb->ee_status = NFC_NFCEE_STATUS_ACTIVE;
+    p_cb->p_ee_cback = eeCback;
+    p_cb->conn_st = NFA_EE_CONN_ST_CONN;
+    p_cb->conn_id = kConnId;
+    p_cb->use_interface = NFC_NFCEE_INTERFACE_APDU;
+    GKI_init_q(&p_cb->apdu_q);
+
+    stub_sent_data.clear();
+    stub_send_data_status = NFC_STATUS_OK;
+    events.clear();
+    rx_seqs.clear();
+    next_tx_ = 0;
+  }
+
+  void TearDown() override {
+    tNFA_EE_MSG msg = {};
+
+    msg.disconnect.p_cb = &nfa_ee_cb.ecb[0];
+    nfa_ee_api_disconnect(&msg);
+    EXPECT_TRUE(GKI_queue_is_empty(&nfa_ee_cb.ecb[0].apdu_q));
+  }
+
+  // Send the next num C-APDUs in one call
+  tNFA_STATUS sendApdus(uint16_t num) {
+    std::vector<std::vector<uint8_t>> data;
+    std::vector<tNFA_EE_APDU> apdus(num);
+
+    for (uint16_t xx = 0; xx < num; xx++)
+      data.push_back(makeApdu(next_tx_++));
+    for (uint16_t xx = 0; xx < num; xx++) {
+      apdus[xx].len = (uint16_t)data[xx].size();
+      apdus[xx].p_data = data[xx].data();
+    }
+    return NFA_EeSendApdus(kEeHandle, num, apdus.data());
+  }
+
+  // NFCEE answers the oldest C-APDU in flight
+  void rxApdu(tNFC_STATUS status = NFC_STATUS_OK) {
+    tNFA_EE_MSG msg = {};
+    tNFC_CONN conn = {};
+    NFC_HDR* p_pkt = (NFC_HDR*)GKI_getbuf(NFC_HDR_SIZE + 2);
+
+    p_pkt->offset = 0;
+    p_pkt->len = 2;
+    ((uint8_t*)(p_pkt + 1))[0] = 0x90;
+    ((uint8_t*)(p_pkt + 1))[1] = 0x00;
+    conn.data.status = status;
+    conn.data.p_data = p_pkt;
+    msg.conn.conn_id = kConnId;
+    msg.conn.event = NFC_DATA_CEVT;
+    msg.conn.p_data = &conn;
+    nfa_ee_nci_conn(&msg);
+    /* the R-APDU belongs to the callback, which keeps nothing here */
+    GKI_freebuf(p_pkt);
+  }
+
+  uint16_t next_tx_;
+};
+
+TEST_F(NfaEeApduTest, test_one_in_flight_by_default) {
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(3));
+  EXPECT_EQ(1u, stub_sent_data.size());
+
+  for (uint16_t n = 0; n < 3; n++) {
+    EXPECT_EQ(makeApdu(n), stub_sent_data.back());
+    rxApdu();
+    EXPECT_EQ(n + 1u, rx_seqs.size());
+    EXPECT_EQ(n, rx_seqs.back());
+    EXPECT_EQ(n < 2 ? n + 2u : 3u, stub_sent_data.size());
+  }
+  EXPECT_EQ(0, nfa_ee_cb.ecb[0].apdu_in_flight);
+}
+
+TEST_F(NfaEeApduTest, test_in_flight_limit) {
+  nfa_ee_cb.apdu_max_in_flight = 3;
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(5));
+  EXPECT_EQ(3u, stub_sent_data.size());
+  EXPECT_EQ(3, nfa_ee_cb.ecb[0].apdu_in_flight);
+
+  // a chained R-APDU fragment does not free a slot
+  rxApdu(NFC_STATUS_CONTINUE);
+  EXPECT_EQ(3u, stub_sent_data.size());
+  rxApdu();
+  EXPECT_EQ(4u, stub_sent_data.size());
+  EXPECT_EQ(makeApdu(3), stub_sent_data.back());
+
+  for (int xx = 0; xx < 4; xx++) rxApdu();
+  EXPECT_EQ(5u, stub_sent_data.size());
+  // the fragment and the R-APDU it belongs to have the same seq
+  EXPECT_EQ(std::vector<uint16_t>({0, 0, 1, 2, 3, 4}), rx_seqs);
+}
+
+TEST_F(NfaEeApduTest, test_seq_counts_send_data) {
+  uint8_t data[] = {0x00, 0xA4, 0x04, 0x00};
+
+  nfa_ee_cb.apdu_max_in_flight = 2;
+  ASSERT_EQ(NFA_STATUS_OK, NFA_EeSendData(kEeHandle, sizeof(data), data));
+  next_tx_ = 1;
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(2));
+  EXPECT_EQ(2u, stub_sent_data.size());
+  for (int xx = 0; xx < 3; xx++) rxApdu();
+  EXPECT_EQ(std::vector<uint16_t>({0, 1, 2}), rx_seqs);
+}
+
+TEST_F(NfaEeApduTest, test_drop_reporting) {
+  nfa_ee_cb.apdu_max_in_flight = 4;
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(2));
+
+  // C-APDUs 2, 3 and 4 cannot be sent: dropped and reported
+  stub_send_data_status = NFC_STATUS_FAILED;
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(3));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(NFA_EE_NO_CB_ERR_EVT, events[0]);
+  EXPECT_EQ(NFA_STATUS_FAILED, last_apdu_err.status);
+  EXPECT_EQ(2, last_apdu_err.seq);
+  EXPECT_EQ(3, last_apdu_err.num_apdu);
+
+  // C-APDU 5 waits until the two in flight are answered, so the seq of the
+  // R-APDUs stays right
+  stub_send_data_status = NFC_STATUS_OK;
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(1));
+  EXPECT_EQ(2u, stub_sent_data.size());
+  rxApdu();
+  EXPECT_EQ(2u, stub_sent_data.size());
+  rxApdu();
+  EXPECT_EQ(3u, stub_sent_data.size());
+  EXPECT_EQ(makeApdu(5), stub_sent_data.back());
+  rxApdu();
+  EXPECT_EQ(std::vector<uint16_t>({0, 1, 5}), rx_seqs);
+}
+
+TEST_F(NfaEeApduTest, test_bad_apdus) {
+  std::vector<uint8_t> big(0xFFF0);
+  tNFA_EE_APDU apdu = {(uint16_t)big.size(), big.data()};
+
+  // too big for a GKI buffer, the buffer size must not wrap around
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, NFA_EeSendApdus(kEeHandle, 1, &apdu));
+  apdu.len = 4;
+  apdu.p_data = nullptr;
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, NFA_EeSendApdus(kEeHandle, 1, &apdu));
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, NFA_EeSendApdus(kEeHandle, 0, &apdu));
+  EXPECT_TRUE(stub_sent_data.empty());
+
+  // not on the APDU interface
+  nfa_ee_cb.ecb[0].use_interface = NFC_NFCEE_INTERFACE_HCI_ACCESS;
+  EXPECT_EQ(NFA_STATUS_INVALID_PARAM, sendApdus(1));
+  nfa_ee_cb.ecb[0].use_interface = NFC_NFCEE_INTERFACE_APDU;
+}
+
+TEST_F(NfaEeApduTest, test_disconnect_drops_queue) {
+  tNFA_EE_MSG msg = {};
+
+  ASSERT_EQ(NFA_STATUS_OK, sendApdus(4));
+  EXPECT_EQ(1u, stub_sent_data.size());
+  msg.disconnect.p_cb = &nfa_ee_cb.ecb[0];
+  nfa_ee_api_disconnect(&msg);
+  EXPECT_TRUE(GKI_queue_is_empty(&nfa_ee_cb.ecb[0].apdu_q));
+  EXPECT_EQ(0, nfa_ee_cb.ecb[0].apdu_in_flight);
+  EXPECT_EQ(0, nfa_ee_cb.ecb[0].apdu_tx_seq);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "gki.h"
+#include "nfa_dm_int.h"
+#include "nfa_ee_int.h"
+
+// The routing commands sent to NFCC, see nfa_ee_stubs.cc
+extern std::vector<uint8_t> stub_lmrt_tlvs;
+extern int stub_set_routing_calls;
+extern tNFC_STATUS stub_set_routing_status;
+
+static const uint8_t kNfceeId = 0x81;
+
+static void eeCback(tNFA_EE_EVT, tNFA_EE_CBACK_DATA*) {}
+
+class NfaEeLmrtTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    tNFA_EE_MSG msg;
+
+    stub_set_routing_status = NFC_STATUS_OK;
+    nfa_ee_init();
+    nfa_ee_cb.em_state = NFA_EE_EM_STATE_INIT_DONE;
+    nfa_ee_cb.cur_ee = 1;
+    nfa_ee_cb.ecb[0].nfcee_id = kNfceeId;
+    nfa_ee_cb.ecb[0].ee_status = NFC_NFCEE_STATUS_ACTIVE;
+
+    msg.ee_register.p_cback = eeCback;
+    nfa_ee_api_register(&msg);
+    addAid(0x01);
+  }
+
+  void TearDown() override {
+    tNFA_EE_MSG msg;
+
+    msg.deregister.index = 0;
+    nfa_ee_api_deregister(&msg);
+  }
+
+  void addAid(uint8_t last) {
+    tNFA_EE_MSG msg = {};
+    uint8_t aid[] = {0xA0, 0x00, 0x00, 0x00, last};
+
+    msg.add_aid.p_cb = &nfa_ee_cb.ecb[0];
+    msg.add_aid.nfcee_id = kNfceeId;
+    msg.add_aid.aid_len = sizeof(aid);
+    msg.add_aid.p_aid = aid;
+    msg.add_aid.power_state = 0x01;
+    nfa_ee_api_add_aid(&msg);
+  }
+
+  // Build the LMRT as the routing timer does, and return the number of
+  // routing commands sent to NFCC
+  int sendLmrt() {
+    nfa_ee_cb.ee_cfg_sts |= NFA_EE_STS_CHANGED_ROUTING;
+    stub_lmrt_tlvs.clear();
+    stub_set_routing_calls = 0;
+    nfa_ee_lmrt_to_nfcc(nullptr);
+    return stub_set_routing_calls;
+  }
+
+  // NFCC answers each routing command sent
+  void rspLmrt(tNFC_STATUS status) {
+    tNFA_EE_MSG msg = {};
+    tNFC_RESPONSE rsp = {};
+
+    rsp.status = status;
+    msg.wait_rsp.opcode = NCI_MSG_RF_SET_ROUTING;
+    msg.wait_rsp.p_data = &rsp;
+    while (nfa_ee_cb.wait_rsp) nfa_ee_nci_wait_rsp(&msg);
+  }
+};
+
+TEST_F(NfaEeLmrtTest, test_skip_unchanged) {
+  ASSERT_LT(0, sendLmrt());
+  std::vector<uint8_t> sent = stub_lmrt_tlvs;
+  rspLmrt(NFC_STATUS_OK);
+  EXPECT_TRUE(nfa_ee_cb.lmrt_sent_valid);
+
+  // the same LMRT again is not sent
+  EXPECT_EQ(0, sendLmrt());
+  EXPECT_EQ(0, nfa_ee_cb.wait_rsp);
+
+  // a changed one is
+  addAid(0x02);
+  EXPECT_LT(0, sendLmrt());
+  EXPECT_NE(sent, stub_lmrt_tlvs);
+  rspLmrt(NFC_STATUS_OK);
+  EXPECT_EQ(0, sendLmrt());
+}
+
+TEST_F(NfaEeLmrtTest, test_resend_after_reject) {
+  ASSERT_LT(0, sendLmrt());
+  std::vector<uint8_t> sent = stub_lmrt_tlvs;
+
+  // NFCC rejected it, what it holds is unknown
+  rspLmrt(NFC_STATUS_FAILED);
+  EXPECT_FALSE(nfa_ee_cb.lmrt_sent_valid);
+  EXPECT_LT(0, sendLmrt());
+  EXPECT_EQ(sent, stub_lmrt_tlvs);
+  rspLmrt(NFC_STATUS_OK);
+  EXPECT_EQ(0, sendLmrt());
+}
+
+TEST_F(NfaEeLmrtTest, test_resend_after_send_failure) {
+  // a command which could not be sent leaves the LMRT in NFCC unknown
+  stub_set_routing_status = NFC_STATUS_FAILED;
+  ASSERT_LT(0, sendLmrt());
+  EXPECT_FALSE(nfa_ee_cb.lmrt_sent_valid);
+
+  stub_set_routing_status = NFC_STATUS_OK;
+  EXPECT_LT(0, sendLmrt());
+  EXPECT_TRUE(nfa_ee_cb.lmrt_sent_valid);
+  rspLmrt(NFC_STATUS_OK);
+  EXPECT_EQ(0, sendLmrt());
+}
+
+TEST_F(NfaEeLmrtTest, test_resend_after_nfcc_reset) {
+  ASSERT_LT(0, sendLmrt());
+  rspLmrt(NFC_STATUS_OK);
+
+  // NFCC was reset, it has no LMRT
+  nfa_ee_sys_enable();
+  EXPECT_FALSE(nfa_ee_cb.lmrt_sent_valid);
+  EXPECT_LT(0, sendLmrt());
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+
+#include "nfa_dm_int.h"
+#include "nfa_ee_int.h"
+#include "nfa_hci_int.h"
+#include "nfa_sys.h"
+#include "nfc_config.h"
+#include "nfc_int.h"
+
+// These are the functions implemented elsewhere in the NFC code. The NFA EE
+// tests don't need them. To avoid pulling in more source code we simply stub
+// them out. NFC_SetRouting() and NFC_SendData() keep what they are given for
+// the tests to check, and fail when the tests ask them to.
+
+std::vector<uint8_t> stub_lmrt_tlvs;
+uint16_t stub_lmrt_size = 0x8000;
+int stub_set_routing_calls = 0;
+tNFC_STATUS stub_set_routing_status = NFC_STATUS_OK;
+std::vector<std::vector<uint8_t>> stub_sent_data;
+tNFC_STATUS stub_send_data_status = NFC_STATUS_OK;
+int stub_timer_starts = 0;
+
+tNFC_CB nfc_cb;
+tNFA_HCI_CB nfa_hci_cb;
+uint8_t mute_tech_route_option = 0x00;
+
+tNFC_STATUS NFC_SetRouting(bool, uint8_t, uint8_t tlv_size,
+                           uint8_t* p_param_tlvs) {
+  stub_set_routing_calls++;
+  if (stub_set_routing_status != NFC_STATUS_OK) return stub_set_routing_status;
+  stub_lmrt_tlvs.insert(stub_lmrt_tlvs.end(), p_param_tlvs,
+                        p_param_tlvs + tlv_size);
+  return NFC_STATUS_OK;
+}
+uint16_t NFC_GetLmrtSize() { return stub_lmrt_size; }
+uint8_t NFC_GetNCIVersion() { return NCI_VERSION_2_0; }
+uint8_t NFA_GetNCIVersion() { return NCI_VERSION_2_0; }
+
+tNFC_STATUS NFC_SendData(uint8_t, NFC_HDR* p_data) {
+  uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+
+  if (stub_send_data_status == NFC_STATUS_OK)
+    stub_sent_data.emplace_back(p, p + p_data->len);
+  GKI_freebuf(p_data);
+  return stub_send_data_status;
+}
+tNFC_STATUS NFC_ConnCreate(uint8_t, uint8_t, uint8_t, tNFC_CONN_CBACK*) {
+  return NFC_STATUS_OK;
+}
+tNFC_STATUS NFC_ConnClose(uint8_t) { return NFC_STATUS_OK; }
+tNFC_STATUS NFC_NfceeDiscover(bool) { return NFC_STATUS_OK; }
+tNFC_STATUS NFC_NfceeModeSet(uint8_t, tNFC_NFCEE_MODE) {
+  return NFC_STATUS_OK;
+}
+tNFC_STATUS NFC_NfceePLConfig(uint8_t, uint8_t) { return NFC_STATUS_OK; }
+
+bool nfa_dm_is_active(void) { return true; }
+void nfa_dm_get_tech_route_block(uint8_t* listen_techmask, bool* enable) {
+  *listen_techmask = 0;
+  *enable = false;
+}
+
+// API messages are handled right away, as if by the NFC task
+void nfa_sys_sendmsg(void* p_msg) {
+  nfa_ee_evt_hdlr((NFC_HDR*)p_msg);
+  GKI_freebuf(p_msg);
+}
+void nfa_sys_register(uint8_t, const tNFA_SYS_REG*) {}
+void nfa_sys_deregister(uint8_t) {}
+bool nfa_sys_is_register(uint8_t) { return true; }
+bool nfa_sys_is_graceful_disable(void) { return false; }
+void nfa_sys_start_timer(TIMER_LIST_ENT*, uint16_t, int32_t) {
+  stub_timer_starts++;
+}
+void nfa_sys_stop_timer(TIMER_LIST_ENT*) {}
+void nfa_sys_cback_notify_enable_complete(uint8_t) {}
+void nfa_sys_cback_notify_nfcc_power_mode_proc_complete(uint8_t) {}
+
+bool NfcConfig::hasKey(const std::string&) { return false; }
+unsigned NfcConfig::getUnsigned(const std::string&) { return 0; }
+unsigned NfcConfig::getUnsigned(const std::string&, unsigned default_value) {
+  return default_value;
+}
+std::vector<uint8_t> NfcConfig::getBytes(const std::string&) { return {}; }
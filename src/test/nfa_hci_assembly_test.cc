@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gki.h"
+#include "nfa_hci_api.h"
+#include "nfa_hci_defs.h"
+#include "nfa_hci_int.h"
+#include "nfa_sys.h"
+
+// The NFA SYS registration of HCI and the NFA_HCI_MAX_MSG_LEN config, see
+// nfa_hci_stubs.cc
+extern tNFC_CONN_CBACK* stub_hci_cback;
+extern const tNFA_SYS_REG* stub_sys_reg;
+extern unsigned stub_hci_max_msg_len;
+
+static const tNFA_HANDLE kApp = NFA_HANDLE_GROUP_HCI | 0x00;
+static const uint8_t kGate = NFA_HCI_FIRST_HOST_SPECIFIC_GENERIC_GATE;
+static const uint8_t kHost = NFA_HCI_HOST_ID_UICC0;
+static const uint8_t kPipe = 0x10;
+static const uint8_t kEvt = 0x12;
+
+// What the application got with NFA_HCI_EVENT_RCVD_EVT
+static int num_rcvd;
+static tNFA_STATUS rcvd_status;
+static std::vector<uint8_t> rcvd_data;
+static uint8_t* p_rcvd_buf;
+static uint16_t rcvd_buf_len;
+
+static void hciCback(tNFA_HCI_EVT event, tNFA_HCI_EVT_DATA* p_data) {
+  if (event != NFA_HCI_EVENT_RCVD_EVT) return;
+
+  num_rcvd++;
+  rcvd_status = p_data->rcvd_evt.status;
+  rcvd_data.assign(p_data->rcvd_evt.p_evt_buf,
+                   p_data->rcvd_evt.p_evt_buf + p_data->rcvd_evt.evt_len);
+  p_rcvd_buf = p_data->rcvd_evt.p_evt_buf;
+  rcvd_buf_len = nfa_hci_cb.max_msg_len;
+}
+
+static std::vector<uint8_t> makeData(size_t len) {
+  std::vector<uint8_t> data(len);
+
+  for (size_t xx = 0; xx < len; xx++) data[xx] = (uint8_t)xx;
+  return data;
+}
+
+class NfaHciAssemblyTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    stub_hci_max_msg_len = 0;
+    nfa_hci_init();
+    nfa_hci_cb.nv_read_cmplt = true;
+    nfa_hci_cb.ee_disc_cmplt = true;
+    nfa_hci_startup();
+    ASSERT_NE(nullptr, stub_hci_cback);
+
+    nfa_hci_cb.hci_state = NFA_HCI_STATE_IDLE;
+    nfa_hci_cb.conn_id = NFC_HCI_CONN_ID;
+    nfa_hci_cb.buff_size = 0xFF;
+    nfa_hci_cb.active_host[0] = kHost;
+    nfa_hci_cb.p_app_cback[0] = hciCback;
+
+    nfa_hci_cb.cfg.dyn_gates[0].gate_id = kGate;
+    nfa_hci_cb.cfg.dyn_gates[0].gate_owner = kApp;
+    nfa_hci_cb.cfg.dyn_gates[0].pipe_inx_mask = 0x01;
+    nfa_hci_cb.cfg.dyn_pipes[0] = {kPipe, NFA_HCI_PIPE_OPENED, kGate, kHost,
+                                   kGate};
+    nfa_hciu_rebuild_lookup();
+
+    num_rcvd = 0;
+    rcvd_data.clear();
+    p_rcvd_buf = nullptr;
+  }
+
+  void TearDown() override {
+    stub_sys_reg->disable();
+    EXPECT_EQ(nullptr, nfa_hci_cb.p_assembly_buf);
+  }
+
+  // The host sends an event on kPipe, in HCP packets of up to frag_len bytes
+  void rxEvent(const std::vector<uint8_t>& data, size_t frag_len) {
+    std::vector<uint8_t> msg = {(NFA_HCI_EVENT_TYPE << 6) | kEvt};
+    size_t pos = 0;
+
+    msg.insert(msg.end(), data.begin(), data.end());
+    do {
+      size_t len = std::min(frag_len, msg.size() - pos);
+      NFC_HDR* p_pkt = (NFC_HDR*)GKI_getbuf(NFC_HDR_SIZE + 1 + len);
+      uint8_t* p = (uint8_t*)(p_pkt + 1);
+      tNFC_CONN conn = {};
+
+      p_pkt->offset = 0;
+      p_pkt->len = (uint16_t)(1 + len);
+      p[0] = kPipe;
+      if (pos + len == msg.size()) p[0] |= 0x80;
+      memcpy(&p[1], &msg[pos], len);
+      pos += len;
+      conn.data.p_data = p_pkt;
+      stub_hci_cback(nfa_hci_cb.conn_id, NFC_DATA_CEVT, &conn);
+    } while (pos < msg.size());
+  }
+};
+
+TEST_F(NfaHciAssemblyTest, test_small_event_not_grown) {
+  std::vector<uint8_t> data = makeData(NFA_MAX_HCI_EVENT_LEN);
+
+  rxEvent(data, 100);
+  ASSERT_EQ(1, num_rcvd);
+  EXPECT_EQ(NFA_STATUS_OK, rcvd_status);
+  EXPECT_EQ(data, rcvd_data);
+  EXPECT_EQ(nfa_hci_cb.msg_data, p_rcvd_buf);
+  EXPECT_EQ(nullptr, nfa_hci_cb.p_assembly_buf);
+}
+
+TEST_F(NfaHciAssemblyTest, test_large_event_grows_buffer) {
+  std::vector<uint8_t> data = makeData(3000);
+
+  rxEvent(data, 250);
+  ASSERT_EQ(1, num_rcvd);
+  EXPECT_EQ(NFA_STATUS_OK, rcvd_status);
+  EXPECT_EQ(data, rcvd_data);
+  // 300 doubled until the event fits
+  EXPECT_EQ(4800, rcvd_buf_len);
+  // the application got the grown buffer, released after dispatch
+  EXPECT_NE(nfa_hci_cb.msg_data, p_rcvd_buf);
+  EXPECT_EQ(nullptr, nfa_hci_cb.p_assembly_buf);
+  EXPECT_EQ(nfa_hci_cb.msg_data, nfa_hci_cb.p_msg_data);
+
+  // the next event starts from the internal buffer again
+  data = makeData(20);
+  rxEvent(data, 250);
+  ASSERT_EQ(2, num_rcvd);
+  EXPECT_EQ(data, rcvd_data);
+  EXPECT_EQ(nfa_hci_cb.msg_data, p_rcvd_buf);
+}
+
+TEST_F(NfaHciAssemblyTest, test_max_msg_len_config) {
+  EXPECT_EQ(NFA_HCI_MAX_MSG_LEN, nfa_hci_cb.max_assembly_len);
+
+  // the config can only lower the limit
+  stub_hci_max_msg_len = 1000;
+  nfa_hci_init();
+  EXPECT_EQ(1000, nfa_hci_cb.max_assembly_len);
+  stub_hci_max_msg_len = NFA_HCI_MAX_MSG_LEN + 1;
+  nfa_hci_init();
+  EXPECT_EQ(NFA_HCI_MAX_MSG_LEN, nfa_hci_cb.max_assembly_len);
+}
+
+TEST_F(NfaHciAssemblyTest, test_event_above_limit) {
+  std::vector<uint8_t> data = makeData(1500);
+
+  // the event is truncated at the limit and reported so
+  nfa_hci_cb.max_assembly_len = 1000;
+  rxEvent(data, 250);
+  ASSERT_EQ(1, num_rcvd);
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, rcvd_status);
+  EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.begin() + 1000),
+            rcvd_data);
+  EXPECT_EQ(1000, rcvd_buf_len);
+}
+
+TEST_F(NfaHciAssemblyTest, test_app_rsp_buf_not_grown) {
+  uint8_t cmd[] = {0x01};
+  std::vector<uint8_t> rsp_buf(100);
+  std::vector<uint8_t> data = makeData(400);
+
+  ASSERT_EQ(NFA_STATUS_OK,
+            NFA_HciSendEvent(kApp, kPipe, kEvt, sizeof(cmd), cmd,
+                             (uint16_t)rsp_buf.size(), rsp_buf.data(), 0));
+  rxEvent(data, 250);
+  ASSERT_EQ(1, num_rcvd);
+  EXPECT_EQ(NFA_STATUS_BUFFER_FULL, rcvd_status);
+  EXPECT_EQ(rsp_buf.data(), p_rcvd_buf);
+  EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.begin() + 100),
+            rcvd_data);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "gki.h"
+#include "nfa_hci_api.h"
+#include "nfa_hci_defs.h"
+#include "nfa_hci_int.h"
+
+static const tNFA_HANDLE kApp = NFA_HANDLE_GROUP_HCI | 0x00;
+static const uint8_t kGate = NFA_HCI_FIRST_HOST_SPECIFIC_GENERIC_GATE;
+
+static void hciCback(tNFA_HCI_EVT, tNFA_HCI_EVT_DATA*) {}
+
+// The linear searches the lookup tables replace
+static tNFA_HCI_DYN_PIPE* findPipe(uint8_t pipe_id) {
+  for (int xx = 0; xx < NFA_HCI_MAX_PIPE_CB; xx++) {
+    if (nfa_hci_cb.cfg.dyn_pipes[xx].pipe_id == pipe_id)
+      return &nfa_hci_cb.cfg.dyn_pipes[xx];
+  }
+  return nullptr;
+}
+
+static tNFA_HCI_DYN_GATE* findGate(uint8_t gate_id) {
+  for (int xx = 0; xx < NFA_HCI_MAX_GATE_CB; xx++) {
+    if (nfa_hci_cb.cfg.dyn_gates[xx].gate_id == gate_id)
+      return &nfa_hci_cb.cfg.dyn_gates[xx];
+  }
+  return nullptr;
+}
+
+class NfaHciLookupTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    nfa_hci_init();
+    nfa_hci_cb.p_app_cback[0] = hciCback;
+  }
+
+  // Add a pipe to the gate kGate
+  tNFA_HCI_RESPONSE addPipe(uint8_t pipe_id) {
+    return nfa_hciu_add_pipe_to_gate(pipe_id, kGate, NFA_HCI_HOST_ID_UICC0,
+                                     kGate);
+  }
+
+  // Each pipe and gate ID finds what the linear search finds
+  void expectLookupsMatch() {
+    for (int id = 1; id <= 0xFF; id++) {
+      if (id <= NFA_HCI_MAX_PIPE_ID) {
+        EXPECT_EQ(findPipe((uint8_t)id), nfa_hciu_find_pipe_by_pid((uint8_t)id))
+            << "pipe " << id;
+      }
+      EXPECT_EQ(findGate((uint8_t)id), nfa_hciu_find_gate_by_gid((uint8_t)id))
+          << "gate " << id;
+    }
+  }
+};
+
+TEST_F(NfaHciLookupTest, test_alloc_release_gate) {
+  tNFA_HCI_DYN_GATE* pg = nfa_hciu_alloc_gate(kGate, kApp);
+
+  ASSERT_NE(nullptr, pg);
+  EXPECT_EQ(pg, nfa_hciu_find_gate_by_gid(kGate));
+  // the same gate again is the one allocated
+  EXPECT_EQ(pg, nfa_hciu_alloc_gate(kGate, kApp));
+
+  nfa_hciu_release_gate(kGate);
+  EXPECT_EQ(nullptr, nfa_hciu_find_gate_by_gid(kGate));
+  expectLookupsMatch();
+}
+
+TEST_F(NfaHciLookupTest, test_alloc_release_pipe) {
+  ASSERT_NE(nullptr, nfa_hciu_alloc_gate(kGate, kApp));
+  ASSERT_EQ(NFA_HCI_ANY_OK, addPipe(0x10));
+  tNFA_HCI_DYN_PIPE* pp = nfa_hciu_find_pipe_by_pid(0x10);
+  ASSERT_NE(nullptr, pp);
+  EXPECT_EQ(0x10, pp->pipe_id);
+
+  // a pipe ID above the dynamic range has no entry
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(NFA_HCI_MAX_PIPE_ID + 1));
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(0xFF));
+
+  EXPECT_EQ(NFA_HCI_ANY_OK, nfa_hciu_release_pipe(0x10));
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(0x10));
+  EXPECT_EQ(0u, nfa_hciu_find_gate_by_gid(kGate)->pipe_inx_mask);
+  expectLookupsMatch();
+}
+
+TEST_F(NfaHciLookupTest, test_id_zero_finds_free_cb) {
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_pipes[0], nfa_hciu_find_pipe_by_pid(0));
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_gates[0], nfa_hciu_find_gate_by_gid(0));
+
+  ASSERT_NE(nullptr, nfa_hciu_alloc_gate(kGate, kApp));
+  ASSERT_EQ(NFA_HCI_ANY_OK, addPipe(0x10));
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_pipes[1], nfa_hciu_find_pipe_by_pid(0));
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_gates[1], nfa_hciu_find_gate_by_gid(0));
+}
+
+TEST_F(NfaHciLookupTest, test_rebuild_after_nv_restore) {
+  // the config read from NV, with a pipe ID twice: the first one wins
+  nfa_hci_cb.cfg.dyn_gates[2].gate_id = kGate;
+  nfa_hci_cb.cfg.dyn_gates[2].gate_owner = kApp;
+  nfa_hci_cb.cfg.dyn_pipes[3].pipe_id = 0x20;
+  nfa_hci_cb.cfg.dyn_pipes[5].pipe_id = 0x20;
+  nfa_hci_cb.cfg.dyn_pipes[6].pipe_id = NFA_HCI_MAX_PIPE_ID;
+  nfa_hciu_rebuild_lookup();
+
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_gates[2], nfa_hciu_find_gate_by_gid(kGate));
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_pipes[3], nfa_hciu_find_pipe_by_pid(0x20));
+  EXPECT_EQ(&nfa_hci_cb.cfg.dyn_pipes[6],
+            nfa_hciu_find_pipe_by_pid(NFA_HCI_MAX_PIPE_ID));
+  expectLookupsMatch();
+}
+
+TEST_F(NfaHciLookupTest, test_restore_default_config) {
+  uint8_t session_id[NFA_HCI_SESSION_ID_LEN] = {};
+
+  ASSERT_NE(nullptr, nfa_hciu_alloc_gate(kGate, kApp));
+  ASSERT_EQ(NFA_HCI_ANY_OK, addPipe(0x10));
+  nfa_hci_restore_default_config(session_id);
+
+  EXPECT_EQ(nullptr, nfa_hciu_find_gate_by_gid(kGate));
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(0x10));
+  expectLookupsMatch();
+}
+
+TEST_F(NfaHciLookupTest, test_random_alloc_release) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> pipe_ids(NFA_HCI_FIRST_DYNAMIC_PIPE,
+                                              NFA_HCI_LAST_DYNAMIC_PIPE);
+  std::uniform_int_distribution<int> gate_ids(kGate + 1,
+                                              NFA_HCI_LAST_PROP_GATE);
+
+  // the pipes are all on kGate, the other gates come and go
+  ASSERT_NE(nullptr, nfa_hciu_alloc_gate(kGate, kApp));
+  for (int xx = 0; xx < 2000; xx++) {
+    uint8_t pipe_id = (uint8_t)pipe_ids(rng);
+    uint8_t gate_id = (uint8_t)gate_ids(rng);
+
+    switch (rng() % 4) {
+      case 0:
+        addPipe(pipe_id);
+        break;
+      case 1:
+        if (nfa_hciu_find_pipe_by_pid(pipe_id) != nullptr)
+          nfa_hciu_release_pipe(pipe_id);
+        break;
+      case 2:
+        nfa_hciu_alloc_gate(gate_id, kApp);
+        break;
+      default:
+        nfa_hciu_release_gate(gate_id);
+        break;
+    }
+  }
+  expectLookupsMatch();
+}
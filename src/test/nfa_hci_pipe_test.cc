@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "gki.h"
+#include "nfa_hci_api.h"
+#include "nfa_hci_defs.h"
+#include "nfa_hci_int.h"
+#include "nfa_sys.h"
+
+// The HCP packets sent to NFCC and the NFA SYS registration of HCI, see
+// nfa_hci_stubs.cc
+extern std::vector<std::vector<uint8_t>> stub_sent_data;
+extern tNFC_CONN_CBACK* stub_hci_cback;
+extern const tNFA_SYS_REG* stub_sys_reg;
+
+static const tNFA_HANDLE kApp = NFA_HANDLE_GROUP_HCI | 0x00;
+static const uint8_t kGate = NFA_HCI_FIRST_HOST_SPECIFIC_GENERIC_GATE;
+static const uint8_t kHost = NFA_HCI_HOST_ID_UICC0;
+static const uint8_t kPipeA = 0x10;
+static const uint8_t kPipeB = 0x11;
+
+typedef std::pair<tNFA_HCI_EVT, tNFA_STATUS> tAppEvt;
+static std::vector<tAppEvt> events;
+
+static void hciCback(tNFA_HCI_EVT event, tNFA_HCI_EVT_DATA* p_data) {
+  events.push_back({event, p_data->status});
+}
+
+// The HCP command packet sent on pipe with instruction inst
+static std::vector<uint8_t> cmdPkt(uint8_t pipe, uint8_t inst,
+                                   std::vector<uint8_t> data = {}) {
+  std::vector<uint8_t> pkt = {(uint8_t)(0x80 | pipe),
+                              (uint8_t)((NFA_HCI_COMMAND_TYPE << 6) | inst)};
+
+  pkt.insert(pkt.end(), data.begin(), data.end());
+  return pkt;
+}
+
+class NfaHciPipeTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    nfa_hci_init();
+    nfa_hci_cb.nv_read_cmplt = true;
+    nfa_hci_cb.ee_disc_cmplt = true;
+    nfa_hci_startup();
+    ASSERT_NE(nullptr, stub_hci_cback);
+
+    nfa_hci_cb.hci_state = NFA_HCI_STATE_IDLE;
+    nfa_hci_cb.conn_id = NFC_HCI_CONN_ID;
+    nfa_hci_cb.buff_size = 0xFF;
+    nfa_hci_cb.active_host[0] = kHost;
+    nfa_hci_cb.p_app_cback[0] = hciCback;
+    strlcpy(nfa_hci_cb.cfg.reg_app_names[0], "test",
+            NFA_MAX_HCI_APP_NAME_LEN);
+
+    nfa_hci_cb.cfg.dyn_gates[0].gate_id = kGate;
+    nfa_hci_cb.cfg.dyn_gates[0].gate_owner = kApp;
+    nfa_hci_cb.cfg.dyn_gates[0].pipe_inx_mask = 0x03;
+    nfa_hci_cb.cfg.dyn_pipes[0] = {kPipeA, NFA_HCI_PIPE_OPENED, kGate, kHost,
+                                   kGate};
+    nfa_hci_cb.cfg.dyn_pipes[1] = {kPipeB, NFA_HCI_PIPE_OPENED, kGate, kHost,
+                                   kGate};
+    nfa_hciu_rebuild_lookup();
+
+    stub_sent_data.clear();
+    events.clear();
+  }
+
+  void TearDown() override {
+    stub_sys_reg->disable();
+    EXPECT_TRUE(GKI_queue_is_empty(&nfa_hci_cb.pipe_cmd_q));
+    EXPECT_TRUE(GKI_queue_is_empty(&nfa_hci_cb.hci_api_q));
+  }
+
+  // The host answers the command on pipe with ANY_OK
+  void rspPipe(uint8_t pipe, std::vector<uint8_t> data = {}) {
+    NFC_HDR* p_pkt = (NFC_HDR*)GKI_getbuf(NFC_HDR_SIZE + 2 + data.size());
+    uint8_t* p = (uint8_t*)(p_pkt + 1);
+    tNFC_CONN conn = {};
+
+    p_pkt->offset = 0;
+    p_pkt->len = (uint16_t)(2 + data.size());
+    p[0] = 0x80 | pipe;
+    p[1] = (NFA_HCI_RESPONSE_TYPE << 6) | NFA_HCI_ANY_OK;
+    if (!data.empty()) memcpy(&p[2], data.data(), data.size());
+    conn.data.p_data = p_pkt;
+    stub_hci_cback(nfa_hci_cb.conn_id, NFC_DATA_CEVT, &conn);
+  }
+
+  // The response timer of the command on pipe expires
+  void expirePipeTimer(uint8_t pipe) {
+    tNFA_HCI_PIPE_CMD* p_cmd = nfa_hciu_find_pipe_cmd(pipe);
+    NFC_HDR* p_msg = (NFC_HDR*)GKI_getbuf(sizeof(NFC_HDR));
+
+    ASSERT_NE(nullptr, p_cmd);
+    p_cmd->timer.in_use = false;
+    p_msg->event = p_cmd->timer.event;
+    p_msg->len = 0;
+    nfa_sys_sendmsg(p_msg);
+  }
+};
+
+TEST_F(NfaHciPipeTest, test_pipes_do_not_block_each_other) {
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeB, 0x02));
+  ASSERT_EQ(2u, stub_sent_data.size());
+  EXPECT_EQ(cmdPkt(kPipeA, NFA_HCI_ANY_GET_PARAMETER, {0x01}),
+            stub_sent_data[0]);
+  EXPECT_EQ(cmdPkt(kPipeB, NFA_HCI_ANY_GET_PARAMETER, {0x02}),
+            stub_sent_data[1]);
+  EXPECT_EQ(NFA_HCI_STATE_IDLE, nfa_hci_cb.hci_state);
+
+  // the responses come in any order
+  rspPipe(kPipeB, {0xBB});
+  rspPipe(kPipeA, {0xAA});
+  EXPECT_EQ(std::vector<tAppEvt>({{NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_OK},
+                                  {NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_OK}}),
+            events);
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_cmd(kPipeA));
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_cmd(kPipeB));
+}
+
+TEST_F(NfaHciPipeTest, test_requests_wait_for_their_pipe) {
+  uint8_t data[] = {0x01, 0x02};
+
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciSendEvent(kApp, kPipeA, 0x10, sizeof(data),
+                                            data, 0, nullptr, 0));
+  ASSERT_EQ(NFA_STATUS_OK,
+            NFA_HciSendCommand(kApp, kPipeA, 0x11, sizeof(data), data));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeB, 0x02));
+
+  // the event and the command wait for the command on pipe A, pipe B goes on
+  ASSERT_EQ(2u, stub_sent_data.size());
+  EXPECT_EQ(kPipeB | 0x80, stub_sent_data[1][0]);
+
+  // they are sent in order once pipe A is free, a new request waits behind
+  // them
+  rspPipe(kPipeA);
+  ASSERT_EQ(4u, stub_sent_data.size());
+  EXPECT_EQ(std::vector<uint8_t>(
+                {0x80 | kPipeA, (NFA_HCI_EVENT_TYPE << 6) | 0x10, 0x01, 0x02}),
+            stub_sent_data[2]);
+  EXPECT_EQ(cmdPkt(kPipeA, 0x11, {0x01, 0x02}), stub_sent_data[3]);
+
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x03));
+  EXPECT_EQ(4u, stub_sent_data.size());
+  rspPipe(kPipeA);
+  ASSERT_EQ(5u, stub_sent_data.size());
+  EXPECT_EQ(cmdPkt(kPipeA, NFA_HCI_ANY_GET_PARAMETER, {0x03}),
+            stub_sent_data[4]);
+  rspPipe(kPipeA);
+  rspPipe(kPipeB);
+}
+
+TEST_F(NfaHciPipeTest, test_delete_waits_for_pipe_cmd) {
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciDeletePipe(kApp, kPipeA));
+  EXPECT_EQ(1u, stub_sent_data.size());
+
+  rspPipe(kPipeA);
+  ASSERT_EQ(2u, stub_sent_data.size());
+  EXPECT_EQ(cmdPkt(NFA_HCI_ADMIN_PIPE, NFA_HCI_ADM_DELETE_PIPE, {kPipeA}),
+            stub_sent_data[1]);
+  rspPipe(NFA_HCI_ADMIN_PIPE);
+  EXPECT_EQ(std::vector<tAppEvt>({{NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_OK},
+                                  {NFA_HCI_DELETE_PIPE_EVT, NFA_STATUS_OK}}),
+            events);
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(kPipeA));
+}
+
+TEST_F(NfaHciPipeTest, test_timeout_fails_waiting_requests) {
+  uint8_t data[] = {0x01};
+
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK,
+            NFA_HciSendCommand(kApp, kPipeA, 0x11, sizeof(data), data));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeB, 0x02));
+  ASSERT_EQ(2u, stub_sent_data.size());
+
+  // the pipe is given up and deleted, the command waiting for it fails too
+  expirePipeTimer(kPipeA);
+  EXPECT_EQ(std::vector<tAppEvt>({{NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_FAILED},
+                                  {NFA_HCI_RSP_RCVD_EVT, NFA_STATUS_FAILED}}),
+            events);
+  ASSERT_EQ(3u, stub_sent_data.size());
+  EXPECT_EQ(cmdPkt(NFA_HCI_ADMIN_PIPE, NFA_HCI_ADM_DELETE_PIPE, {kPipeA}),
+            stub_sent_data[2]);
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_by_pid(kPipeA));
+
+  // pipe B is not affected
+  EXPECT_NE(nullptr, nfa_hciu_find_pipe_cmd(kPipeB));
+  rspPipe(NFA_HCI_ADMIN_PIPE);
+  rspPipe(kPipeB);
+  EXPECT_EQ(tAppEvt(NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_OK), events.back());
+}
+
+TEST_F(NfaHciPipeTest, test_release_fails_pending_cmds) {
+  uint8_t data[] = {0x01};
+
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK,
+            NFA_HciSendCommand(kApp, kPipeA, 0x11, sizeof(data), data));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciSendEvent(kApp, kPipeA, 0x10, sizeof(data),
+                                            data, 0, nullptr, 0));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciClosePipe(kApp, kPipeA));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeB, 0x02));
+  EXPECT_EQ(2u, stub_sent_data.size());
+
+  // e.g. the host cleared its pipes
+  EXPECT_EQ(NFA_HCI_ANY_OK, nfa_hciu_release_pipe(kPipeA));
+  EXPECT_EQ(
+      std::vector<tAppEvt>({{NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_FAILED},
+                            {NFA_HCI_RSP_RCVD_EVT, NFA_STATUS_FAILED},
+                            {NFA_HCI_EVENT_SENT_EVT, NFA_STATUS_FAILED},
+                            {NFA_HCI_CLOSE_PIPE_EVT, NFA_STATUS_FAILED}}),
+      events);
+  EXPECT_TRUE(GKI_queue_is_empty(&nfa_hci_cb.pipe_cmd_q));
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_cmd(kPipeA));
+
+  // a late response on the released pipe is dropped
+  events.clear();
+  rspPipe(kPipeA);
+  EXPECT_TRUE(events.empty());
+  EXPECT_NE(nullptr, nfa_hciu_find_pipe_cmd(kPipeB));
+  rspPipe(kPipeB);
+}
+
+TEST_F(NfaHciPipeTest, test_disable_fails_pending_cmds) {
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciGetRegistry(kApp, kPipeA, 0x01));
+  ASSERT_EQ(NFA_STATUS_OK, NFA_HciOpenPipe(kApp, kPipeA));
+
+  stub_sys_reg->disable();
+  EXPECT_EQ(std::vector<tAppEvt>({{NFA_HCI_GET_REG_RSP_EVT, NFA_STATUS_FAILED},
+                                  {NFA_HCI_OPEN_PIPE_EVT, NFA_STATUS_FAILED}}),
+            events);
+  EXPECT_EQ(nullptr, nfa_hciu_find_pipe_cmd(kPipeA));
+}
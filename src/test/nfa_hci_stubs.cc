@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+
+#include "nfa_dm_int.h"
+#include "nfa_ee_api.h"
+#include "nfa_ee_int.h"
+#include "nfa_hci_int.h"
+#include "nfa_nv_co.h"
+#include "nfa_sys.h"
+#include "nfc_config.h"
+#include "nfc_int.h"
+
+// These are the functions implemented elsewhere in the NFC code. The NFA HCI
+// tests don't need them. To avoid pulling in more source code we simply stub
+// them out. NFC_SendData() keeps the HCP packets it is given for the tests to
+// check, NFC_SetStaticHciCback() keeps the callback the tests feed HCP
+// packets from the NFCC to, and the NFA SYS messages are handled right away.
+// NfcConfig only has the NFA_HCI_MAX_MSG_LEN the tests set, if any.
+
+std::vector<std::vector<uint8_t>> stub_sent_data;
+tNFC_CONN_CBACK* stub_hci_cback = nullptr;
+const tNFA_SYS_REG* stub_sys_reg = nullptr;
+unsigned stub_hci_max_msg_len = 0;
+
+tNFA_EE_CB nfa_ee_cb;
+
+uint8_t NFC_GetNCIVersion() { return NCI_VERSION_2_0; }
+uint8_t NFA_GetNCIVersion() { return NCI_VERSION_2_0; }
+
+tNFC_STATUS NFC_SendData(uint8_t, NFC_HDR* p_data) {
+  uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+
+  stub_sent_data.emplace_back(p, p + p_data->len);
+  GKI_freebuf(p_data);
+  return NFC_STATUS_OK;
+}
+void NFC_SetStaticHciCback(tNFC_CONN_CBACK* p_cback) {
+  stub_hci_cback = p_cback;
+}
+tNFC_STATUS NFC_ConnCreate(uint8_t, uint8_t, uint8_t, tNFC_CONN_CBACK*) {
+  return NFC_STATUS_OK;
+}
+tNFC_STATUS NFC_ConnClose(uint8_t) { return NFC_STATUS_OK; }
+
+tNFA_STATUS NFA_EeGetInfo(uint8_t* p_num_nfcee, tNFA_EE_INFO*) {
+  *p_num_nfcee = 0;
+  return NFA_STATUS_OK;
+}
+tNFA_EE_ECB* nfa_ee_find_ecb(uint8_t) { return nullptr; }
+tNFC_STATUS nfa_ee_mode_set(tNFA_EE_ECB*, tNFC_NFCEE_MODE) {
+  return NFC_STATUS_OK;
+}
+void nfa_ee_reg_cback_enable_done(tNFA_EE_ENABLE_DONE_CBACK*) {}
+void nfa_ee_proc_hci_info_cback(void) {}
+
+bool nfa_dm_act_start_rf_discovery(tNFA_DM_MSG*) { return true; }
+bool nfa_dm_act_stop_rf_discovery(tNFA_DM_MSG*) { return true; }
+
+void nfa_nv_co_read(uint8_t*, uint16_t, uint8_t) {}
+void nfa_nv_co_write(const uint8_t*, uint16_t, uint8_t) {}
+void nfa_nv_co_flush(void) {}
+
+void nfa_sys_register(uint8_t, const tNFA_SYS_REG* p_reg) {
+  stub_sys_reg = p_reg;
+}
+void nfa_sys_deregister(uint8_t) {}
+void nfa_sys_sendmsg(void* p_msg) {
+  if (stub_sys_reg->evt_hdlr((NFC_HDR*)p_msg)) GKI_freebuf(p_msg);
+}
+bool nfa_sys_is_graceful_disable(void) { return false; }
+void nfa_sys_start_timer(TIMER_LIST_ENT* p_tle, uint16_t type, int32_t) {
+  p_tle->event = type;
+  p_tle->in_use = true;
+}
+void nfa_sys_stop_timer(TIMER_LIST_ENT* p_tle) { p_tle->in_use = false; }
+void nfa_sys_cback_notify_enable_complete(uint8_t) {}
+void nfa_sys_cback_notify_nfcc_power_mode_proc_complete(uint8_t) {}
+
+bool NfcConfig::hasKey(const std::string& key) {
+  return (key == NAME_NFA_HCI_MAX_MSG_LEN) && (stub_hci_max_msg_len != 0);
+}
+unsigned NfcConfig::getUnsigned(const std::string& key) {
+  return (key == NAME_NFA_HCI_MAX_MSG_LEN) ? stub_hci_max_msg_len : 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+
+#include "nfc_int.h"
+#include "rw_int.h"
+
+// These are the functions implemented elsewhere in the NFC code. The MIFARE
+// Classic tests don't need them. To avoid pulling in more source code we
+// simply stub them out. NFC_SendData() keeps the frames it is given for the
+// tests to check, and fails if the tests say so. NFC_SetStaticRfCback()
+// keeps the callback the tests feed the tag responses to.
+
+std::vector<std::vector<uint8_t>> stub_sent_data;
+tNFC_STATUS stub_send_data_status = NFC_STATUS_OK;
+tNFC_CONN_CBACK* stub_rf_cback = nullptr;
+
+tRW_CB rw_cb;
+
+tNFC_STATUS NFC_SendData(uint8_t, NFC_HDR* p_data) {
+  uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+
+  if (stub_send_data_status == NFC_STATUS_OK)
+    stub_sent_data.emplace_back(p, p + p_data->len);
+  GKI_freebuf(p_data);
+  return stub_send_data_status;
+}
+void NFC_SetStaticRfCback(tNFC_CONN_CBACK* p_cback) {
+  stub_rf_cback = p_cback;
+}
+
+void nfc_start_quick_timer(TIMER_LIST_ENT* p_tle, uint16_t type, uint32_t) {
+  p_tle->event = type;
+  p_tle->in_use = true;
+}
+void nfc_stop_quick_timer(TIMER_LIST_ENT* p_tle) { p_tle->in_use = false; }
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <vector>
+
+#include "gki.h"
+#include "rw_api.h"
+#include "rw_int.h"
+
+// The frames sent to the tag and the RF callback, see rw_mfc_stubs.cc
+extern std::vector<std::vector<uint8_t>> stub_sent_data;
+extern tNFC_STATUS stub_send_data_status;
+extern tNFC_CONN_CBACK* stub_rf_cback;
+
+static const uint8_t kAuthKeyA = 0x60;
+
+static std::vector<tRW_EVENT> events;
+static tNFC_STATUS last_status;
+
+static void rwCback(tRW_EVENT event, tRW_DATA* p_data) {
+  events.push_back(event);
+  if (event == RW_MFC_NDEF_DETECT_EVT)
+    last_status = p_data->ndef.status;
+  else
+    last_status = p_data->status;
+}
+
+class RwMfcTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { GKI_init(); }
+
+  void SetUp() override {
+    uint8_t uid[MFC_UID_LEN] = {0x01, 0x02, 0x03, 0x04};
+
+    rw_cb.p_cback = rwCback;
+    ASSERT_EQ(NFC_STATUS_OK, rw_mfc_select(0x08, uid));
+    ASSERT_NE(nullptr, stub_rf_cback);
+
+    stub_sent_data.clear();
+    stub_send_data_status = NFC_STATUS_OK;
+    events.clear();
+    last_status = NFC_STATUS_OK;
+  }
+
+  void TearDown() override {
+    tNFC_CONN conn = {};
+
+    stub_rf_cback(NFC_RF_CONN_ID, NFC_DEACTIVATE_CEVT, &conn);
+  }
+
+  // Every sector of the tag rejected every key
+  void rejectAllKeys() {
+    memset(rw_cb.tcb.mfc.key_failed, 0xFF, sizeof(rw_cb.tcb.mfc.key_failed));
+  }
+
+  // The tag answers the last command
+  void rxData(const std::vector<uint8_t>& data) {
+    NFC_HDR* p_pkt = (NFC_HDR*)GKI_getbuf(NFC_HDR_SIZE + data.size());
+    tNFC_CONN conn = {};
+
+    p_pkt->offset = 0;
+    p_pkt->len = (uint16_t)data.size();
+    memcpy(p_pkt + 1, data.data(), data.size());
+    conn.data.status = NFC_STATUS_OK;
+    conn.data.p_data = p_pkt;
+    stub_rf_cback(NFC_RF_CONN_ID, NFC_DATA_CEVT, &conn);
+  }
+};
+
+TEST_F(RwMfcTest, test_rejected_key_not_resent) {
+  ASSERT_EQ(NFC_STATUS_OK, RW_MfcDetectNDef());
+  ASSERT_EQ(1u, stub_sent_data.size());
+  EXPECT_EQ(kAuthKeyA, stub_sent_data[0][0]);
+
+  // the sector rejects the key: the detection fails without retries
+  rxData({0x04});
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(RW_MFC_NDEF_DETECT_EVT, events[0]);
+  EXPECT_EQ(NFC_STATUS_FAILED, last_status);
+  EXPECT_EQ(1u, stub_sent_data.size());
+
+  // the key is not tried again, and the detection fails at once rather
+  // than waiting for a response to a command never sent
+  EXPECT_NE(NFC_STATUS_OK, RW_MfcDetectNDef());
+  EXPECT_EQ(1u, stub_sent_data.size());
+  EXPECT_NE(NFC_STATUS_BUSY, RW_MfcDetectNDef());
+}
+
+TEST_F(RwMfcTest, test_send_failure_after_auth) {
+  ASSERT_EQ(NFC_STATUS_OK, RW_MfcDetectNDef());
+  ASSERT_EQ(1u, stub_sent_data.size());
+
+  // the read following the authentication cannot be sent
+  stub_send_data_status = NFC_STATUS_FAILED;
+  rxData({0x00});
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(RW_MFC_NDEF_DETECT_EVT, events[0]);
+  EXPECT_EQ(NFC_STATUS_FAILED, last_status);
+
+  // the tag is usable again
+  stub_send_data_status = NFC_STATUS_OK;
+  EXPECT_EQ(NFC_STATUS_OK, RW_MfcDetectNDef());
+  EXPECT_EQ(2u, stub_sent_data.size());
+}
+
+TEST_F(RwMfcTest, test_rejected_key_fails_write) {
+  uint8_t ndef[] = {0xD0, 0x00, 0x00};
+
+  rejectAllKeys();
+  EXPECT_EQ(NFC_STATUS_FAILED, RW_MfcWriteNDef(sizeof(ndef), ndef));
+  EXPECT_EQ(NFC_STATUS_FAILED, RW_MfcWriteNDef(sizeof(ndef), ndef));
+  EXPECT_TRUE(stub_sent_data.empty());
+}
+
+TEST_F(RwMfcTest, test_rejected_key_fails_format) {
+  rejectAllKeys();
+  EXPECT_EQ(NFC_STATUS_FAILED, RW_MfcFormatNDef());
+  EXPECT_EQ(NFC_STATUS_FAILED, RW_MfcFormatNDef());
+  EXPECT_TRUE(stub_sent_data.empty());
+}